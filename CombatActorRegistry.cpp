@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatActorRegistry.h"
+#include "Engine/World.h"
+#include "EnemyBase.h"
+#include "LevelManager.h"
+#include "PlayerCharacterController.h"
+#include "CombatSimulationSubsystem.h"
+#include "CombatStats.h"
+#include "CombatMemory.h"
+#include "Misc/CoreDelegates.h"
+
+UCombatActorRegistry* UCombatActorRegistry::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatActorRegistry>() : nullptr;
+}
+
+void UCombatActorRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Editor preview worlds would otherwise overwrite the PIE world's sample
+	UWorld* World = GetWorld();
+	if (World && World->IsGameWorld())
+	{
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UCombatActorRegistry::RecordFrameStats);
+	}
+}
+
+void UCombatActorRegistry::Deinitialize()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCombatActorRegistry::RecordFrameStats()
+{
+	SET_DWORD_STAT(STAT_CombatActiveEnemies, AliveEnemyCount);
+	CSV_CUSTOM_STAT(Combat, ActiveEnemies, AliveEnemyCount, ECsvCustomStatOp::Set);
+}
+
+void UCombatActorRegistry::RegisterEnemy(AEnemyBase* Enemy)
+{
+	if (!Enemy || EnemyIndices.Contains(Enemy)) return;
+
+	LLM_SCOPE_BYTAG(Combat_Systems);
+	EnemyIndices.Add(Enemy, Enemies.Add(Enemy));
+	EnemyDeathCounted.Add(false);
+	AliveEnemyCount++;
+
+	OnEnemyCountsChanged.Broadcast();
+}
+
+void UCombatActorRegistry::UnregisterEnemy(AEnemyBase* Enemy)
+{
+	int32 Index = INDEX_NONE;
+	if (!EnemyIndices.RemoveAndCopyValue(Enemy, Index)) return;
+
+	const bool bDeathCounted = EnemyDeathCounted[Index];
+
+	Enemies.RemoveAtSwap(Index);
+	EnemyDeathCounted.RemoveAtSwap(Index);
+
+	// The last enemy was swapped into the freed slot
+	if (Enemies.IsValidIndex(Index))
+	{
+		EnemyIndices.FindChecked(Enemies[Index]) = Index;
+	}
+
+	// Dead enemies keep counting towards the level after they are destroyed
+	if (!bDeathCounted)
+	{
+		AliveEnemyCount--;
+		OnEnemyCountsChanged.Broadcast();
+	}
+}
+
+void UCombatActorRegistry::NotifyEnemyDied(AEnemyBase* Enemy)
+{
+	const int32* Index = EnemyIndices.Find(Enemy);
+	if (!Index || EnemyDeathCounted[*Index]) return;
+
+	EnemyDeathCounted[*Index] = true;
+	AliveEnemyCount--;
+	DeadEnemyCount++;
+}
+
+void UCombatActorRegistry::RestoreEnemyCounts(int32 InDeadEnemyCount)
+{
+	EnemyDeathCounted.Init(false, Enemies.Num());
+	AliveEnemyCount = Enemies.Num();
+	DeadEnemyCount = InDeadEnemyCount;
+
+	OnEnemyCountsChanged.Broadcast();
+}
+
+void UCombatActorRegistry::RegisterLevelManager(ALevelManager* LevelManager)
+{
+	if (LevelManager)
+	{
+		LevelManagers.AddUnique(LevelManager);
+	}
+}
+
+void UCombatActorRegistry::UnregisterLevelManager(ALevelManager* LevelManager)
+{
+	LevelManagers.Remove(LevelManager);
+}
+
+void UCombatActorRegistry::RegisterTarget(AActor* Target)
+{
+	if (Target)
+	{
+		Targets.AddUnique(Target);
+	}
+}
+
+void UCombatActorRegistry::UnregisterTarget(AActor* Target)
+{
+	Targets.RemoveSwap(Target);
+}
+
+void UCombatActorRegistry::RegisterWallRunIndex(AWallRunSurfaceIndex* Index)
+{
+	if (!WallRunIndex)
+	{
+		WallRunIndex = Index;
+	}
+}
+
+void UCombatActorRegistry::UnregisterWallRunIndex(AWallRunSurfaceIndex* Index)
+{
+	if (WallRunIndex == Index)
+	{
+		WallRunIndex = nullptr;
+	}
+}
+
+int32 UCombatActorRegistry::CountActiveCombatTimers() const
+{
+	UWorld* World = GetWorld();
+	if (!World) return 0;
+
+	int32 ActiveTimers = 0;
+	for (const AEnemyBase* Enemy : Enemies)
+	{
+		if (!IsValid(Enemy)) continue;
+
+		ActiveTimers += UCombatSimulationSubsystem::IsTimerActive(World, Enemy->FireRateTimerHandle) ? 1 : 0;
+		ActiveTimers += UCombatSimulationSubsystem::IsTimerActive(World, Enemy->EnemyDeathTimerHandle) ? 1 : 0;
+	}
+
+	for (const AActor* Target : Targets)
+	{
+		const APlayerCharacterController* Player = Cast<APlayerCharacterController>(Target);
+		if (!IsValid(Player)) continue;
+
+		ActiveTimers += UCombatSimulationSubsystem::IsTimerActive(World, Player->WeaponSwitchTimerHandle) ? 1 : 0;
+		ActiveTimers += UCombatSimulationSubsystem::IsTimerActive(World, Player->PlayerDeathTimerHandle) ? 1 : 0;
+
+		if (Player->WeaponManager && UCombatSimulationSubsystem::IsTimerActive(World, Player->WeaponManager->ReloadTimerHandle))
+		{
+			ActiveTimers++;
+		}
+	}
+
+	return ActiveTimers;
+}
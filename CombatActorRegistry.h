@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatActorRegistry.generated.h"
+
+class AEnemyBase;
+class ALevelManager;
+class AWallRunSurfaceIndex;
+
+DECLARE_MULTICAST_DELEGATE(FOnCombatEnemyCountsChanged);
+
+/**
+ * Per-world registry of combat actors. Enemies, level managers and targets register
+ * on BeginPlay and unregister on EndPlay, so nothing has to scan the world for them
+ * and actors spawned mid-level are picked up like placed ones.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatActorRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatActorRegistry* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	void RegisterEnemy(AEnemyBase* Enemy);
+
+	void UnregisterEnemy(AEnemyBase* Enemy);
+
+	// Called once when an enemy's death is confirmed, before the actor is destroyed. The death stays counted afterwards.
+	// Does not fire OnEnemyCountsChanged, deaths reach listeners as FCombatEnemyDiedEvent on the event bus.
+	void NotifyEnemyDied(AEnemyBase* Enemy);
+
+	// Recounts after a snapshot restore: every registered enemy is alive again and InDeadEnemyCount deaths remain
+	void RestoreEnemyCounts(int32 InDeadEnemyCount);
+
+	void RegisterLevelManager(ALevelManager* LevelManager);
+
+	void UnregisterLevelManager(ALevelManager* LevelManager);
+
+	void RegisterTarget(AActor* Target);
+
+	void UnregisterTarget(AActor* Target);
+
+	void RegisterWallRunIndex(AWallRunSurfaceIndex* Index);
+
+	void UnregisterWallRunIndex(AWallRunSurfaceIndex* Index);
+
+	const TArray<AEnemyBase*>& GetEnemies() const { return Enemies; }
+
+	const TArray<AActor*>& GetTargets() const { return Targets; }
+
+	ALevelManager* GetLevelManager() const { return LevelManagers.Num() > 0 ? LevelManagers[0] : nullptr; }
+
+	AWallRunSurfaceIndex* GetWallRunIndex() const { return WallRunIndex; }
+
+	int32 GetAliveEnemyCount() const { return AliveEnemyCount; }
+
+	int32 GetDeadEnemyCount() const { return DeadEnemyCount; }
+
+	// Every enemy that took part in the level: the ones still alive plus every confirmed death
+	int32 GetTotalEnemyCount() const { return AliveEnemyCount + DeadEnemyCount; }
+
+	// Fire, death, reload and weapon switch timers pending on the registered enemies and targets
+	int32 CountActiveCombatTimers() const;
+
+	// Fires whenever an enemy registers, unregisters alive, or the counts are restored
+	FOnCombatEnemyCountsChanged OnEnemyCountsChanged;
+
+private:
+
+	// Samples the active enemy count into the stat group and CSV profile once per frame
+	void RecordFrameStats();
+
+	FDelegateHandle EndFrameHandle;
+
+	UPROPERTY()
+	TArray<AEnemyBase*> Enemies;
+
+	// Parallel to Enemies, set once the enemy's death has been counted
+	TBitArray<> EnemyDeathCounted;
+
+	// Each registered enemy's slot in Enemies, so registering, unregistering and deaths don't search the array
+	TMap<AEnemyBase*, int32> EnemyIndices;
+
+	UPROPERTY()
+	TArray<ALevelManager*> LevelManagers;
+
+	UPROPERTY()
+	TArray<AActor*> Targets;
+
+	// First index to register wins; a level only needs one
+	UPROPERTY()
+	AWallRunSurfaceIndex* WallRunIndex = nullptr;
+
+	int32 AliveEnemyCount = 0;
+
+	int32 DeadEnemyCount = 0;
+};
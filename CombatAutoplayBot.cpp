@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatAutoplayBot.h"
+#include "CombatActorRegistry.h"
+#include "CombatCharacterMovementComponent.h"
+#include "EnemyBase.h"
+#include "InputActionValue.h"
+#include "PlayerCharacterController.h"
+#include "WallRunSurfaceIndex.h"
+#include "WeaponManagerComponent.h"
+#include "GameFramework/Controller.h"
+
+namespace CombatAutoplay
+{
+	// Walk in until this close, back off when closer than the minimum
+	static constexpr float EngageDistance = 2500.0f;
+
+	static constexpr float MinDistance = 600.0f;
+
+	// Enemies further away are walked towards but not shot at
+	static constexpr float FireDistance = 5000.0f;
+
+	// Degrees off target still counted as on target
+	static constexpr float OnTargetYaw = 3.0f;
+
+	static constexpr float OnTargetPitch = 5.0f;
+
+	// Largest look input per frame, keeps the turn smooth at any measured response
+	static constexpr float MaxLookInput = 10.0f;
+
+	static constexpr float StuckCheckInterval = 3.0f;
+
+	static constexpr float StuckDistance = 50.0f;
+}
+
+void FCombatAutoplayBot::Reset(int32 Seed)
+{
+	*this = FCombatAutoplayBot();
+	Random.Initialize(Seed);
+}
+
+AActor* FCombatAutoplayBot::PickTarget(APlayerCharacterController* Player) const
+{
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(Player);
+	if (!Registry) return nullptr;
+
+	const FVector PlayerLocation = Player->GetActorLocation();
+
+	AActor* Nearest = nullptr;
+	float NearestDistSq = TNumericLimits<float>::Max();
+	for (AEnemyBase* Enemy : Registry->GetEnemies())
+	{
+		if (!IsValid(Enemy) || Enemy->bIsEnemyDead) continue;
+
+		const float DistSq = FVector::DistSquared(PlayerLocation, Enemy->GetActorLocation());
+		if (DistSq < NearestDistSq)
+		{
+			NearestDistSq = DistSq;
+			Nearest = Enemy;
+		}
+	}
+	return Nearest;
+}
+
+void FCombatAutoplayBot::Steer(APlayerCharacterController* Player, const FRotator& DesiredRotation)
+{
+	const FRotator ControlRotation = Player->GetControlRotation();
+
+	// Measure what last frame's input actually did before choosing this frame's
+	const FRotator Turned = (ControlRotation - LastControlRotation).GetNormalized();
+	if (FMath::Abs(LastLookInput.X) > KINDA_SMALL_NUMBER && FMath::Abs(Turned.Yaw) > KINDA_SMALL_NUMBER)
+	{
+		LookResponse.X = Turned.Yaw / LastLookInput.X;
+	}
+	if (FMath::Abs(LastLookInput.Y) > KINDA_SMALL_NUMBER && FMath::Abs(Turned.Pitch) > KINDA_SMALL_NUMBER)
+	{
+		LookResponse.Y = Turned.Pitch / LastLookInput.Y;
+	}
+
+	// A response near zero would blow the input up, keep its sign and a sane magnitude
+	LookResponse.X = FMath::Sign(LookResponse.X) * FMath::Clamp(FMath::Abs(LookResponse.X), 0.1f, 10.0f);
+	LookResponse.Y = FMath::Sign(LookResponse.Y) * FMath::Clamp(FMath::Abs(LookResponse.Y), 0.1f, 10.0f);
+
+	// Half the remaining error per frame settles in a few frames without overshooting
+	const FRotator Error = (DesiredRotation - ControlRotation).GetNormalized();
+	const FVector2D LookInput(
+		FMath::Clamp(0.5f * Error.Yaw / LookResponse.X, -CombatAutoplay::MaxLookInput, CombatAutoplay::MaxLookInput),
+		FMath::Clamp(0.5f * Error.Pitch / LookResponse.Y, -CombatAutoplay::MaxLookInput, CombatAutoplay::MaxLookInput));
+
+	Player->Look(FInputActionValue(LookInput));
+
+	LastControlRotation = ControlRotation;
+	LastLookInput = LookInput;
+}
+
+void FCombatAutoplayBot::Tick(APlayerCharacterController* Player, float DeltaSeconds)
+{
+	if (!Player || !Player->GetController()) return;
+
+	if (CurrentPlayer.Get() != Player)
+	{
+		CurrentPlayer = Player;
+		LastControlRotation = Player->GetControlRotation();
+		LastLookInput = FVector2D::ZeroVector;
+		WanderYaw = LastControlRotation.Yaw;
+		StuckCheckLocation = Player->GetActorLocation();
+		NextStuckCheck = Time + CombatAutoplay::StuckCheckInterval;
+		NextWeaponSwitch = Time + Random.FRandRange(15.0f, 40.0f);
+		NextJump = Time + Random.FRandRange(3.0f, 8.0f);
+	}
+
+	if (Player->bIsPlayerDeadExecuted) return;
+
+	Time += DeltaSeconds;
+
+	AActor* NewTarget = PickTarget(Player);
+	if (NewTarget != Target.Get())
+	{
+		Target = NewTarget;
+		Player->StopFiring();
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Player->GetController()->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	FRotator DesiredRotation(0.0f, WanderYaw, 0.0f);
+	float Distance = 0.0f;
+	if (NewTarget)
+	{
+		const FVector ToTarget = NewTarget->GetActorLocation() - ViewLocation;
+		DesiredRotation = ToTarget.Rotation();
+		Distance = ToTarget.Size();
+	}
+
+	Steer(Player, DesiredRotation);
+
+	// Strafe direction changes every few seconds so the bot does not stand in one line of fire
+	if (Time >= NextStrafeChange)
+	{
+		Strafe = Random.RandRange(-1, 1);
+		NextStrafeChange = Time + Random.FRandRange(1.0f, 3.0f);
+	}
+
+	float Forward = 1.0f;
+	if (NewTarget)
+	{
+		Forward = Distance > CombatAutoplay::EngageDistance ? 1.0f : (Distance < CombatAutoplay::MinDistance ? -0.5f : 0.0f);
+	}
+
+	// Nothing moving for a while means a wall or a ledge is in the way, pick a new heading and hop
+	if (Time >= NextStuckCheck)
+	{
+		const bool bPushing = Forward != 0.0f || Strafe != 0.0f;
+		if (bPushing && FVector::Dist2D(Player->GetActorLocation(), StuckCheckLocation) < CombatAutoplay::StuckDistance)
+		{
+			WanderYaw = FRotator::NormalizeAxis(LastControlRotation.Yaw + Random.FRandRange(90.0f, 270.0f));
+			Strafe = -Strafe;
+			NextJump = Time;
+		}
+		StuckCheckLocation = Player->GetActorLocation();
+		NextStuckCheck = Time + CombatAutoplay::StuckCheckInterval;
+	}
+
+	Player->Move(FInputActionValue(FVector2D(Strafe, Forward)));
+
+	const FRotator AimError = (DesiredRotation - Player->GetControlRotation()).GetNormalized();
+	const bool bOnTarget = NewTarget && Distance <= CombatAutoplay::FireDistance
+		&& FMath::Abs(AimError.Yaw) <= CombatAutoplay::OnTargetYaw && FMath::Abs(AimError.Pitch) <= CombatAutoplay::OnTargetPitch;
+
+	UpdateFiring(Player, bOnTarget);
+	UpdateWeaponSwitch(Player);
+	UpdateJumping(Player);
+}
+
+void FCombatAutoplayBot::UpdateFiring(APlayerCharacterController* Player, bool bOnTarget)
+{
+	const bool bInRange = Target.IsValid() && FVector::Dist(Player->GetActorLocation(), Target->GetActorLocation()) <= CombatAutoplay::FireDistance;
+	const bool bAirborne = Player->GetCharacterMovement()->IsFalling() || Player->bIsWallRunning;
+
+	if (!bInRange)
+	{
+		if (Player->bIsAiming)
+		{
+			Player->StopAiming();
+		}
+		return;
+	}
+
+	if (!Player->bIsAiming && !bAirborne)
+	{
+		Player->StartAiming();
+	}
+
+	if (Player->WeaponManager && Player->WeaponManager->IsCurrentWeaponAmmoEmpty())
+	{
+		if (Time >= NextReload)
+		{
+			Player->StopFiring();
+			Player->Reloading();
+			NextReload = Time + 1.0f;
+		}
+		return;
+	}
+
+	if (Player->bIsFiring)
+	{
+		if (Time >= BurstEnd || !bOnTarget)
+		{
+			Player->StopFiring();
+			NextBurst = Time + Random.FRandRange(0.1f, 0.6f);
+		}
+	}
+	else if (bOnTarget && Time >= NextBurst)
+	{
+		Player->StartFiring();
+		BurstEnd = Time + Random.FRandRange(0.3f, 1.2f);
+	}
+}
+
+void FCombatAutoplayBot::UpdateWeaponSwitch(APlayerCharacterController* Player)
+{
+	if (Time < NextWeaponSwitch || Player->bIsWeaponHolstering) return;
+
+	if (Player->GetCharacterMovement()->IsFalling()) return;
+
+	// Switching is refused while aiming, the bot lowers the weapon first like a player would
+	if (Player->bIsAiming)
+	{
+		Player->StopAiming();
+	}
+
+	switch (Random.RandRange(0, 2))
+	{
+	case 0:
+		Player->StartSwitchToPrimary1();
+		break;
+	case 1:
+		Player->StartSwitchToPrimary2();
+		break;
+	default:
+		Player->StartSwitchToSecondary();
+		break;
+	}
+
+	NextWeaponSwitch = Time + Random.FRandRange(15.0f, 40.0f);
+}
+
+void FCombatAutoplayBot::UpdateJumping(APlayerCharacterController* Player)
+{
+	if (JumpRelease > 0.0f && Time >= JumpRelease)
+	{
+		Player->StopJumping();
+		JumpRelease = 0.0f;
+	}
+
+	// Wall jump off after a short run so both halves of the wall-run path get exercised
+	if (Player->bIsWallRunning)
+	{
+		if (!bWasWallRunning)
+		{
+			WallJumpTime = Time + Random.FRandRange(0.4f, 1.2f);
+		}
+		bWasWallRunning = true;
+
+		if (Time >= WallJumpTime)
+		{
+			Player->HandleJump();
+			JumpRelease = Time + 0.1f;
+			WallJumpTime = TNumericLimits<float>::Max();
+		}
+		return;
+	}
+	bWasWallRunning = false;
+
+	if (Time < NextJump || Player->GetCharacterMovement()->IsFalling()) return;
+
+	// Jump when the index says a wall is beside us, otherwise only now and then
+	bool bNearWall = false;
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(Player);
+	if (AWallRunSurfaceIndex* WallRunIndex = Registry ? Registry->GetWallRunIndex() : nullptr)
+	{
+		const FWallRunSurface* RightSurface = nullptr;
+		const FWallRunSurface* LeftSurface = nullptr;
+		bNearWall = WallRunIndex->FindSurfaces(Player->GetActorLocation(), Player->GetActorRightVector(), Player->WallDetectionDistance * 2.0f, RightSurface, LeftSurface);
+	}
+
+	if (bNearWall || Random.FRand() < 0.25f)
+	{
+		Player->HandleJump();
+		JumpRelease = Time + 0.1f;
+	}
+
+	NextJump = Time + (bNearWall ? Random.FRandRange(2.0f, 4.0f) : Random.FRandRange(3.0f, 8.0f));
+}
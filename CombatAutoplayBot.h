@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+class AActor;
+class APlayerCharacterController;
+
+/**
+ * Scripted stand-in for the person at the controls. Drives the player only through the
+ * functions the input bindings call (Move, Look, HandleJump, StartAiming, StartFiring,
+ * Reloading, the weapon switches), so a bot run exercises the same code a real session does.
+ *
+ * The policy is deliberately simple: turn towards the nearest live enemy, close in to
+ * engagement range, strafe, aim and fire in bursts, reload when empty, switch weapons now
+ * and then and jump at indexed walls to wall run. Every random choice comes from one
+ * FRandomStream, so the same seed and a fixed step (-benchmark -fps=60) replay the same run.
+ */
+class COMBATSYSTEM_API FCombatAutoplayBot
+{
+public:
+
+	// Reseeds the policy and forgets the current player. Call when a level starts.
+	void Reset(int32 Seed);
+
+	// Feeds one frame of input to Player
+	void Tick(APlayerCharacterController* Player, float DeltaSeconds);
+
+	AActor* GetTarget() const { return Target.Get(); }
+
+private:
+
+	AActor* PickTarget(APlayerCharacterController* Player) const;
+
+	// Turns the control rotation towards DesiredRotation through Look
+	void Steer(APlayerCharacterController* Player, const FRotator& DesiredRotation);
+
+	void UpdateFiring(APlayerCharacterController* Player, bool bOnTarget);
+
+	void UpdateWeaponSwitch(APlayerCharacterController* Player);
+
+	void UpdateJumping(APlayerCharacterController* Player);
+
+	FRandomStream Random;
+
+	TWeakObjectPtr<APlayerCharacterController> CurrentPlayer;
+
+	TWeakObjectPtr<AActor> Target;
+
+	float Time = 0.0f;
+
+	// Look input is scaled by the player controller (and inverted for pitch by the legacy
+	// input scales), so the rotation each unit of input produces is measured, not assumed
+	FRotator LastControlRotation = FRotator::ZeroRotator;
+
+	FVector2D LastLookInput = FVector2D::ZeroVector;
+
+	FVector2D LookResponse = FVector2D(1.0f, 1.0f);
+
+	float WanderYaw = 0.0f;
+
+	float Strafe = 0.0f;
+
+	float NextStrafeChange = 0.0f;
+
+	float BurstEnd = 0.0f;
+
+	float NextBurst = 0.0f;
+
+	float NextReload = 0.0f;
+
+	float NextWeaponSwitch = 0.0f;
+
+	float NextJump = 0.0f;
+
+	float JumpRelease = 0.0f;
+
+	float WallJumpTime = 0.0f;
+
+	bool bWasWallRunning = false;
+
+	// Progress check, the bot turns and jumps when it has been pushing against something
+	FVector StuckCheckLocation = FVector::ZeroVector;
+
+	float NextStuckCheck = 0.0f;
+};
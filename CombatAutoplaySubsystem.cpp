@@ -0,0 +1,309 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatAutoplaySubsystem.h"
+#include "CombatActorRegistry.h"
+#include "CombatSnapshotSubsystem.h"
+#include "PlayerCharacterController.h"
+#include "EngineUtils.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectArray.h"
+
+namespace CombatAutoplay
+{
+	// The level flow ends at the main menu, which has no player; the loop restarts from there
+	static constexpr float MenuTimeout = 10.0f;
+
+	// Long enough for the death animation and anything the level does on death
+	static constexpr float RespawnDelay = 5.0f;
+
+	static void StartAutoplay(const TArray<FString>& Args, UWorld* World)
+	{
+		UCombatAutoplaySubsystem* Autoplay = UCombatAutoplaySubsystem::Get(World);
+		if (!Autoplay) return;
+
+		const int32 Seed = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1;
+		const float Hours = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.0f;
+		Autoplay->StartAutoplay(Seed, Hours);
+	}
+
+	static void StopAutoplay(UWorld* World)
+	{
+		if (UCombatAutoplaySubsystem* Autoplay = UCombatAutoplaySubsystem::Get(World))
+		{
+			Autoplay->StopAutoplay();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs StartCommand(
+		TEXT("Combat.Autoplay.Start"),
+		TEXT("Combat.Autoplay.Start [Seed] [Hours]: hands the player to the autoplay bot and starts soak sampling."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartAutoplay));
+
+	static FAutoConsoleCommandWithWorld StopCommand(
+		TEXT("Combat.Autoplay.Stop"),
+		TEXT("Stops the autoplay bot and soak sampling."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&StopAutoplay));
+}
+
+UCombatAutoplaySubsystem* UCombatAutoplaySubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UCombatAutoplaySubsystem>() : nullptr;
+}
+
+void UCombatAutoplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	StartMap = TEXT("GameLevel_1");
+	FParse::Value(CommandLine, TEXT("AutoplayMap="), StartMap);
+
+	FParse::Value(CommandLine, TEXT("AutoplaySampleSeconds="), SampleIntervalSeconds);
+	SampleIntervalSeconds = FMath::Max(1.0, SampleIntervalSeconds);
+
+	if (FParse::Param(CommandLine, TEXT("CombatAutoplay")))
+	{
+		int32 CommandLineSeed = 1;
+		FParse::Value(CommandLine, TEXT("AutoplaySeed="), CommandLineSeed);
+
+		float Hours = 0.0f;
+		FParse::Value(CommandLine, TEXT("AutoplayHours="), Hours);
+
+		StartAutoplay(CommandLineSeed, Hours);
+	}
+}
+
+void UCombatAutoplaySubsystem::Deinitialize()
+{
+	StopAutoplay();
+
+	Super::Deinitialize();
+}
+
+void UCombatAutoplaySubsystem::StartAutoplay(int32 InSeed, float DurationHours)
+{
+	StopAutoplay();
+
+	Seed = InSeed;
+	DurationSeconds = FMath::Max(0.0, DurationHours * 3600.0);
+
+	StartTime = FPlatformTime::Seconds();
+	LastTickTime = StartTime;
+	NextSampleTime = StartTime + SampleIntervalSeconds;
+
+	CurrentWorld = nullptr;
+	LevelsStarted = 0;
+	LevelsCleared = 0;
+	Deaths = 0;
+	NoPlayerSeconds = 0.0f;
+	DeadSeconds = 0.0f;
+	bPlayerDown = false;
+	WindowFrameMsSum = 0.0;
+	WindowFrameMsMax = 0.0;
+	WindowFrames = 0;
+	bHasFirstSample = false;
+
+	ReportPath = FPaths::ProfilingDir() / TEXT("CombatSoak") / FString::Printf(TEXT("Soak_%s_Seed%d.csv"), *FDateTime::Now().ToString(), Seed);
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UCombatAutoplaySubsystem::Tick));
+
+	UE_LOG(LogTemp, Display, TEXT("Autoplay started: seed %d, %s, sampling every %.0f s to %s"),
+		Seed, DurationSeconds > 0.0 ? *FString::Printf(TEXT("%.2f h"), DurationHours) : TEXT("until stopped"), SampleIntervalSeconds, *ReportPath);
+}
+
+void UCombatAutoplaySubsystem::StopAutoplay()
+{
+	if (!TickerHandle.IsValid()) return;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	// Let go of the trigger, the bot won't be around to release it
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (APlayerCharacterController* Player = World ? Cast<APlayerCharacterController>(UGameplayStatics::GetPlayerPawn(World, 0)) : nullptr)
+	{
+		Player->StopFiring();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Autoplay stopped after %.1f min: %d levels started, %d cleared, %d deaths"),
+		(FPlatformTime::Seconds() - StartTime) / 60.0, LevelsStarted, LevelsCleared, Deaths);
+}
+
+bool UCombatAutoplaySubsystem::Tick(float DeltaTime)
+{
+	// Wall-clock frame time: with -benchmark the game's delta is fixed and would hide any drift
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - LastTickTime) * 1000.0;
+	LastTickTime = Now;
+
+	WindowFrameMsSum += FrameMs;
+	WindowFrameMsMax = FMath::Max(WindowFrameMsMax, FrameMs);
+	WindowFrames++;
+
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World && World->IsGameWorld())
+	{
+		TickLevelLoop(World, DeltaTime);
+	}
+
+	if (Now >= NextSampleTime)
+	{
+		TakeSample(World);
+		NextSampleTime = Now + SampleIntervalSeconds;
+	}
+
+	if (DurationSeconds > 0.0 && Now - StartTime >= DurationSeconds)
+	{
+		TakeSample(World);
+		StopAutoplay();
+
+		// A timed run is a CI run, nobody is left to close the game
+		FPlatformMisc::RequestExit(false);
+		return false;
+	}
+
+	return true;
+}
+
+void UCombatAutoplaySubsystem::TickLevelLoop(UWorld* World, float DeltaSeconds)
+{
+	if (CurrentWorld.Get() != World)
+	{
+		CurrentWorld = World;
+		bLevelCleared = false;
+		bPlayerDown = false;
+		NoPlayerSeconds = 0.0f;
+		DeadSeconds = 0.0f;
+
+		// Every level gets its own stream, so a level plays the same however long the previous one took
+		Bot.Reset(HashCombine(GetTypeHash(Seed), GetTypeHash(LevelsStarted)));
+		LevelsStarted++;
+
+		UE_LOG(LogTemp, Display, TEXT("Autoplay: level %d, %s"), LevelsStarted, *UGameplayStatics::GetCurrentLevelName(World));
+	}
+
+	APlayerCharacterController* Player = Cast<APlayerCharacterController>(UGameplayStatics::GetPlayerPawn(World, 0));
+	if (!Player)
+	{
+		NoPlayerSeconds += DeltaSeconds;
+		if (NoPlayerSeconds >= CombatAutoplay::MenuTimeout)
+		{
+			NoPlayerSeconds = 0.0f;
+			UE_LOG(LogTemp, Display, TEXT("Autoplay: no player in %s, restarting the loop at %s"), *UGameplayStatics::GetCurrentLevelName(World), *StartMap);
+			UGameplayStatics::OpenLevel(World, FName(*StartMap));
+		}
+		return;
+	}
+	NoPlayerSeconds = 0.0f;
+
+	if (Player->bIsPlayerDeadExecuted)
+	{
+		if (!bPlayerDown)
+		{
+			bPlayerDown = true;
+			Deaths++;
+			DeadSeconds = 0.0f;
+		}
+
+		DeadSeconds += DeltaSeconds;
+		if (DeadSeconds >= CombatAutoplay::RespawnDelay)
+		{
+			DeadSeconds = 0.0f;
+
+			// Back to the checkpoint when there is one, otherwise the level starts over
+			UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(World);
+			if (!Snapshots || !Snapshots->HasCheckpoint() || !Snapshots->RestoreCheckpoint())
+			{
+				UGameplayStatics::OpenLevel(World, FName(*UGameplayStatics::GetCurrentLevelName(World)));
+			}
+		}
+		return;
+	}
+	bPlayerDown = false;
+
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(World);
+	if (Registry && !bLevelCleared && Registry->GetTotalEnemyCount() > 0 && Registry->GetAliveEnemyCount() == 0)
+	{
+		bLevelCleared = true;
+		LevelsCleared++;
+		UE_LOG(LogTemp, Display, TEXT("Autoplay: cleared %s (%d levels cleared)"), *UGameplayStatics::GetCurrentLevelName(World), LevelsCleared);
+	}
+
+	Bot.Tick(Player, DeltaSeconds);
+}
+
+void UCombatAutoplaySubsystem::TakeSample(UWorld* World)
+{
+	FCombatSoakSample Sample;
+	Sample.ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+	Sample.Level = World ? UGameplayStatics::GetCurrentLevelName(World) : FString(TEXT("None"));
+	Sample.UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+	Sample.UObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	if (World)
+	{
+		for (FActorIterator It(World); It; ++It)
+		{
+			Sample.Actors++;
+		}
+
+		if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(World))
+		{
+			Sample.Enemies = Registry->GetEnemies().Num();
+			Sample.ActiveTimers = Registry->CountActiveCombatTimers();
+		}
+	}
+
+	Sample.MeanFrameMs = WindowFrames > 0 ? WindowFrameMsSum / WindowFrames : 0.0;
+	Sample.MaxFrameMs = WindowFrameMsMax;
+	Sample.LevelsCleared = LevelsCleared;
+	Sample.Deaths = Deaths;
+
+	WindowFrameMsSum = 0.0;
+	WindowFrameMsMax = 0.0;
+	WindowFrames = 0;
+
+	if (!bHasFirstSample)
+	{
+		FirstSample = Sample;
+		bHasFirstSample = true;
+	}
+
+	const double FrameDriftPct = FirstSample.MeanFrameMs > 0.0 ? (Sample.MeanFrameMs / FirstSample.MeanFrameMs - 1.0) * 100.0 : 0.0;
+
+	UE_LOG(LogTemp, Display, TEXT("Autoplay soak %.1f min [%s]: %.1f MB (%+.1f), %d UObjects (%+d), %d actors (%+d), %d enemies, %d timers, frame %.2f ms (%+.1f%%) max %.2f ms, %d cleared, %d deaths"),
+		Sample.ElapsedSeconds / 60.0, *Sample.Level,
+		Sample.UsedPhysicalMB, Sample.UsedPhysicalMB - FirstSample.UsedPhysicalMB,
+		Sample.UObjects, Sample.UObjects - FirstSample.UObjects,
+		Sample.Actors, Sample.Actors - FirstSample.Actors,
+		Sample.Enemies, Sample.ActiveTimers,
+		Sample.MeanFrameMs, FrameDriftPct, Sample.MaxFrameMs,
+		Sample.LevelsCleared, Sample.Deaths);
+
+	WriteSample(Sample);
+}
+
+void UCombatAutoplaySubsystem::WriteSample(const FCombatSoakSample& Sample)
+{
+	FString Row;
+	if (!IFileManager::Get().FileExists(*ReportPath))
+	{
+		Row = TEXT("ElapsedSeconds,Level,UsedPhysicalMB,UObjects,Actors,Enemies,ActiveTimers,MeanFrameMs,MaxFrameMs,LevelsCleared,Deaths\n");
+	}
+
+	Row += FString::Printf(TEXT("%.1f,%s,%.2f,%d,%d,%d,%d,%.3f,%.3f,%d,%d\n"),
+		Sample.ElapsedSeconds, *Sample.Level, Sample.UsedPhysicalMB, Sample.UObjects, Sample.Actors,
+		Sample.Enemies, Sample.ActiveTimers, Sample.MeanFrameMs, Sample.MaxFrameMs, Sample.LevelsCleared, Sample.Deaths);
+
+	FFileHelper::SaveStringToFile(Row, *ReportPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "CombatAutoplayBot.h"
+#include "CombatAutoplaySubsystem.generated.h"
+
+class UWorld;
+
+// One soak sample: process, world and frame-time state over the last sample window
+struct FCombatSoakSample
+{
+	double ElapsedSeconds = 0.0;
+
+	FString Level;
+
+	double UsedPhysicalMB = 0.0;
+
+	int32 UObjects = 0;
+
+	int32 Actors = 0;
+
+	int32 Enemies = 0;
+
+	int32 ActiveTimers = 0;
+
+	double MeanFrameMs = 0.0;
+
+	double MaxFrameMs = 0.0;
+
+	int32 LevelsCleared = 0;
+
+	int32 Deaths = 0;
+};
+
+/**
+ * Unattended soak runs. Hands the local player to an FCombatAutoplayBot, follows it through
+ * level travel, brings it back after deaths and restarts the level loop from the main menu,
+ * for as long as the run lasts:
+ *
+ *   <Game> GameLevel_1 -game -nullrhi -unattended -benchmark -fps=60
+ *     -CombatAutoplay [-AutoplaySeed=1] [-AutoplayHours=4] [-AutoplaySampleSeconds=60] [-AutoplayMap=GameLevel_1]
+ *
+ * or Combat.Autoplay.Start [Seed] / Combat.Autoplay.Stop from the console. Every sample
+ * window logs memory, UObject, actor and combat timer counts and frame time against the
+ * first sample, and appends them to Saved/Profiling/CombatSoak, so leaked actors or timers
+ * show up as steady growth across levels.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatAutoplaySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatAutoplaySubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// DurationHours <= 0 runs until stopped
+	void StartAutoplay(int32 Seed, float DurationHours = 0.0f);
+
+	void StopAutoplay();
+
+	bool IsRunning() const { return TickerHandle.IsValid(); }
+
+private:
+
+	bool Tick(float DeltaTime);
+
+	void TickLevelLoop(UWorld* World, float DeltaSeconds);
+
+	void TakeSample(UWorld* World);
+
+	void WriteSample(const FCombatSoakSample& Sample);
+
+	FCombatAutoplayBot Bot;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	int32 Seed = 0;
+
+	double DurationSeconds = 0.0;
+
+	double SampleIntervalSeconds = 60.0;
+
+	FString StartMap;
+
+	double StartTime = 0.0;
+
+	double LastTickTime = 0.0;
+
+	double NextSampleTime = 0.0;
+
+	TWeakObjectPtr<UWorld> CurrentWorld;
+
+	int32 LevelsStarted = 0;
+
+	int32 LevelsCleared = 0;
+
+	int32 Deaths = 0;
+
+	bool bLevelCleared = false;
+
+	// Time spent without a live player, in a menu or dead
+	float NoPlayerSeconds = 0.0f;
+
+	float DeadSeconds = 0.0f;
+
+	// Set from the death until the player is back, so one death is counted once
+	bool bPlayerDown = false;
+
+	double WindowFrameMsSum = 0.0;
+
+	double WindowFrameMsMax = 0.0;
+
+	int32 WindowFrames = 0;
+
+	bool bHasFirstSample = false;
+
+	FCombatSoakSample FirstSample;
+
+	FString ReportPath;
+};
@@ -0,0 +1,392 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatBenchLevel.h"
+#include "EnemyBase.h"
+#include "LevelManager.h"
+#include "WallRunSurfaceIndex.h"
+#include "WeaponActor.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/PlayerStart.h"
+
+namespace CombatBenchLevel
+{
+	static constexpr int32 NumTiers = 3;
+
+	// Nothing but enemies' line of fire within this distance of the player start
+	static constexpr float SpawnClearance = 700.0f;
+
+	static constexpr float CoverCellSize = 500.0f;
+
+	// Same 400 x 20 x 300 wall the wall-run benches use
+	static const FVector WallScale(4.0f, 0.2f, 3.0f);
+
+	static const FVector CoverScale(1.0f, 1.0f, 1.2f);
+
+	// Separate streams per element, so sweeping one count does not move the others
+	enum EStream : uint32
+	{
+		WallStream = 1,
+		CoverStream,
+		EnemyStream
+	};
+
+	static FRandomStream MakeStream(int32 Seed, EStream Stream)
+	{
+		return FRandomStream(static_cast<int32>(HashCombine(GetTypeHash(Seed), GetTypeHash(static_cast<uint32>(Stream)))));
+	}
+
+	static FVector RandomInAnnulus(FRandomStream& Random, float MinRadius, float MaxRadius)
+	{
+		const float Angle = Random.FRand() * 2.0f * PI;
+		const float Radius = FMath::Sqrt(FMath::Lerp(MinRadius * MinRadius, MaxRadius * MaxRadius, Random.FRand()));
+		return FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0f);
+	}
+
+	static const TCHAR* WallLayoutNames[] = { TEXT("Grid"), TEXT("Corridors"), TEXT("Scatter") };
+
+	static const TCHAR* PlacementNames[] = { TEXT("Ring"), TEXT("Scatter"), TEXT("Clusters") };
+
+	template <typename EnumType, int32 NumNames>
+	static EnumType ParseEnum(const TCHAR* (&Names)[NumNames], const FString& Value, EnumType Default)
+	{
+		for (int32 Index = 0; Index < NumNames; ++Index)
+		{
+			if (Value.Equals(Names[Index], ESearchCase::IgnoreCase))
+			{
+				return static_cast<EnumType>(Index);
+			}
+		}
+
+		UE_LOG(LogTemp, Warning, TEXT("Unknown benchmark level option %s, using %s."), *Value, Names[static_cast<int32>(Default)]);
+		return Default;
+	}
+
+	static AActor* SpawnBlock(UWorld* World, UStaticMesh* Mesh, const FVector& Location, const FRotator& Rotation, const FVector& Scale, FName Tag)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AStaticMeshActor* Block = World->SpawnActor<AStaticMeshActor>(Location, Rotation, SpawnParams);
+		if (!Block) return nullptr;
+
+		// Game worlds have already begun play, so the mesh can only be set on a movable component
+		Block->GetStaticMeshComponent()->SetMobility(World->IsGameWorld() ? EComponentMobility::Movable : EComponentMobility::Static);
+		Block->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+		Block->SetActorScale3D(Scale);
+		if (!Tag.IsNone())
+		{
+			Block->Tags.Add(Tag);
+		}
+		return Block;
+	}
+
+	static void SpawnWalls(UWorld* World, UStaticMesh* Mesh, const FCombatBenchLevelParams& Params, TArray<AActor*>& OutWalls)
+	{
+		FRandomStream Random = MakeStream(Params.Seed, WallStream);
+		const FName WallTag("Wall");
+		const float WallZ = 150.0f;
+
+		// Bounds every layout's loop should a spawn ever fail
+		const int32 MaxAttempts = Params.WallCount * 4 + 64;
+
+		auto AddWall = [&](const FVector& Location, float Yaw)
+		{
+			if (AActor* Wall = SpawnBlock(World, Mesh, FVector(Location.X, Location.Y, WallZ), FRotator(0.0f, Yaw, 0.0f), WallScale, WallTag))
+			{
+				OutWalls.Add(Wall);
+			}
+		};
+
+		switch (Params.WallLayout)
+		{
+		case ECombatBenchWallLayout::Grid:
+		{
+			// Rows 300 apart, 500 between walls in a row, centred on the player start
+			const int32 WallsPerRow = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Params.WallCount))) + 1;
+			const FVector Origin(-(WallsPerRow - 1) * 500.0f * 0.5f, -(WallsPerRow - 1) * 300.0f * 0.5f, 0.0f);
+
+			for (int32 Index = 0; OutWalls.Num() < Params.WallCount && Index < MaxAttempts; ++Index)
+			{
+				const FVector Location = Origin + FVector((Index % WallsPerRow) * 500.0f, (Index / WallsPerRow) * 300.0f, 0.0f);
+				if (Location.Size2D() < SpawnClearance) continue;
+
+				AddWall(Location, 0.0f);
+			}
+			break;
+		}
+		case ECombatBenchWallLayout::Corridors:
+		{
+			// Up to four segments per side, 350 across so the player can wall jump from side to side
+			for (int32 Attempt = 0; OutWalls.Num() < Params.WallCount && Attempt < MaxAttempts; ++Attempt)
+			{
+				const FVector Center = RandomInAnnulus(Random, SpawnClearance + 1000.0f, Params.ArenaRadius);
+				const FRotator Rotation(0.0f, Random.FRandRange(0.0f, 180.0f), 0.0f);
+				const FVector Along = Rotation.Vector();
+				const FVector Across = FRotationMatrix(Rotation).GetUnitAxis(EAxis::Y);
+
+				const int32 Segments = FMath::Clamp((Params.WallCount - OutWalls.Num() + 1) / 2, 1, 4);
+				for (int32 Segment = 0; Segment < Segments && OutWalls.Num() < Params.WallCount; ++Segment)
+				{
+					const FVector SegmentCenter = Center + Along * ((Segment - (Segments - 1) * 0.5f) * 420.0f);
+					AddWall(SegmentCenter + Across * 175.0f, Rotation.Yaw);
+					if (OutWalls.Num() < Params.WallCount)
+					{
+						AddWall(SegmentCenter - Across * 175.0f, Rotation.Yaw);
+					}
+				}
+			}
+			break;
+		}
+		case ECombatBenchWallLayout::Scatter:
+		{
+			for (int32 Attempt = 0; OutWalls.Num() < Params.WallCount && Attempt < MaxAttempts; ++Attempt)
+			{
+				AddWall(RandomInAnnulus(Random, SpawnClearance, Params.ArenaRadius), Random.FRandRange(0.0f, 180.0f));
+			}
+			break;
+		}
+		}
+	}
+
+	static void SpawnCover(UWorld* World, UStaticMesh* Mesh, const FCombatBenchLevelParams& Params, TArray<AActor*>& OutCover)
+	{
+		if (Params.CoverDensity <= 0.0f) return;
+
+		FRandomStream Random = MakeStream(Params.Seed, CoverStream);
+		const FName CoverTag("Cover");
+		const int32 CellsPerSide = FMath::CeilToInt(Params.ArenaRadius * 2.0f / CoverCellSize);
+
+		for (int32 Y = 0; Y < CellsPerSide; ++Y)
+		{
+			for (int32 X = 0; X < CellsPerSide; ++X)
+			{
+				// Every cell draws the same numbers whatever the density, so denser cover only adds blocks
+				const float Roll = Random.FRand();
+				const FVector Jitter(Random.FRandRange(-150.0f, 150.0f), Random.FRandRange(-150.0f, 150.0f), 0.0f);
+				const float Yaw = Random.FRandRange(0.0f, 90.0f);
+
+				const FVector CellCenter(-Params.ArenaRadius + (X + 0.5f) * CoverCellSize, -Params.ArenaRadius + (Y + 0.5f) * CoverCellSize, 0.0f);
+				const FVector Location = CellCenter + Jitter;
+				if (Roll >= Params.CoverDensity || Location.Size2D() > Params.ArenaRadius || Location.Size2D() < SpawnClearance) continue;
+
+				if (AActor* Cover = SpawnBlock(World, Mesh, FVector(Location.X, Location.Y, 60.0f), FRotator(0.0f, Yaw, 0.0f), CoverScale, CoverTag))
+				{
+					OutCover.Add(Cover);
+				}
+			}
+		}
+	}
+
+	static void SpawnEnemies(UWorld* World, const FCombatBenchLevelParams& Params, TArray<AEnemyBase*>& OutEnemies)
+	{
+		FRandomStream Random = MakeStream(Params.Seed, EnemyStream);
+
+		int32 MixTotal = 0;
+		for (int32 Weight : Params.TierMix)
+		{
+			MixTotal += Weight;
+		}
+		MixTotal = FMath::Max(MixTotal, 1);
+
+		TArray<FVector> ClusterCenters;
+		if (Params.EnemyPlacement == ECombatBenchEnemyPlacement::Clusters)
+		{
+			const int32 NumClusters = FMath::Max(1, FMath::DivideAndRoundUp(Params.EnemyCount, 10));
+			for (int32 Cluster = 0; Cluster < NumClusters; ++Cluster)
+			{
+				ClusterCenters.Add(RandomInAnnulus(Random, SpawnClearance + 800.0f, Params.ArenaRadius));
+			}
+		}
+
+		// Highest tier first, the remainder of the split goes to tier 1 like the stress sweep
+		int32 Assigned = 0;
+		for (int32 Tier = NumTiers - 1; Tier >= 0; --Tier)
+		{
+			const int32 TierCount = Tier == 0 ? Params.EnemyCount - Assigned : Params.EnemyCount * Params.TierMix[Tier] / MixTotal;
+			Assigned += TierCount;
+
+			UClass* SpawnClass = Params.TierClasses[Tier] ? Params.TierClasses[Tier] : AEnemyBase::StaticClass();
+			const FName TierTag(*FString::Printf(TEXT("EnemyTier%d"), Tier + 1));
+			const float RingRadius = FMath::Min(Params.ArenaRadius, Params.ArenaRadius * (0.4f + 0.25f * Tier));
+			const float RingPhase = Random.FRand() * 2.0f * PI;
+
+			for (int32 Index = 0; Index < TierCount; ++Index)
+			{
+				FVector Location;
+				switch (Params.EnemyPlacement)
+				{
+				case ECombatBenchEnemyPlacement::Ring:
+				{
+					const float Angle = RingPhase + 2.0f * PI * Index / FMath::Max(TierCount, 1);
+					Location = FVector(FMath::Cos(Angle) * RingRadius, FMath::Sin(Angle) * RingRadius, 0.0f);
+					break;
+				}
+				case ECombatBenchEnemyPlacement::Scatter:
+					Location = RandomInAnnulus(Random, SpawnClearance + 300.0f, Params.ArenaRadius);
+					break;
+				case ECombatBenchEnemyPlacement::Clusters:
+				default:
+					Location = ClusterCenters[OutEnemies.Num() % ClusterCenters.Num()] + RandomInAnnulus(Random, 0.0f, 400.0f);
+					break;
+				}
+				Location.Z = 100.0f;
+
+				// Facing the player start
+				const FTransform SpawnTransform(FVector(-Location.X, -Location.Y, 0.0f).Rotation(), Location);
+
+				AEnemyBase* Enemy = World->SpawnActorDeferred<AEnemyBase>(SpawnClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+				if (!Enemy) continue;
+
+				// Content enemies bring their own weapon, bare ones get the native weapon actor
+				if (!Enemy->WeaponBlueprint)
+				{
+					Enemy->WeaponBlueprint = AWeaponActor::StaticClass();
+				}
+				Enemy->Tags.AddUnique(TierTag);
+
+				Enemy->FinishSpawning(SpawnTransform);
+				OutEnemies.Add(Enemy);
+			}
+		}
+	}
+}
+
+FCombatBenchLevelParams FCombatBenchLevelParams::FromCommandLine(const FString& Params)
+{
+	using namespace CombatBenchLevel;
+
+	FCombatBenchLevelParams Result;
+
+	FParse::Value(*Params, TEXT("seed="), Result.Seed);
+	FParse::Value(*Params, TEXT("walls="), Result.WallCount);
+	FParse::Value(*Params, TEXT("enemies="), Result.EnemyCount);
+	FParse::Value(*Params, TEXT("cover="), Result.CoverDensity);
+	FParse::Value(*Params, TEXT("arena="), Result.ArenaRadius);
+
+	FString Value;
+	if (FParse::Value(*Params, TEXT("layout="), Value))
+	{
+		Result.WallLayout = ParseEnum(WallLayoutNames, Value, Result.WallLayout);
+	}
+	if (FParse::Value(*Params, TEXT("placement="), Value))
+	{
+		Result.EnemyPlacement = ParseEnum(PlacementNames, Value, Result.EnemyPlacement);
+	}
+
+	if (FParse::Value(*Params, TEXT("mix="), Value, false))
+	{
+		TArray<FString> Parts;
+		Value.ParseIntoArray(Parts, TEXT(","));
+		for (int32 Tier = 0; Tier < NumTiers; ++Tier)
+		{
+			Result.TierMix[Tier] = Parts.IsValidIndex(Tier) ? FMath::Max(0, FCString::Atoi(*Parts[Tier])) : 0;
+		}
+	}
+
+	for (int32 Tier = 0; Tier < NumTiers; ++Tier)
+	{
+		if (!FParse::Value(*Params, *FString::Printf(TEXT("tier%d="), Tier + 1), Value)) continue;
+
+		Result.TierClasses[Tier] = LoadClass<AEnemyBase>(nullptr, *Value);
+		if (!Result.TierClasses[Tier])
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Tier %d class %s could not be loaded, using AEnemyBase."), Tier + 1, *Value);
+		}
+	}
+
+	Result.bSpawnLevelManager = !FParse::Param(*Params, TEXT("nolevelmanager"));
+	Result.bSpawnWallRunIndex = !FParse::Param(*Params, TEXT("nowallrunindex"));
+
+	Result.WallCount = FMath::Max(0, Result.WallCount);
+	Result.EnemyCount = FMath::Max(0, Result.EnemyCount);
+	Result.CoverDensity = FMath::Clamp(Result.CoverDensity, 0.0f, 1.0f);
+	Result.ArenaRadius = FMath::Max(Result.ArenaRadius, 2.0f * SpawnClearance);
+	return Result;
+}
+
+bool FCombatBenchLevelParams::SetByName(const FString& Name, const FString& Value)
+{
+	if (Name == TEXT("walls"))
+	{
+		WallCount = FMath::Max(0, FCString::Atoi(*Value));
+	}
+	else if (Name == TEXT("enemies"))
+	{
+		EnemyCount = FMath::Max(0, FCString::Atoi(*Value));
+	}
+	else if (Name == TEXT("cover"))
+	{
+		CoverDensity = FMath::Clamp(FCString::Atof(*Value), 0.0f, 1.0f);
+	}
+	else if (Name == TEXT("arena"))
+	{
+		ArenaRadius = FMath::Max(FCString::Atof(*Value), 2.0f * CombatBenchLevel::SpawnClearance);
+	}
+	else if (Name == TEXT("seed"))
+	{
+		Seed = FCString::Atoi(*Value);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+FString FCombatBenchLevelParams::GetLevelName() const
+{
+	using namespace CombatBenchLevel;
+
+	return FString::Printf(TEXT("Bench_S%d_%sW%d_%sE%d_C%d_A%d"),
+		Seed, WallLayoutNames[static_cast<int32>(WallLayout)], WallCount,
+		PlacementNames[static_cast<int32>(EnemyPlacement)], EnemyCount,
+		FMath::RoundToInt32(CoverDensity * 100.0f), FMath::RoundToInt32(ArenaRadius));
+}
+
+void FCombatBenchLevelGenerator::Populate(UWorld* World, const FCombatBenchLevelParams& Params, FCombatBenchLevelContents& OutContents)
+{
+	using namespace CombatBenchLevel;
+
+	if (!World) return;
+
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!CubeMesh)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Benchmark level needs /Engine/BasicShapes/Cube, nothing generated."));
+		return;
+	}
+
+	// Floor with its top at z = 0, a little larger than the arena
+	const float FloorScale = Params.ArenaRadius * 2.4f / 100.0f;
+	SpawnBlock(World, CubeMesh, FVector(0.0f, 0.0f, -5.0f), FRotator::ZeroRotator, FVector(FloorScale, FloorScale, 0.1f), NAME_None);
+
+	OutContents.PlayerStart = FVector(0.0f, 0.0f, 100.0f);
+	World->SpawnActor<APlayerStart>(OutContents.PlayerStart, FRotator::ZeroRotator);
+
+	SpawnWalls(World, CubeMesh, Params, OutContents.Walls);
+	SpawnCover(World, CubeMesh, Params, OutContents.Cover);
+
+	// After the walls, so a game world's BeginPlay bake finds them; editor worlds are baked here
+	if (Params.bSpawnWallRunIndex)
+	{
+		OutContents.WallRunIndex = World->SpawnActor<AWallRunSurfaceIndex>(FVector::ZeroVector, FRotator::ZeroRotator);
+		if (OutContents.WallRunIndex && !World->IsGameWorld())
+		{
+			OutContents.WallRunIndex->BakeSurfaces();
+		}
+	}
+
+	SpawnEnemies(World, Params, OutContents.Enemies);
+
+	if (Params.bSpawnLevelManager)
+	{
+		OutContents.LevelManager = World->SpawnActor<ALevelManager>(FVector::ZeroVector, FRotator::ZeroRotator);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Generated %s: %d walls, %d cover blocks, %d enemies"),
+		*Params.GetLevelName(), OutContents.Walls.Num(), OutContents.Cover.Num(), OutContents.Enemies.Num());
+}
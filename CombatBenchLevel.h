@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+class AActor;
+class AEnemyBase;
+class ALevelManager;
+class AWallRunSurfaceIndex;
+
+enum class ECombatBenchWallLayout : uint8
+{
+	// Rows of parallel walls, the layout the wall-run benches have always used
+	Grid,
+	// Pairs of wall runs facing each other across a corridor
+	Corridors,
+	Scatter
+};
+
+enum class ECombatBenchEnemyPlacement : uint8
+{
+	// One ring per tier around the player start
+	Ring,
+	Scatter,
+	// Groups of around ten enemies
+	Clusters
+};
+
+/**
+ * Everything a benchmark level is generated from. The same parameters always produce the
+ * same level: walls, cover and enemies each draw from their own stream derived from Seed,
+ * so a sweep over one parameter leaves everything else where it was.
+ */
+struct COMBATSYSTEM_API FCombatBenchLevelParams
+{
+	int32 Seed = 1;
+
+	int32 WallCount = 100;
+
+	ECombatBenchWallLayout WallLayout = ECombatBenchWallLayout::Grid;
+
+	int32 EnemyCount = 50;
+
+	// Relative weights of tiers 1-3
+	int32 TierMix[3] = { 1, 1, 1 };
+
+	// Enemy class per tier, AEnemyBase when null
+	UClass* TierClasses[3] = {};
+
+	ECombatBenchEnemyPlacement EnemyPlacement = ECombatBenchEnemyPlacement::Ring;
+
+	// Fraction of the arena's 5 m cells holding a cover block, 0-1
+	float CoverDensity = 0.1f;
+
+	float ArenaRadius = 5000.0f;
+
+	bool bSpawnLevelManager = true;
+
+	bool bSpawnWallRunIndex = true;
+
+	// Reads -seed= -walls= -layout= -enemies= -mix= -tier1..3= -placement= -cover= -arena= -nolevelmanager -nowallrunindex
+	static FCombatBenchLevelParams FromCommandLine(const FString& Params);
+
+	// Sets a sweepable parameter by its command line name (walls, enemies, cover, arena, seed)
+	bool SetByName(const FString& Name, const FString& Value);
+
+	// Map name that identifies the parameters, e.g. Bench_S1_GridW100_RingE50_C10
+	FString GetLevelName() const;
+};
+
+struct FCombatBenchLevelContents
+{
+	TArray<AActor*> Walls;
+
+	TArray<AActor*> Cover;
+
+	TArray<AEnemyBase*> Enemies;
+
+	ALevelManager* LevelManager = nullptr;
+
+	AWallRunSurfaceIndex* WallRunIndex = nullptr;
+
+	FVector PlayerStart = FVector::ZeroVector;
+};
+
+/**
+ * Fills a world with a benchmark level: floor, "Wall"-tagged walls, "Cover"-tagged blocks,
+ * tier-tagged enemies, a player start, a level manager and a wall-run index. Works on game
+ * worlds (headless runs, everything begins play as it spawns) and on editor worlds that
+ * the CombatBenchLevel commandlet saves as maps.
+ */
+struct COMBATSYSTEM_API FCombatBenchLevelGenerator
+{
+	static void Populate(UWorld* World, const FCombatBenchLevelParams& Params, FCombatBenchLevelContents& OutContents);
+};
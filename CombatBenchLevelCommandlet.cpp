@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatBenchLevelCommandlet.h"
+#include "CombatBenchLevel.h"
+#include "CombatHeadlessWorld.h"
+#include "CombatStats.h"
+#include "EnemyBase.h"
+#include "PlayerCharacterController.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+namespace CombatBenchLevelGen
+{
+	static constexpr float FrameDelta = 1.0f / 60.0f;
+
+	static constexpr int32 WarmupFrames = 60;
+
+	// Frames between launches along a wall, like the WallRunTraversal perf scenario
+	static constexpr int32 LaunchInterval = 45;
+
+	struct FProfilePoint
+	{
+		FString LevelName;
+
+		int32 Walls = 0;
+
+		int32 Cover = 0;
+
+		int32 Enemies = 0;
+
+		double P50Ms = 0.0;
+
+		double P95Ms = 0.0;
+
+		double MaxMs = 0.0;
+
+		// Per-frame average over the measured frames
+		double Traces = 0.0;
+
+		int32 WallRuns = 0;
+	};
+
+	static double Percentile(const TArray<double>& Sorted, double Pct)
+	{
+		if (Sorted.Num() == 0) return 0.0;
+		return Sorted[FMath::Min(Sorted.Num() - 1, FMath::FloorToInt32(Sorted.Num() * Pct / 100.0))];
+	}
+
+	static bool SaveLevel(const FCombatBenchLevelParams& LevelParams, const FString& PackageRoot)
+	{
+#if WITH_EDITOR
+		const FString LevelName = LevelParams.GetLevelName();
+		const FString PackageName = PackageRoot / LevelName;
+
+		UPackage* Package = CreatePackage(*PackageName);
+		UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false, FName(*LevelName), Package);
+		World->SetFlags(RF_Public | RF_Standalone);
+
+		FCombatBenchLevelContents Contents;
+		FCombatBenchLevelGenerator::Populate(World, LevelParams, Contents);
+
+		const FString FileName = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetMapPackageExtension());
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.SaveFlags = SAVE_NoError;
+		const bool bSaved = UPackage::SavePackage(Package, World, *FileName, SaveArgs);
+
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		UE_LOG(LogTemp, Display, TEXT("%s %s"), bSaved ? TEXT("Saved") : TEXT("Failed to save"), *FileName);
+		return bSaved;
+#else
+		UE_LOG(LogTemp, Error, TEXT("Benchmark levels can only be saved from an editor build, use -profile here."));
+		return false;
+#endif
+	}
+
+	static FProfilePoint ProfileLevel(const FCombatBenchLevelParams& LevelParams, int32 Frames)
+	{
+		FCombatHeadlessWorld HeadlessWorld;
+
+		FCombatBenchLevelContents Contents;
+		FCombatBenchLevelGenerator::Populate(HeadlessWorld.GetWorld(), LevelParams, Contents);
+
+		APlayerCharacterController* Player = HeadlessWorld.SpawnPlayer(Contents.PlayerStart);
+		for (AEnemyBase* Enemy : Contents.Enemies)
+		{
+			FCombatHeadlessWorld::ArmEnemy(Enemy, Player);
+		}
+
+		// Same seed as the level, so a variant always launches along the same walls
+		FRandomStream Random(LevelParams.Seed);
+		int32 WallRuns = 0;
+		bool bWasWallRunning = false;
+
+		auto StepPlayer = [&](int32 Frame)
+		{
+			if (!Player) return;
+
+			if (Player->CurrentHealthPool < Player->MaxHealthPool * 0.5f)
+			{
+				Player->RestoreCombatState(Player->MaxShieldPool, Player->MaxHealthPool);
+			}
+
+			WallRuns += Player->bIsWallRunning && !bWasWallRunning ? 1 : 0;
+			bWasWallRunning = Player->bIsWallRunning;
+
+			if (Contents.Walls.Num() == 0 || Frame % LaunchInterval != 0) return;
+
+			// Alongside the wall's face, running the length of it; the player's tick finds the wall and starts the run
+			const AActor* Wall = Contents.Walls[Random.RandHelper(Contents.Walls.Num())];
+			const FVector Start = Wall->GetActorLocation() - Wall->GetActorForwardVector() * 200.0f + Wall->GetActorRightVector() * 62.0f + FVector(0.0f, 0.0f, 50.0f);
+
+			Player->GetCharacterMovement()->StopMovementImmediately();
+			Player->SetActorLocation(Start, false, nullptr, ETeleportType::TeleportPhysics);
+			Player->LaunchCharacter(Wall->GetActorForwardVector() * Player->WalkSpeed * 2.0f + FVector(0.0f, 0.0f, 300.0f), true, true);
+		};
+
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			StepPlayer(Frame);
+			HeadlessWorld.Tick(FrameDelta);
+		}
+
+		const FCombatCounterTotals StartTotals = GCombatCounterTotals;
+		WallRuns = 0;
+
+		TArray<double> FrameTimes;
+		FrameTimes.Reserve(Frames);
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			StepPlayer(Frame);
+			FrameTimes.Add(HeadlessWorld.Tick(FrameDelta));
+		}
+
+		FrameTimes.Sort();
+
+		FProfilePoint Point;
+		Point.LevelName = LevelParams.GetLevelName();
+		Point.Walls = Contents.Walls.Num();
+		Point.Cover = Contents.Cover.Num();
+		Point.Enemies = Contents.Enemies.Num();
+		Point.P50Ms = Percentile(FrameTimes, 50.0);
+		Point.P95Ms = Percentile(FrameTimes, 95.0);
+		Point.MaxMs = FrameTimes.Num() > 0 ? FrameTimes.Last() : 0.0;
+		Point.Traces = double(GCombatCounterTotals.Traces - StartTotals.Traces) / Frames;
+		Point.WallRuns = WallRuns;
+		return Point;
+	}
+}
+
+UCombatBenchLevelCommandlet::UCombatBenchLevelCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatBenchLevelCommandlet::Main(const FString& Params)
+{
+	using namespace CombatBenchLevelGen;
+
+	const FCombatBenchLevelParams BaseParams = FCombatBenchLevelParams::FromCommandLine(Params);
+
+	// One variant per sweep value, or just the base parameters
+	FString SweepName;
+	TArray<FString> SweepValues;
+	FString SweepParam;
+	if (FParse::Value(*Params, TEXT("sweep="), SweepParam, false))
+	{
+		FString ValueList;
+		if (!SweepParam.Split(TEXT(":"), &SweepName, &ValueList))
+		{
+			UE_LOG(LogTemp, Error, TEXT("-sweep expects <param>:v1,v2,..., got %s"), *SweepParam);
+			return 1;
+		}
+		ValueList.ParseIntoArray(SweepValues, TEXT(","));
+	}
+
+	TArray<FCombatBenchLevelParams> Variants;
+	if (SweepValues.Num() == 0)
+	{
+		Variants.Add(BaseParams);
+	}
+	for (const FString& Value : SweepValues)
+	{
+		FCombatBenchLevelParams& Variant = Variants.Add_GetRef(BaseParams);
+		if (!Variant.SetByName(SweepName, Value))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot sweep %s, use walls, enemies, cover, arena or seed."), *SweepName);
+			return 1;
+		}
+	}
+
+	const bool bProfile = FParse::Param(*Params, TEXT("profile"));
+
+	FString PackageRoot = TEXT("/Game/Benchmark");
+	const bool bSave = FParse::Value(*Params, TEXT("save="), PackageRoot) || FParse::Param(*Params, TEXT("save")) || !bProfile;
+
+	int32 Frames = 600;
+	FParse::Value(*Params, TEXT("frames="), Frames);
+	Frames = FMath::Max(1, Frames);
+
+	int32 Failures = 0;
+	if (bSave)
+	{
+		for (const FCombatBenchLevelParams& Variant : Variants)
+		{
+			Failures += SaveLevel(Variant, PackageRoot) ? 0 : 1;
+		}
+	}
+
+	if (bProfile)
+	{
+		UE_LOG(LogTemp, Display, TEXT("%-48s %6s %6s %7s | %8s %8s %8s | %8s %8s"),
+			TEXT("Level"), TEXT("Walls"), TEXT("Cover"), TEXT("Enemies"), TEXT("p50 ms"), TEXT("p95 ms"), TEXT("max ms"), TEXT("traces"), TEXT("wallruns"));
+
+		FString Report = TEXT("Level,Walls,Cover,Enemies,P50Ms,P95Ms,MaxMs,TracesPerFrame,WallRuns\n");
+		for (const FCombatBenchLevelParams& Variant : Variants)
+		{
+			const FProfilePoint Point = ProfileLevel(Variant, Frames);
+
+			UE_LOG(LogTemp, Display, TEXT("%-48s %6d %6d %7d | %8.3f %8.3f %8.3f | %8.2f %8d"),
+				*Point.LevelName, Point.Walls, Point.Cover, Point.Enemies, Point.P50Ms, Point.P95Ms, Point.MaxMs, Point.Traces, Point.WallRuns);
+
+			Report += FString::Printf(TEXT("%s,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%d\n"),
+				*Point.LevelName, Point.Walls, Point.Cover, Point.Enemies, Point.P50Ms, Point.P95Ms, Point.MaxMs, Point.Traces, Point.WallRuns);
+		}
+
+		const FString ReportName = SweepName.IsEmpty() ? BaseParams.GetLevelName() : FString::Printf(TEXT("Sweep_%s"), *SweepName);
+		const FString ReportPath = FPaths::ProfilingDir() / TEXT("CombatBenchLevel") / FString::Printf(TEXT("%s_%s.csv"), *ReportName, *FDateTime::Now().ToString());
+		FFileHelper::SaveStringToFile(Report, *ReportPath);
+		UE_LOG(LogTemp, Display, TEXT("Benchmark level profile written to %s"), *ReportPath);
+	}
+
+	return Failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatBenchLevelCommandlet.generated.h"
+
+/**
+ * Generates reproducible benchmark levels from a seed and layout parameters, instead of
+ * comparing numbers across hand-made test maps:
+ *
+ *   UnrealEditor-Cmd <Project> -run=CombatBenchLevel -unattended
+ *     [-seed=1] [-walls=100] [-layout=Grid|Corridors|Scatter] [-enemies=50] [-mix=1,1,1]
+ *     [-placement=Ring|Scatter|Clusters] [-cover=0.1] [-arena=5000] [-tier1..3=<class path>]
+ *     [-sweep=<walls|enemies|cover|arena|seed>:v1,v2,...] [-save[=/Game/Benchmark]] [-profile] [-frames=600]
+ *
+ * -save (the default) writes one map per sweep value, named after its parameters, to play
+ * with the CSV capture or the autoplay soak. -profile plays every variant in a headless world
+ * instead: enemies shoot at a player that is launched along walls to wall run, and frame
+ * time, traces and wall runs per variant are logged and written to Saved/Profiling/CombatBenchLevel
+ * as a scaling curve.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatBenchLevelCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatBenchLevelCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,585 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Console benchmarks for combat hot paths. Run them from a PIE or packaged session:
+//   Combat.Bench.WeaponSwitch [RoundTrips]
+//   Combat.Bench.Snapshot [EnemyCount...]
+//   Combat.Bench.EventBus [EventsPerFrame] [Frames]
+//   Combat.Bench.WallRun [Walls] [Probes]
+//   Combat.Bench.Math [Count] [Iterations]
+
+#include "CombatBenchmarks.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "PlayerCharacterController.h"
+#include "WeaponManagerComponent.h"
+#include "EnemyBase.h"
+#include "CombatActorRegistry.h"
+#include "CombatSnapshotSubsystem.h"
+#include "CombatHeadlessWorld.h"
+#include "UObject/StrongObjectPtr.h"
+#include "WallRunSurfaceIndex.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Math/RandomStream.h"
+#include "CombatMath.h"
+#include "Misc/AutomationTest.h"
+
+namespace CombatBenchmarks
+{
+	static UWeaponManagerComponent* FindPlayerWeaponManager(UWorld* World)
+	{
+		APlayerCharacterController* Player = Cast<APlayerCharacterController>(UGameplayStatics::GetPlayerPawn(World, 0));
+		return Player ? Player->WeaponManager : nullptr;
+	}
+
+	static int32 ParseCount(const TArray<FString>& Args, int32 Index, int32 Default)
+	{
+		return Args.IsValidIndex(Index) ? FMath::Max(1, FCString::Atoi(*Args[Index])) : Default;
+	}
+
+	static void BenchWeaponSwitch(const TArray<FString>& Args, UWorld* World)
+	{
+		UWeaponManagerComponent* WeaponManager = FindPlayerWeaponManager(World);
+		if (!WeaponManager || WeaponManager->IsWeaponHolstered() || WeaponManager->CurrentSlot == EWeaponSlot::None)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Combat.Bench.WeaponSwitch needs a player with an equipped weapon."));
+			return;
+		}
+
+		const int32 RoundTrips = ParseCount(Args, 0, 10000);
+		const EWeaponSlot HomeSlot = WeaponManager->CurrentSlot;
+
+		EWeaponSlot OtherSlot = EWeaponSlot::None;
+		for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
+		{
+			const EWeaponSlot Slot = static_cast<EWeaponSlot>(SlotIndex);
+			if (Slot != HomeSlot && WeaponManager->GetSlotState(Slot).SpawnedWeapon)
+			{
+				OtherSlot = Slot;
+				break;
+			}
+		}
+
+		if (OtherSlot == EWeaponSlot::None)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Combat.Bench.WeaponSwitch needs at least two spawned weapons."));
+			return;
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < RoundTrips; ++Index)
+		{
+			WeaponManager->EquipWeapon(OtherSlot);
+			WeaponManager->EquipWeapon(HomeSlot);
+		}
+		const double EquipSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < RoundTrips; ++Index)
+		{
+			WeaponManager->ToggleHolsterWeapon();
+			WeaponManager->ToggleHolsterWeapon();
+		}
+		const double HolsterSeconds = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Display, TEXT("EquipWeapon round-trip: %.3f us (%d iterations)"), EquipSeconds * 1e6 / RoundTrips, RoundTrips);
+		UE_LOG(LogTemp, Display, TEXT("ToggleHolsterWeapon round-trip: %.3f us (%d iterations)"), HolsterSeconds * 1e6 / RoundTrips, RoundTrips);
+	}
+
+	// Runs in its own headless world, so the session it's called from keeps its enemies, player health and ammo
+	static void BenchSnapshotAt(int32 EnemyCount)
+	{
+		FCombatHeadlessWorld HeadlessWorld;
+		UWorld* World = HeadlessWorld.GetWorld();
+
+		UCombatActorRegistry* Registry = UCombatActorRegistry::Get(World);
+		UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(World);
+		if (!Registry || !Snapshots) return;
+
+		// The world is never ticked, so bare enemies just sit on their grid
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(EnemyCount)));
+		TArray<AEnemyBase*> BenchEnemies;
+		BenchEnemies.Reserve(EnemyCount);
+		for (int32 Index = 0; Index < EnemyCount; ++Index)
+		{
+			const FVector Location((Index % GridSize) * 200.0f, (Index / GridSize) * 200.0f, 0.0f);
+			if (AEnemyBase* Enemy = World->SpawnActor<AEnemyBase>(AEnemyBase::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams))
+			{
+				BenchEnemies.Add(Enemy);
+			}
+		}
+
+		FCombatSnapshot Snapshot;
+		double StartTime = FPlatformTime::Seconds();
+		Snapshots->CaptureSnapshot(Snapshot);
+		const double CaptureSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Destroy half so the restore has to respawn them, and damage the rest so it has to reset them
+		for (int32 Index = 0; Index < BenchEnemies.Num(); ++Index)
+		{
+			if (Index % 2 == 0)
+			{
+				BenchEnemies[Index]->Destroy();
+			}
+			else
+			{
+				BenchEnemies[Index]->CurrentHealthPool = 1.0f;
+				BenchEnemies[Index]->AddActorWorldOffset(FVector(0.0f, 0.0f, 50.0f));
+			}
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		const bool bRestored = Snapshots->RestoreSnapshot(Snapshot);
+		const double RestoreSeconds = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Display, TEXT("Snapshot with %d enemies: %d bytes, capture %.3f ms, restore %.3f ms (%s, %d/%d enemies back)."),
+			EnemyCount, Snapshot.Data.Num(), CaptureSeconds * 1000.0, RestoreSeconds * 1000.0,
+			bRestored ? TEXT("ok") : TEXT("failed"), Registry->GetEnemies().Num(), BenchEnemies.Num());
+	}
+
+	static void BenchSnapshot(const TArray<FString>& Args)
+	{
+		TArray<int32> EnemyCounts;
+		for (int32 Index = 0; Index < Args.Num(); ++Index)
+		{
+			EnemyCounts.Add(ParseCount(Args, Index, 100));
+		}
+
+		if (EnemyCounts.Num() == 0)
+		{
+			EnemyCounts = { 100, 1000 };
+		}
+
+		for (int32 EnemyCount : EnemyCounts)
+		{
+			BenchSnapshotAt(EnemyCount);
+		}
+	}
+
+	static void BenchEventBus(const TArray<FString>& Args)
+	{
+		const int32 EventsPerFrame = ParseCount(Args, 0, 10000);
+		const int32 Frames = ParseCount(Args, 1, 100);
+
+		TStrongObjectPtr<UCombatBenchEventSink> Sink(NewObject<UCombatBenchEventSink>());
+
+		// Every path carries the same event to a subscriber that does the same work with it
+		const FCombatShotFiredEvent Event{ nullptr, TEXT("BenchRifle"), 1, 0.0 };
+
+		// Dynamic delegate: one reflected call per event, dispatched as the event happens
+		FOnCombatBenchShotFired DynamicDelegate;
+		DynamicDelegate.AddDynamic(Sink.Get(), &UCombatBenchEventSink::OnShotFired);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			for (int32 Index = 0; Index < EventsPerFrame; ++Index)
+			{
+				DynamicDelegate.Broadcast(Event.Shooter.Get(), Event.WeaponName, Event.ShotCount, Event.Time);
+			}
+		}
+		const double DynamicSeconds = FPlatformTime::Seconds() - StartTime;
+		const int64 DynamicShots = Sink->ShotsReceived;
+
+		// Native delegate: one direct call per event, separates the cost of reflection from the cost of batching
+		Sink->ShotsReceived = 0;
+		TMulticastDelegate<void(const FCombatShotFiredEvent&)> NativeDelegate;
+		NativeDelegate.AddUObject(Sink.Get(), &UCombatBenchEventSink::OnShotEvent);
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			for (int32 Index = 0; Index < EventsPerFrame; ++Index)
+			{
+				NativeDelegate.Broadcast(Event);
+			}
+		}
+		const double NativeSeconds = FPlatformTime::Seconds() - StartTime;
+		const int64 NativeShots = Sink->ShotsReceived;
+
+		// Event bus channel: events are queued and handed to the subscriber once per frame
+		Sink->ShotsReceived = 0;
+		TCombatEventChannel<FCombatShotFiredEvent> Channel;
+		Channel.Reserve(EventsPerFrame);
+		Channel.OnEvents.AddUObject(Sink.Get(), &UCombatBenchEventSink::OnShotBatch);
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			for (int32 Index = 0; Index < EventsPerFrame; ++Index)
+			{
+				Channel.Publish(Event);
+			}
+			Channel.Dispatch();
+		}
+		const double BusSeconds = FPlatformTime::Seconds() - StartTime;
+		const int64 BusShots = Sink->ShotsReceived;
+
+		const double DynamicMsPerFrame = DynamicSeconds * 1000.0 / Frames;
+		const double NativeMsPerFrame = NativeSeconds * 1000.0 / Frames;
+		const double BusMsPerFrame = BusSeconds * 1000.0 / Frames;
+
+		UE_LOG(LogTemp, Display, TEXT("%d events/frame over %d frames, speedup against the dynamic delegate:"), EventsPerFrame, Frames);
+		UE_LOG(LogTemp, Display, TEXT("  Dynamic multicast delegate: %.3f ms/frame (%lld events received)"), DynamicMsPerFrame, DynamicShots);
+		UE_LOG(LogTemp, Display, TEXT("  Native multicast delegate: %.3f ms/frame (%lld events received, %.1fx)"), NativeMsPerFrame, NativeShots, NativeMsPerFrame > 0.0 ? DynamicMsPerFrame / NativeMsPerFrame : 0.0);
+		UE_LOG(LogTemp, Display, TEXT("  Combat event bus channel: %.3f ms/frame (%lld events received, %.1fx)"), BusMsPerFrame, BusShots, BusMsPerFrame > 0.0 ? DynamicMsPerFrame / BusMsPerFrame : 0.0);
+	}
+
+	static void BenchWallRun(const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 WallCount = ParseCount(Args, 0, 1000);
+		const int32 ProbeCount = ParseCount(Args, 1, 10000);
+
+		UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (!World || !CubeMesh)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Combat.Bench.WallRun needs a game world and the engine cube mesh."));
+			return;
+		}
+
+		// A field of 400 x 20 x 300 walls in rows 300 apart, far below the level
+		const FVector FieldOrigin(0.0f, 0.0f, -200000.0f);
+		const int32 WallsPerRow = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(WallCount)));
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		TArray<AActor*> SpawnedActors;
+		SpawnedActors.Reserve(WallCount + 1);
+		for (int32 Index = 0; Index < WallCount; ++Index)
+		{
+			const FVector Location = FieldOrigin + FVector((Index % WallsPerRow) * 500.0f, (Index / WallsPerRow) * 300.0f, 0.0f);
+			AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator, SpawnParams);
+			if (!Wall) continue;
+
+			Wall->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+			Wall->GetStaticMeshComponent()->SetStaticMesh(CubeMesh);
+			Wall->SetActorScale3D(FVector(4.0f, 0.2f, 3.0f));
+			Wall->Tags.Add(FName("Wall"));
+			SpawnedActors.Add(Wall);
+		}
+
+		// Spawned after the walls so its runtime bake picks them up
+		AWallRunSurfaceIndex* WallRunIndex = World->SpawnActor<AWallRunSurfaceIndex>(SpawnParams);
+		SpawnedActors.Add(WallRunIndex);
+
+		const float DetectionDistance = 100.0f;
+		const FVector FieldSize(WallsPerRow * 500.0f, FMath::DivideAndRoundUp(WallCount, WallsPerRow) * 300.0f, 0.0f);
+
+		// Same probe points for both paths: random spots in the field at wall height, random facing
+		FRandomStream Random(1337);
+		TArray<TPair<FVector, FVector>> Probes;
+		Probes.Reserve(ProbeCount);
+		for (int32 Index = 0; Index < ProbeCount; ++Index)
+		{
+			const FVector Location = FieldOrigin + FVector(Random.FRandRange(0.0f, FieldSize.X), Random.FRandRange(0.0f, FieldSize.Y), 0.0f);
+			const FVector RightVector = FRotator(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f).RotateVector(FVector::RightVector);
+			Probes.Emplace(Location, RightVector);
+		}
+
+		FCollisionQueryParams Params;
+		int32 TraceWalls = 0;
+		int32 IndexWalls = 0;
+
+		double StartTime = FPlatformTime::Seconds();
+		for (const TPair<FVector, FVector>& Probe : Probes)
+		{
+			FHitResult RightHit, LeftHit;
+			const bool bRight = World->LineTraceSingleByChannel(RightHit, Probe.Key, Probe.Key + Probe.Value * DetectionDistance, ECC_Visibility, Params);
+			const bool bLeft = World->LineTraceSingleByChannel(LeftHit, Probe.Key, Probe.Key - Probe.Value * DetectionDistance, ECC_Visibility, Params);
+
+			if ((bRight && RightHit.GetActor() && RightHit.GetActor()->ActorHasTag(FName("Wall"))) || (bLeft && LeftHit.GetActor() && LeftHit.GetActor()->ActorHasTag(FName("Wall"))))
+			{
+				TraceWalls++;
+			}
+		}
+		const double TraceSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (const TPair<FVector, FVector>& Probe : Probes)
+		{
+			const FWallRunSurface* RightSurface = nullptr;
+			const FWallRunSurface* LeftSurface = nullptr;
+			if (!WallRunIndex->FindSurfaces(Probe.Key, Probe.Value, DetectionDistance, RightSurface, LeftSurface)) continue;
+
+			// Same order as the player: the left wall is only confirmed when the right one isn't
+			for (const bool bIsRightWall : { true, false })
+			{
+				if (!(bIsRightWall ? RightSurface : LeftSurface)) continue;
+
+				FHitResult WallHit;
+				const FVector ProbeEnd = Probe.Key + Probe.Value * (bIsRightWall ? DetectionDistance : -DetectionDistance);
+				if (World->LineTraceSingleByChannel(WallHit, Probe.Key, ProbeEnd, ECC_Visibility, Params) && WallHit.GetActor() && WallHit.GetActor()->ActorHasTag(FName("Wall")))
+				{
+					IndexWalls++;
+					break;
+				}
+			}
+		}
+		const double IndexSeconds = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Display, TEXT("Wall-run check with %d walls, %d airborne probes (%d surfaces baked):"), WallCount, ProbeCount, WallRunIndex->Surfaces.Num());
+		UE_LOG(LogTemp, Display, TEXT("  Side traces: %.3f us/frame, %d walls found"), TraceSeconds * 1e6 / ProbeCount, TraceWalls);
+		UE_LOG(LogTemp, Display, TEXT("  Surface index + confirm trace: %.3f us/frame, %d walls found"), IndexSeconds * 1e6 / ProbeCount, IndexWalls);
+
+		for (AActor* Actor : SpawnedActors)
+		{
+			Actor->Destroy();
+		}
+	}
+
+	// Every scalar rule against its batch kernel over an exhaustive grid of inputs, returns the mismatch count
+	static int32 VerifyCombatMath()
+	{
+		int32 Mismatches = 0;
+
+		// Damage: every combination of pool and hit values, including empty pools, overkill and negative hits
+		{
+			const float Values[] = { -25.0f, -0.0f, 0.0f, 0.25f, 1.0f, 10.0f, 49.5f, 50.0f, 99.9f, 100.0f, 150.0f, 1.0e6f };
+			const float MaxValues[] = { 0.0f, 1.0f, 50.0f, 100.0f, 1.0e6f };
+
+			TArray<float> Shields, Healths, MaxHealths, Amounts;
+			for (float Shield : Values)
+			{
+				for (float Health : Values)
+				{
+					for (float MaxHealth : MaxValues)
+					{
+						for (float Amount : Values)
+						{
+							Shields.Add(Shield);
+							Healths.Add(Health);
+							MaxHealths.Add(MaxHealth);
+							Amounts.Add(Amount);
+						}
+					}
+				}
+			}
+
+			const int32 Num = Shields.Num();
+			TArray<float> VectorShields = Shields, VectorHealths = Healths;
+			TArray<bool> ScalarBroken, VectorBroken;
+			ScalarBroken.SetNumZeroed(Num);
+			VectorBroken.SetNumZeroed(Num);
+
+			CombatMath::ApplyDamageBatchScalar(Shields.GetData(), Healths.GetData(), MaxHealths.GetData(), Amounts.GetData(), Num, ScalarBroken.GetData());
+			CombatMath::ApplyDamageBatch(VectorShields.GetData(), VectorHealths.GetData(), MaxHealths.GetData(), Amounts.GetData(), Num, VectorBroken.GetData());
+
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				if (Shields[Index] != VectorShields[Index] || Healths[Index] != VectorHealths[Index] || ScalarBroken[Index] != VectorBroken[Index])
+				{
+					Mismatches++;
+				}
+			}
+		}
+
+		// Regen: pools on both sides of empty and full, with and without the delay elapsed
+		{
+			const float PoolValues[] = { -1.0f, 0.0f, 0.5f, 50.0f, 99.0f, 99.99f, 100.0f, 120.0f };
+			const float RateValues[] = { -5.0f, 0.0f, 1.0f, 25.0f, 1000.0f };
+			const float SinceValues[] = { 0.0f, 1.99f, 2.0f, 10.0f };
+			const float DelayValues[] = { 0.0f, 2.0f };
+
+			TArray<float> Pools, MaxPools, Rates, Since, Delays;
+			for (float Pool : PoolValues)
+			{
+				for (float Rate : RateValues)
+				{
+					for (float TimeSinceDamage : SinceValues)
+					{
+						for (float Delay : DelayValues)
+						{
+							Pools.Add(Pool);
+							MaxPools.Add(100.0f);
+							Rates.Add(Rate);
+							Since.Add(TimeSinceDamage);
+							Delays.Add(Delay);
+						}
+					}
+				}
+			}
+
+			const int32 Num = Pools.Num();
+			TArray<float> VectorPools = Pools;
+			CombatMath::RegenPoolsBatchScalar(Pools.GetData(), MaxPools.GetData(), Rates.GetData(), Since.GetData(), Delays.GetData(), 1.0f / 60.0f, Num);
+			CombatMath::RegenPoolsBatch(VectorPools.GetData(), MaxPools.GetData(), Rates.GetData(), Since.GetData(), Delays.GetData(), 1.0f / 60.0f, Num);
+
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				if (!FMath::IsNearlyEqual(Pools[Index], VectorPools[Index], 1.0e-4f * FMath::Max(1.0f, FMath::Abs(Pools[Index]))))
+				{
+					Mismatches++;
+				}
+			}
+		}
+
+		// Reload: every loadout up to 64-round magazines, 8 spares and two magazines of temp ammo
+		{
+			TArray<int32> Current, Mags, Temp, PerMag;
+			for (int32 AmmoPerMag = 0; AmmoPerMag <= 64; ++AmmoPerMag)
+			{
+				for (int32 CurrentAmmo = 0; CurrentAmmo <= AmmoPerMag; ++CurrentAmmo)
+				{
+					for (int32 Magazines = 0; Magazines <= 8; ++Magazines)
+					{
+						for (int32 TempAmmo = 0; TempAmmo <= 2 * AmmoPerMag; ++TempAmmo)
+						{
+							Current.Add(CurrentAmmo);
+							Mags.Add(Magazines);
+							Temp.Add(TempAmmo);
+							PerMag.Add(AmmoPerMag);
+						}
+					}
+				}
+			}
+
+			const int32 Num = Current.Num();
+			TArray<int32> VectorCurrent = Current, VectorMags = Mags, VectorTemp = Temp;
+			const TArray<int32> StartCurrent = Current, StartMags = Mags, StartTemp = Temp;
+			TArray<bool> ScalarReloaded, VectorReloaded;
+			ScalarReloaded.SetNumZeroed(Num);
+			VectorReloaded.SetNumZeroed(Num);
+
+			CombatMath::ResolveReloadBatchScalar(Current.GetData(), Mags.GetData(), Temp.GetData(), PerMag.GetData(), Num, ScalarReloaded.GetData());
+			CombatMath::ResolveReloadBatch(VectorCurrent.GetData(), VectorMags.GetData(), VectorTemp.GetData(), PerMag.GetData(), Num, VectorReloaded.GetData());
+
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				if (Current[Index] != VectorCurrent[Index] || Mags[Index] != VectorMags[Index] || Temp[Index] != VectorTemp[Index] || ScalarReloaded[Index] != VectorReloaded[Index])
+				{
+					Mismatches++;
+				}
+
+				// A magazine reload only moves rounds around and a temp reload drops the old magazine's rounds: none created, never more than a magazine loaded
+				const bool bTempReload = ScalarReloaded[Index] && StartMags[Index] <= 0;
+				const int32 Before = StartCurrent[Index] + StartMags[Index] * PerMag[Index] + StartTemp[Index] - (bTempReload ? StartCurrent[Index] : 0);
+				const int32 After = Current[Index] + Mags[Index] * PerMag[Index] + Temp[Index];
+				if (Before != After || Current[Index] > PerMag[Index])
+				{
+					Mismatches++;
+				}
+			}
+		}
+
+		return Mismatches;
+	}
+
+	static void BenchMath(const TArray<FString>& Args)
+	{
+		const int32 Count = ParseCount(Args, 0, 4096);
+		const int32 Iterations = ParseCount(Args, 1, 1000);
+
+		const int32 Mismatches = VerifyCombatMath();
+		if (Mismatches > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Combat math self-check failed: %d mismatches between the scalar rules and the batch kernels."), Mismatches);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("Combat math self-check passed."));
+		}
+
+		FRandomStream Random(1337);
+
+		TArray<float> Shields, Healths, MaxHealths, Amounts, Rates, Since, Delays;
+		TArray<int32> Current, Mags, Temp, PerMag;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Shields.Add(Random.FRandRange(0.0f, 100.0f));
+			Healths.Add(Random.FRandRange(0.0f, 100.0f));
+			MaxHealths.Add(100.0f);
+			Amounts.Add(Random.FRandRange(0.0f, 40.0f));
+			Rates.Add(25.0f);
+			Since.Add(Random.FRandRange(0.0f, 4.0f));
+			Delays.Add(2.0f);
+
+			const int32 AmmoPerMag = Random.RandRange(6, 60);
+			PerMag.Add(AmmoPerMag);
+			Current.Add(Random.RandRange(0, AmmoPerMag - 1));
+			Mags.Add(Random.RandRange(0, 6));
+			Temp.Add(Random.RandRange(0, AmmoPerMag));
+		}
+
+		// Each iteration starts from the same inputs, so both paths do the same work
+		auto Time = [Iterations](TFunctionRef<void()> Reset, TFunctionRef<void()> Kernel)
+		{
+			double Seconds = 0.0;
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Reset();
+				const double StartTime = FPlatformTime::Seconds();
+				Kernel();
+				Seconds += FPlatformTime::Seconds() - StartTime;
+			}
+			return Seconds;
+		};
+
+		TArray<float> WorkShields, WorkHealths, WorkPools;
+		TArray<int32> WorkCurrent, WorkMags, WorkTemp;
+		auto ResetPools = [&]() { WorkShields = Shields; WorkHealths = Healths; WorkPools = Healths; };
+		auto ResetAmmo = [&]() { WorkCurrent = Current; WorkMags = Mags; WorkTemp = Temp; };
+
+		const double DamageScalar = Time(ResetPools, [&]() { CombatMath::ApplyDamageBatchScalar(WorkShields.GetData(), WorkHealths.GetData(), MaxHealths.GetData(), Amounts.GetData(), Count); });
+		const double DamageVector = Time(ResetPools, [&]() { CombatMath::ApplyDamageBatch(WorkShields.GetData(), WorkHealths.GetData(), MaxHealths.GetData(), Amounts.GetData(), Count); });
+		const double RegenScalar = Time(ResetPools, [&]() { CombatMath::RegenPoolsBatchScalar(WorkPools.GetData(), MaxHealths.GetData(), Rates.GetData(), Since.GetData(), Delays.GetData(), 1.0f / 60.0f, Count); });
+		const double RegenVector = Time(ResetPools, [&]() { CombatMath::RegenPoolsBatch(WorkPools.GetData(), MaxHealths.GetData(), Rates.GetData(), Since.GetData(), Delays.GetData(), 1.0f / 60.0f, Count); });
+		const double ReloadScalar = Time(ResetAmmo, [&]() { CombatMath::ResolveReloadBatchScalar(WorkCurrent.GetData(), WorkMags.GetData(), WorkTemp.GetData(), PerMag.GetData(), Count); });
+		const double ReloadVector = Time(ResetAmmo, [&]() { CombatMath::ResolveReloadBatch(WorkCurrent.GetData(), WorkMags.GetData(), WorkTemp.GetData(), PerMag.GetData(), Count); });
+
+		const double NsPerElement = 1.0e9 / (double(Count) * Iterations);
+		auto Report = [NsPerElement](const TCHAR* Name, double Scalar, double Vector)
+		{
+			UE_LOG(LogTemp, Display, TEXT("  %-8s scalar %.3f ns, vector %.3f ns per element (%.1fx)"), Name, Scalar * NsPerElement, Vector * NsPerElement, Vector > 0.0 ? Scalar / Vector : 0.0);
+		};
+
+		UE_LOG(LogTemp, Display, TEXT("Combat math kernels, %d elements x %d iterations:"), Count, Iterations);
+		Report(TEXT("Damage"), DamageScalar, DamageVector);
+		Report(TEXT("Regen"), RegenScalar, RegenVector);
+		Report(TEXT("Reload"), ReloadScalar, ReloadVector);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchWeaponSwitchCommand(
+		TEXT("Combat.Bench.WeaponSwitch"),
+		TEXT("Times EquipWeapon and ToggleHolsterWeapon round-trips on the local player. Args: [RoundTrips]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchWeaponSwitch));
+
+	static FAutoConsoleCommandWithArgs BenchSnapshotCommand(
+		TEXT("Combat.Bench.Snapshot"),
+		TEXT("Spawns enemies in a headless world, then times a combat snapshot capture and an in-place restore. Args: [EnemyCount...], default 100 1000"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchSnapshot));
+
+	static FAutoConsoleCommandWithArgs BenchEventBusCommand(
+		TEXT("Combat.Bench.EventBus"),
+		TEXT("Compares dynamic and native multicast delegates with a combat event bus channel, all delivering the same event. Args: [EventsPerFrame] [Frames], default 10000 100"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchEventBus));
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchWallRunCommand(
+		TEXT("Combat.Bench.WallRun"),
+		TEXT("Spawns a field of walls and compares side traces with the wall-run surface index per airborne frame. Args: [Walls] [Probes], default 1000 10000"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchWallRun));
+
+	static FAutoConsoleCommandWithArgs BenchMathCommand(
+		TEXT("Combat.Bench.Math"),
+		TEXT("Checks the combat math batch kernels against the scalar rules, then times both. Args: [Count] [Iterations], default 4096 1000"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchMath));
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// The scalar rules themselves are pinned in CombatMathTests.cpp
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatMathBatchKernelsTest, "CombatSystem.Math.BatchKernels",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatMathBatchKernelsTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Batch kernels disagreeing with the scalar rules, or reloads creating rounds"), CombatBenchmarks::VerifyCombatMath(), 0);
+	return true;
+}
+
+#endif
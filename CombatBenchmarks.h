@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "CombatEventBus.h"
+#include "CombatBenchmarks.generated.h"
+
+class AActor;
+
+// Same payload as FCombatShotFiredEvent, so every path moves the same data
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnCombatBenchShotFired, AActor*, Shooter, FName, WeaponName, int32, ShotCount, double, Time);
+
+// Receives benchmark events through a dynamic delegate, a native delegate and an event bus channel, doing the same work for each
+UCLASS(Transient)
+class UCombatBenchEventSink : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	int64 ShotsReceived = 0;
+
+	UFUNCTION()
+	void OnShotFired(AActor* Shooter, FName WeaponName, int32 ShotCount, double Time) { ShotsReceived += ShotCount; }
+
+	void OnShotEvent(const FCombatShotFiredEvent& Event) { ShotsReceived += Event.ShotCount; }
+
+	void OnShotBatch(TConstArrayView<FCombatShotFiredEvent> Events)
+	{
+		for (const FCombatShotFiredEvent& Event : Events)
+		{
+			ShotsReceived += Event.ShotCount;
+		}
+	}
+};
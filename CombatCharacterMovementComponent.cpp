@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatCharacterMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+#include "CombatStats.h"
+
+void UCombatCharacterMovementComponent::RequestWallRun(bool bRightSide)
+{
+	bWantsToWallRun = true;
+	bWallRunRight = bRightSide;
+}
+
+void UCombatCharacterMovementComponent::RequestWallJump()
+{
+	bWantsToWallJump = true;
+}
+
+float UCombatCharacterMovementComponent::GetMaxSpeed() const
+{
+	return IsWallRunning() ? WallRunSpeed : Super::GetMaxSpeed();
+}
+
+void UCombatCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToWallRun = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	bWallRunRight = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+	bWantsToWallJump = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
+}
+
+FNetworkPredictionData_Client* UCombatCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (!ClientPredictionData)
+	{
+		UCombatCharacterMovementComponent* MutableThis = const_cast<UCombatCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_CombatCharacter(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void UCombatCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	WallRunCooldownRemaining = FMath::Max(0.0f, WallRunCooldownRemaining - DeltaSeconds);
+
+	// Requests are consumed by the move that carries them, on the client, the server and in replays alike
+	if (IsWallRunning())
+	{
+		if (bWantsToWallJump)
+		{
+			const FVector JumpDirection = (WallRunNormal + FVector::UpVector).GetSafeNormal();
+			SetMovementMode(MOVE_Falling);
+			Velocity = JumpDirection * WallJumpSpeed;
+		}
+	}
+	else if (bWantsToWallRun && CanStartWallRun())
+	{
+		FHitResult WallHit;
+		if (FindWall(bWallRunRight, WallHit))
+		{
+			EnterWallRun(WallHit);
+		}
+	}
+
+	bWantsToWallRun = false;
+	bWantsToWallJump = false;
+}
+
+void UCombatCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	// However the wall run ended, by time, jump, landing or losing the wall, the cooldown starts
+	if (PreviousMovementMode == MOVE_Custom && PreviousCustomMode == CMOVE_WallRun && !IsWallRunning())
+	{
+		WallRunCooldownRemaining = WallRunCooldownDuration;
+	}
+}
+
+void UCombatCharacterMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == CMOVE_WallRun)
+	{
+		PhysWallRun(deltaTime, Iterations);
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+bool UCombatCharacterMovementComponent::FindWall(bool bRightSide, FHitResult& OutWallHit) const
+{
+	if (!CharacterOwner) return false;
+
+	const FVector Start = UpdatedComponent->GetComponentLocation();
+	const FVector Side = CharacterOwner->GetActorRightVector() * (bRightSide ? 1.0f : -1.0f);
+
+	FCollisionQueryParams Params;
+	Params.AddIgnoredActor(CharacterOwner);
+
+	COMBAT_COUNT(Traces, 1);
+	if (!GetWorld()->LineTraceSingleByChannel(OutWallHit, Start, Start + Side * WallDetectionDistance, ECC_Visibility, Params))
+	{
+		return false;
+	}
+
+	const AActor* WallActor = OutWallHit.GetActor();
+	return WallActor && WallActor->ActorHasTag(WallTag);
+}
+
+void UCombatCharacterMovementComponent::EnterWallRun(const FHitResult& WallHit)
+{
+	WallRunNormal = WallHit.ImpactNormal;
+	WallRunTimeRemaining = WallRunDuration;
+
+	SetMovementMode(MOVE_Custom, CMOVE_WallRun);
+
+	// Run along the wall in the direction the character faces, with a small upward kick
+	FVector RunDirection = FVector::VectorPlaneProject(CharacterOwner->GetActorForwardVector(), WallRunNormal).GetSafeNormal2D();
+	Velocity = (RunDirection + FVector::UpVector * WallRunUpwardBias) * WallRunSpeed;
+}
+
+void UCombatCharacterMovementComponent::PhysWallRun(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME) return;
+
+	WallRunTimeRemaining -= deltaTime;
+
+	FHitResult WallHit;
+	if (WallRunTimeRemaining <= 0.0f || !FindWall(bWallRunRight, WallHit))
+	{
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	WallRunNormal = WallHit.ImpactNormal;
+
+	// Keep full speed along the wall; only scaled gravity acts vertically
+	FVector AlongWall = FVector::VectorPlaneProject(Velocity, WallRunNormal).GetSafeNormal2D();
+	if (AlongWall.IsNearlyZero())
+	{
+		AlongWall = FVector::VectorPlaneProject(CharacterOwner->GetActorForwardVector(), WallRunNormal).GetSafeNormal2D();
+	}
+
+	Velocity.X = AlongWall.X * WallRunSpeed;
+	Velocity.Y = AlongWall.Y * WallRunSpeed;
+	Velocity.Z += GetGravityZ() * WallRunGravityScale * deltaTime;
+
+	Iterations++;
+	bJustTeleported = false;
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const FVector Delta = Velocity * deltaTime;
+
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+
+	if (Hit.Time < 1.f)
+	{
+		if (IsValidLandingSpot(UpdatedComponent->GetComponentLocation(), Hit))
+		{
+			ProcessLanded(Hit, deltaTime * (1.f - Hit.Time), Iterations);
+			return;
+		}
+
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+	}
+
+	if (!bJustTeleported && !HasAnimRootMotion())
+	{
+		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / deltaTime;
+	}
+}
+
+void FSavedMove_CombatCharacter::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToWallRun = false;
+	bSavedWallRunRight = false;
+	bSavedWantsToWallJump = false;
+	SavedWallRunTimeRemaining = 0.0f;
+	SavedWallRunCooldownRemaining = 0.0f;
+}
+
+uint8 FSavedMove_CombatCharacter::GetCompressedFlags() const
+{
+	uint8 Flags = Super::GetCompressedFlags();
+
+	if (bSavedWantsToWallRun)
+	{
+		Flags |= FLAG_Custom_0;
+	}
+
+	if (bSavedWallRunRight)
+	{
+		Flags |= FLAG_Custom_1;
+	}
+
+	if (bSavedWantsToWallJump)
+	{
+		Flags |= FLAG_Custom_2;
+	}
+
+	return Flags;
+}
+
+bool FSavedMove_CombatCharacter::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_CombatCharacter* NewCombatMove = static_cast<const FSavedMove_CombatCharacter*>(NewMove.Get());
+
+	if (bSavedWantsToWallRun != NewCombatMove->bSavedWantsToWallRun
+		|| bSavedWallRunRight != NewCombatMove->bSavedWallRunRight
+		|| bSavedWantsToWallJump != NewCombatMove->bSavedWantsToWallJump)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_CombatCharacter::SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+	if (const UCombatCharacterMovementComponent* Movement = Cast<UCombatCharacterMovementComponent>(Character->GetCharacterMovement()))
+	{
+		bSavedWantsToWallRun = Movement->bWantsToWallRun;
+		bSavedWallRunRight = Movement->bWallRunRight;
+		bSavedWantsToWallJump = Movement->bWantsToWallJump;
+		SavedWallRunTimeRemaining = Movement->WallRunTimeRemaining;
+		SavedWallRunCooldownRemaining = Movement->WallRunCooldownRemaining;
+	}
+}
+
+void FSavedMove_CombatCharacter::PrepMoveFor(ACharacter* Character)
+{
+	Super::PrepMoveFor(Character);
+
+	if (UCombatCharacterMovementComponent* Movement = Cast<UCombatCharacterMovementComponent>(Character->GetCharacterMovement()))
+	{
+		Movement->WallRunTimeRemaining = SavedWallRunTimeRemaining;
+		Movement->WallRunCooldownRemaining = SavedWallRunCooldownRemaining;
+	}
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_CombatCharacter::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_CombatCharacter());
+}
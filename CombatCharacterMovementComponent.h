@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "CombatCharacterMovementComponent.generated.h"
+
+UENUM(BlueprintType)
+enum ECombatMovementMode
+{
+	CMOVE_None UMETA(Hidden),
+	CMOVE_WallRun UMETA(DisplayName = "Wall Run")
+};
+
+/**
+ * Character movement with wall running as a custom movement mode. The character only
+ * requests a wall run or wall jump; the request travels with the saved move as a
+ * compressed flag, so the client predicts the wall run and the server replays the
+ * same simulation in PhysWallRun instead of correcting launched velocities.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_CombatCharacter;
+
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallRunSpeed = 900.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallRunDuration = 1.5f;
+
+	// Fraction of normal gravity applied while running along a wall
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallRunGravityScale = 0.2f;
+
+	// Upward part of the velocity a wall run starts with, relative to WallRunSpeed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallRunUpwardBias = 0.2f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallDetectionDistance = 100.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallRunCooldownDuration = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	float WallJumpSpeed = 800.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wall Running")
+	FName WallTag = FName("Wall");
+
+	// Starts a wall run against the wall on the given side on the next move, if one is still there
+	void RequestWallRun(bool bRightSide);
+
+	// Jumps off the wall on the next move while wall running
+	void RequestWallJump();
+
+	UFUNCTION(BlueprintPure, Category = "Wall Running")
+	bool IsWallRunning() const { return MovementMode == MOVE_Custom && CustomMovementMode == CMOVE_WallRun; }
+
+	bool IsWallRunningRight() const { return IsWallRunning() && bWallRunRight; }
+
+	bool CanStartWallRun() const { return IsFalling() && WallRunCooldownRemaining <= 0.0f; }
+
+	const FVector& GetWallRunNormal() const { return WallRunNormal; }
+
+	virtual float GetMaxSpeed() const override;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+private:
+
+	// Input intent, carried by the saved move's compressed flags
+	bool bWantsToWallRun = false;
+
+	bool bWallRunRight = false;
+
+	bool bWantsToWallJump = false;
+
+	FVector WallRunNormal = FVector::ZeroVector;
+
+	float WallRunTimeRemaining = 0.0f;
+
+	float WallRunCooldownRemaining = 0.0f;
+
+	void PhysWallRun(float deltaTime, int32 Iterations);
+
+	bool FindWall(bool bRightSide, FHitResult& OutWallHit) const;
+
+	void EnterWallRun(const FHitResult& WallHit);
+};
+
+class FSavedMove_CombatCharacter : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+
+	virtual uint8 GetCompressedFlags() const override;
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+
+	virtual void PrepMoveFor(ACharacter* Character) override;
+
+private:
+
+	bool bSavedWantsToWallRun = false;
+
+	bool bSavedWallRunRight = false;
+
+	bool bSavedWantsToWallJump = false;
+
+	// Wall-run timers at the start of the move, restored when the move is replayed after a correction
+	float SavedWallRunTimeRemaining = 0.0f;
+
+	float SavedWallRunCooldownRemaining = 0.0f;
+};
+
+class FNetworkPredictionData_Client_CombatCharacter : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_CombatCharacter(const UCharacterMovementComponent& ClientMovement) : Super(ClientMovement) {}
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatEventBus.h"
+#include "Engine/World.h"
+#include "CombatMemory.h"
+
+namespace CombatEventBus
+{
+	// Enough for a busy frame of automatic fire from a full level; the buffers grow if ever exceeded
+	static constexpr int32 InitialChannelCapacity = 256;
+}
+
+UCombatEventBus* UCombatEventBus::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatEventBus>() : nullptr;
+}
+
+bool UCombatEventBus::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatEventBus::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LLM_SCOPE_BYTAG(Combat_Systems);
+	VisitTupleElements([](auto& Channel) { Channel.Reserve(CombatEventBus::InitialChannelCapacity); }, Channels);
+}
+
+TStatId UCombatEventBus::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatEventBus, STATGROUP_Tickables);
+}
+
+void UCombatEventBus::Tick(float DeltaTime)
+{
+	DispatchEvents();
+}
+
+void UCombatEventBus::DispatchEvents()
+{
+	VisitTupleElements([](auto& Channel) { Channel.Dispatch(); }, Channels);
+}
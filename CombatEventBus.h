@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/Tuple.h"
+#include "CombatEventBus.generated.h"
+
+class AActor;
+class AEnemyBase;
+enum class EWeaponSlot : uint8;
+
+struct FCombatEnemyDiedEvent
+{
+	TWeakObjectPtr<AEnemyBase> Enemy;
+	FVector Location = FVector::ZeroVector;
+	double Time = 0.0;
+};
+
+struct FCombatShotFiredEvent
+{
+	TWeakObjectPtr<AActor> Shooter;
+	FName WeaponName;
+	int32 ShotCount = 1;
+	double Time = 0.0;
+};
+
+struct FCombatHitEvent
+{
+	TWeakObjectPtr<AActor> Instigator;
+	TWeakObjectPtr<AActor> Target;
+	FVector Location = FVector::ZeroVector;
+	float Damage = 0.0f;
+};
+
+struct FCombatReloadEvent
+{
+	TWeakObjectPtr<AActor> Owner;
+	FName WeaponName;
+	bool bStarted = true;
+};
+
+// Always published with both slots, the enum is only forward declared here
+struct FCombatWeaponSwitchedEvent
+{
+	TWeakObjectPtr<AActor> Owner;
+	EWeaponSlot FromSlot;
+	EWeaponSlot ToSlot;
+};
+
+// Queue and subscribers for one event type. Events are double-buffered and the buffers keep
+// their capacity, so once warmed up neither publishing nor dispatching allocates.
+template<typename EventType>
+class TCombatEventChannel
+{
+public:
+
+	using FOnEvents = TMulticastDelegate<void(TConstArrayView<EventType>)>;
+
+	// Receives every event published since the previous dispatch, in publish order
+	FOnEvents OnEvents;
+
+	void Reserve(int32 Capacity)
+	{
+		Pending.Reserve(Capacity);
+		Dispatching.Reserve(Capacity);
+	}
+
+	// Events nobody subscribes to are dropped instead of queued, subscribe before the first publish you need
+	void Publish(const EventType& Event)
+	{
+		if (OnEvents.IsBound())
+		{
+			Pending.Add(Event);
+		}
+	}
+
+	bool HasPending() const { return Pending.Num() > 0; }
+
+	void Dispatch()
+	{
+		if (Pending.Num() == 0) return;
+
+		// Events published by subscribers during the broadcast land in the other buffer and go out next dispatch
+		Swap(Pending, Dispatching);
+
+		if (OnEvents.IsBound())
+		{
+			OnEvents.Broadcast(Dispatching);
+		}
+
+		Dispatching.Reset();
+	}
+
+private:
+
+	TArray<EventType> Pending;
+
+	TArray<EventType> Dispatching;
+};
+
+// Every event type the bus carries. Publishing or subscribing to any other type fails to compile.
+using FCombatEventChannels = TTuple<
+	TCombatEventChannel<FCombatEnemyDiedEvent>,
+	TCombatEventChannel<FCombatShotFiredEvent>,
+	TCombatEventChannel<FCombatHitEvent>,
+	TCombatEventChannel<FCombatReloadEvent>,
+	TCombatEventChannel<FCombatWeaponSwitchedEvent>>;
+
+/**
+ * Typed native event bus for combat events. Publishers queue events during the frame and
+ * subscribers get them in one batch per event type when the bus ticks, after actor and
+ * component ticks. Blueprint delegates such as AEnemyBase::OnEnemyDeath are thin adapters
+ * kept for blueprints; native code subscribes here.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatEventBus : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatEventBus* Get(const UObject* WorldContextObject);
+
+	template<typename EventType>
+	static void Publish(const UObject* WorldContextObject, const EventType& Event)
+	{
+		if (UCombatEventBus* Bus = Get(WorldContextObject))
+		{
+			Bus->Channel<EventType>().Publish(Event);
+		}
+	}
+
+	template<typename EventType>
+	TCombatEventChannel<EventType>& Channel()
+	{
+		return Channels.template Get<TTupleIndex<TCombatEventChannel<EventType>, FCombatEventChannels>::Value>();
+	}
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	// Sends every queued event to its subscribers. Runs from Tick; also callable to flush early.
+	void DispatchEvents();
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	FCombatEventChannels Channels;
+};
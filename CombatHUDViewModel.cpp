@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatHUDViewModel.h"
+#include "CombatActorRegistry.h"
+#include "CombatEventBus.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+
+UCombatHUDViewModel* UCombatHUDViewModel::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatHUDViewModel>() : nullptr;
+}
+
+bool UCombatHUDViewModel::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatHUDViewModel::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Kill counts come straight from the registry instead of being polled off the level manager
+	if (UCombatActorRegistry* Registry = Collection.InitializeDependency<UCombatActorRegistry>())
+	{
+		Registry->OnEnemyCountsChanged.AddUObject(this, &UCombatHUDViewModel::OnEnemyCountsChanged);
+	}
+
+	// Deaths and damage arrive as one batch per frame from the event bus
+	if (UCombatEventBus* EventBus = Collection.InitializeDependency<UCombatEventBus>())
+	{
+		EventBus->Channel<FCombatEnemyDiedEvent>().OnEvents.AddUObject(this, &UCombatHUDViewModel::OnEnemiesDied);
+		EventBus->Channel<FCombatHitEvent>().OnEvents.AddUObject(this, &UCombatHUDViewModel::OnHits);
+	}
+}
+
+void UCombatHUDViewModel::Deinitialize()
+{
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->OnEnemyCountsChanged.RemoveAll(this);
+	}
+
+	if (UCombatEventBus* EventBus = UCombatEventBus::Get(this))
+	{
+		EventBus->Channel<FCombatEnemyDiedEvent>().OnEvents.RemoveAll(this);
+		EventBus->Channel<FCombatHitEvent>().OnEvents.RemoveAll(this);
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatHUDViewModel::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatHUDViewModel, STATGROUP_Tickables);
+}
+
+void UCombatHUDViewModel::Tick(float DeltaTime)
+{
+	// Cleared first so a listener that pushes a new value schedules another notification
+	const int32 Fields = static_cast<int32>(ChangedFields);
+	ChangedFields = ECombatHUDField::None;
+
+	OnHUDChanged.Broadcast(Fields);
+}
+
+void UCombatHUDViewModel::SetWeapon(FName InWeaponName, int32 InMagAmmo, int32 InTotalAmmo)
+{
+	if (WeaponName != InWeaponName)
+	{
+		WeaponName = InWeaponName;
+		ChangedFields |= ECombatHUDField::Weapon;
+	}
+
+	if (MagAmmo != InMagAmmo || TotalAmmo != InTotalAmmo)
+	{
+		MagAmmo = InMagAmmo;
+		TotalAmmo = InTotalAmmo;
+		ChangedFields |= ECombatHUDField::Ammo;
+	}
+}
+
+void UCombatHUDViewModel::SetReloading(bool bInIsReloading)
+{
+	if (bIsReloading != bInIsReloading)
+	{
+		bIsReloading = bInIsReloading;
+		ChangedFields |= ECombatHUDField::Reload;
+	}
+}
+
+void UCombatHUDViewModel::SetHealthAndShield(float InHealth, float InMaxHealth, float InShield, float InMaxShield)
+{
+	if (Health != InHealth || MaxHealth != InMaxHealth)
+	{
+		Health = InHealth;
+		MaxHealth = InMaxHealth;
+		ChangedFields |= ECombatHUDField::Health;
+	}
+
+	if (Shield != InShield || MaxShield != InMaxShield)
+	{
+		Shield = InShield;
+		MaxShield = InMaxShield;
+		ChangedFields |= ECombatHUDField::Shield;
+	}
+}
+
+void UCombatHUDViewModel::OnEnemyCountsChanged()
+{
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this);
+	if (!Registry) return;
+
+	if (DeadEnemies != Registry->GetDeadEnemyCount() || TotalEnemies != Registry->GetTotalEnemyCount())
+	{
+		DeadEnemies = Registry->GetDeadEnemyCount();
+		TotalEnemies = Registry->GetTotalEnemyCount();
+		ChangedFields |= ECombatHUDField::KillCount;
+	}
+}
+
+void UCombatHUDViewModel::OnEnemiesDied(TConstArrayView<FCombatEnemyDiedEvent> Events)
+{
+	// The registry counted each death before it was published
+	OnEnemyCountsChanged();
+}
+
+void UCombatHUDViewModel::OnHits(TConstArrayView<FCombatHitEvent> Events)
+{
+	float NewDamage = 0.0f;
+	for (const FCombatHitEvent& Event : Events)
+	{
+		// Enemies publish their hits on the player too, only count the local player's own
+		const APawn* Instigator = Cast<APawn>(Event.Instigator.Get());
+		if (Instigator && Instigator->IsPlayerControlled() && Instigator->IsLocallyControlled())
+		{
+			NewDamage += Event.Damage;
+		}
+	}
+
+	if (NewDamage > 0.0f)
+	{
+		DamageDealt += NewDamage;
+		ChangedFields |= ECombatHUDField::DamageDealt;
+	}
+}
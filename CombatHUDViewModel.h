@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatHUDViewModel.generated.h"
+
+struct FCombatEnemyDiedEvent;
+struct FCombatHitEvent;
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ECombatHUDField : uint8
+{
+	None = 0 UMETA(Hidden),
+	Weapon = 1 << 0,
+	Ammo = 1 << 1,
+	Reload = 1 << 2,
+	Health = 1 << 3,
+	Shield = 1 << 4,
+	KillCount = 1 << 5,
+	DamageDealt = 1 << 6
+};
+ENUM_CLASS_FLAGS(ECombatHUDField);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCombatHUDChanged, int32, ChangedFields);
+
+/**
+ * Values the combat HUD shows. Gameplay code pushes values in through the setters, which
+ * only mark a field dirty when it actually changed. Once per frame, and only if something
+ * is dirty, OnHUDChanged fires with the changed ECombatHUDField bits, so widgets update on
+ * change instead of binding to getters that poll every frame.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatHUDViewModel : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatHUDViewModel* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override { return ChangedFields != ECombatHUDField::None; }
+
+	virtual TStatId GetStatId() const override;
+
+	void SetWeapon(FName InWeaponName, int32 InMagAmmo, int32 InTotalAmmo);
+
+	void SetReloading(bool bInIsReloading);
+
+	void SetHealthAndShield(float InHealth, float InMaxHealth, float InShield, float InMaxShield);
+
+	UPROPERTY(BlueprintAssignable, Category = "Combat HUD")
+	FOnCombatHUDChanged OnHUDChanged;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	FName WeaponName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	int32 MagAmmo = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	int32 TotalAmmo = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	bool bIsReloading = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	float Health = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	float MaxHealth = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	float Shield = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	float MaxShield = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	int32 DeadEnemies = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	int32 TotalEnemies = 0;
+
+	// Damage the local player has dealt this level
+	UPROPERTY(BlueprintReadOnly, Category = "Combat HUD")
+	float DamageDealt = 0.0f;
+
+	UFUNCTION(BlueprintPure, Category = "Combat HUD")
+	static bool HasField(int32 Fields, ECombatHUDField Field) { return (Fields & static_cast<int32>(Field)) != 0; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	ECombatHUDField ChangedFields = ECombatHUDField::None;
+
+	void OnEnemyCountsChanged();
+
+	void OnEnemiesDied(TConstArrayView<FCombatEnemyDiedEvent> Events);
+
+	void OnHits(TConstArrayView<FCombatHitEvent> Events);
+};
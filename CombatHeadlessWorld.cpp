@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatHeadlessWorld.h"
+#include "AIController.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "EnemyBase.h"
+#include "PlayerCharacterController.h"
+#include "WeaponActor.h"
+
+namespace
+{
+	// Native classes carry no health data, only their Blueprints do. Give bare spawns enough
+	// to survive a run; content classes keep whatever their defaults set.
+	template <typename ActorType>
+	void FillEmptyCombatPools(ActorType* Actor)
+	{
+		if (Actor->MaxHealthPool > 0.0f) return;
+
+		Actor->MaxShieldPool = 100.0f;
+		Actor->CurrentShieldPool = 100.0f;
+		Actor->MaxHealthPool = 100.0f;
+		Actor->CurrentHealthPool = 100.0f;
+		Actor->HealthRegenSpeed = 10.0f;
+	}
+}
+
+FCombatHeadlessWorld::FCombatHeadlessWorld()
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CombatHeadlessWorld"));
+	World->AddToRoot();
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	// Without a game mode nothing starts play, so do what the game state would
+	if (!World->GetBegunPlay())
+	{
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+}
+
+FCombatHeadlessWorld::~FCombatHeadlessWorld()
+{
+	if (!World) return;
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	World = nullptr;
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+double FCombatHeadlessWorld::Tick(float DeltaSeconds)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	World->Tick(LEVELTICK_All, DeltaSeconds);
+
+	const double FrameMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	GFrameCounter++;
+
+	return FrameMs;
+}
+
+APlayerCharacterController* FCombatHeadlessWorld::SpawnPlayer(const FVector& Location, UClass* PlayerClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	UClass* SpawnClass = PlayerClass ? PlayerClass : APlayerCharacterController::StaticClass();
+	APlayerCharacterController* Player = World->SpawnActor<APlayerCharacterController>(SpawnClass, Location, FRotator::ZeroRotator, SpawnParams);
+	if (!Player) return nullptr;
+
+	Player->Tags.AddUnique(FName("Player"));
+	FillEmptyCombatPools(Player);
+
+	if (AAIController* Controller = World->SpawnActor<AAIController>(SpawnParams))
+	{
+		Controller->Possess(Player);
+	}
+
+	return Player;
+}
+
+void FCombatHeadlessWorld::SpawnFiringEnemies(APawn* Target, int32 Count, float Radius, TArray<AEnemyBase*>& OutEnemies, UClass* EnemyClass)
+{
+	UClass* SpawnClass = EnemyClass ? EnemyClass : AEnemyBase::StaticClass();
+	const FVector Center = Target ? Target->GetActorLocation() : FVector::ZeroVector;
+
+	OutEnemies.Reserve(OutEnemies.Num() + Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const float Angle = 2.0f * PI * Index / FMath::Max(Count, 1);
+		const FVector Location = Center + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0f);
+		const FTransform SpawnTransform((Center - Location).Rotation(), Location);
+
+		AEnemyBase* Enemy = World->SpawnActorDeferred<AEnemyBase>(SpawnClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		if (!Enemy) continue;
+
+		// Content enemies bring their own weapon, bare ones get the native weapon actor and its skeletal mesh component
+		if (!Enemy->WeaponBlueprint)
+		{
+			Enemy->WeaponBlueprint = AWeaponActor::StaticClass();
+		}
+
+		FillEmptyCombatPools(Enemy);
+		Enemy->FinishSpawning(SpawnTransform);
+		ArmEnemy(Enemy, Target);
+
+		OutEnemies.Add(Enemy);
+	}
+}
+
+void FCombatHeadlessWorld::ArmEnemy(AEnemyBase* Enemy, APawn* Target)
+{
+	if (!Enemy) return;
+
+	// Skip the startup deferral so the enemy fires from the first frame
+	Enemy->SpawnEnemyWeapon();
+	Enemy->PlayerPawn = Target;
+	Enemy->bIsEnemyAimingWeapon = true;
+	Enemy->SetEnemyAiming();
+}
+
+void FCombatHeadlessWorld::SpawnWallField(const FVector& Origin, int32 Count, TArray<AActor*>& OutWalls)
+{
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!CubeMesh) return;
+
+	// 400 x 20 x 300 walls in rows 300 apart, like the wall-run bench
+	const int32 WallsPerRow = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	OutWalls.Reserve(OutWalls.Num() + Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Origin + FVector((Index % WallsPerRow) * 500.0f, (Index / WallsPerRow) * 300.0f, 0.0f);
+		AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator, SpawnParams);
+		if (!Wall) continue;
+
+		Wall->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+		Wall->GetStaticMeshComponent()->SetStaticMesh(CubeMesh);
+		Wall->SetActorScale3D(FVector(4.0f, 0.2f, 3.0f));
+		Wall->Tags.Add(FName("Wall"));
+		OutWalls.Add(Wall);
+	}
+}
+
+UWeaponDefinition* FCombatHeadlessWorld::CreateTransientWeapon(FName Name, EFireMode FireMode, float FireRate, int32 AmmoPerMag)
+{
+	UWeaponDefinition* Definition = NewObject<UWeaponDefinition>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UWeaponDefinition::StaticClass(), Name));
+	Definition->WeaponName = Name;
+	Definition->FireMode = FireMode;
+	Definition->FireRate = FireRate;
+	Definition->AmmoPerMag = AmmoPerMag;
+	Definition->WeaponClass = TSoftClassPtr<AWeaponActor>(AWeaponActor::StaticClass());
+	return Definition;
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WeaponDefinition.h"
+
+class UWorld;
+class AActor;
+class AEnemyBase;
+class APlayerCharacterController;
+
+/**
+ * A bare game world for commandlets and perf runs (-nullrhi friendly). No map, game mode or
+ * game instance is involved: the world is created empty, actors begin play as soon as they
+ * are spawned and Tick() drives the world, its timers and the tickable world subsystems at
+ * a fixed step. Destroyed with the helper.
+ */
+class COMBATSYSTEM_API FCombatHeadlessWorld : public FNoncopyable
+{
+public:
+
+	FCombatHeadlessWorld();
+
+	~FCombatHeadlessWorld();
+
+	UWorld* GetWorld() const { return World; }
+
+	// Advances the world one frame of DeltaSeconds, returns the game-thread time it took in milliseconds
+	double Tick(float DeltaSeconds);
+
+	// Player pawn possessed by an AI controller so its movement simulates without a local player
+	APlayerCharacterController* SpawnPlayer(const FVector& Location, UClass* PlayerClass = nullptr);
+
+	// Enemies on a ring around Target, armed with a bare weapon actor and shooting at Target
+	void SpawnFiringEnemies(APawn* Target, int32 Count, float Radius, TArray<AEnemyBase*>& OutEnemies, UClass* EnemyClass = nullptr);
+
+	// Starts a spawned enemy shooting at Target straight away instead of after its startup deferral
+	static void ArmEnemy(AEnemyBase* Enemy, APawn* Target);
+
+	// Rows of wall-tagged cubes, returns the spawned walls. Call before spawning a wall-run index so it bakes them.
+	void SpawnWallField(const FVector& Origin, int32 Count, TArray<AActor*>& OutWalls);
+
+	// Weapon definition backed by the native weapon actor, so it fires without any content
+	static UWeaponDefinition* CreateTransientWeapon(FName Name, EFireMode FireMode, float FireRate, int32 AmmoPerMag = 1000000);
+
+private:
+
+	UWorld* World = nullptr;
+};
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatLatencySubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace CombatLatency
+{
+	static const TCHAR* StageNames[] = { TEXT("PressToTrace"), TEXT("PressToDamage"), TEXT("PressToFX") };
+
+	static_assert(UE_ARRAY_COUNT(StageNames) == static_cast<int32>(ECombatLatencyStage::Num), "Every latency stage needs a name");
+
+	static void DumpLatency(UWorld* World)
+	{
+		if (UCombatLatencySubsystem* Latency = UCombatLatencySubsystem::Get(World))
+		{
+			Latency->Dump(true);
+		}
+	}
+
+	static void ResetLatency(UWorld* World)
+	{
+		if (UCombatLatencySubsystem* Latency = UCombatLatencySubsystem::Get(World))
+		{
+			Latency->Reset();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("Combat.Latency.Dump"),
+		TEXT("Logs the input-to-hit latency histograms and writes them to Saved/Profiling/CombatLatency."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&DumpLatency));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("Combat.Latency.Reset"),
+		TEXT("Clears the input-to-hit latency histograms."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&ResetLatency));
+}
+
+void FCombatLatencyHistogram::Add(double Milliseconds)
+{
+	if (Buckets.Num() == 0)
+	{
+		Buckets.SetNumZeroed(NumBuckets);
+	}
+
+	const int32 Bucket = FMath::Clamp(FMath::FloorToInt32(Milliseconds / BucketMs), 0, NumBuckets - 1);
+	Buckets[Bucket]++;
+
+	Count++;
+	SumMs += Milliseconds;
+	MaxMs = FMath::Max(MaxMs, Milliseconds);
+}
+
+double FCombatLatencyHistogram::GetPercentile(double Percentile) const
+{
+	if (Count == 0) return 0.0;
+
+	const int64 Rank = FMath::Max<int64>(1, FMath::CeilToInt64(Count * FMath::Clamp(Percentile, 0.0, 100.0) / 100.0));
+
+	int64 Seen = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Seen += Buckets[Bucket];
+		if (Seen >= Rank)
+		{
+			// Never report more than was actually measured
+			return FMath::Min((Bucket + 1) * BucketMs, MaxMs);
+		}
+	}
+
+	return MaxMs;
+}
+
+void FCombatLatencyHistogram::Reset()
+{
+	Buckets.Reset();
+	Count = 0;
+	MaxMs = 0.0;
+	SumMs = 0.0;
+}
+
+UCombatLatencySubsystem* UCombatLatencySubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UCombatLatencySubsystem>() : nullptr;
+}
+
+void UCombatLatencySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SessionStart = FDateTime::Now();
+
+	// Commandlets tick their worlds without engine frames; the stamp stays zero there and nothing is sampled
+	if (!IsRunningCommandlet())
+	{
+		FrameStartCycles = FPlatformTime::Cycles64();
+
+		FCoreDelegates::OnBeginFrame.AddUObject(this, &UCombatLatencySubsystem::OnBeginFrame);
+		FCoreDelegates::OnEndFrame.AddUObject(this, &UCombatLatencySubsystem::OnEndFrame);
+	}
+}
+
+void UCombatLatencySubsystem::Deinitialize()
+{
+	FCoreDelegates::OnBeginFrame.RemoveAll(this);
+	FCoreDelegates::OnEndFrame.RemoveAll(this);
+	OnEndFrame();
+
+	// One report per session, skipped when nothing was fired
+	if (Histograms[static_cast<int32>(ECombatLatencyStage::Trace)].Num() > 0)
+	{
+		Dump(true);
+	}
+
+	Super::Deinitialize();
+}
+
+void UCombatLatencySubsystem::Record(ECombatLatencyStage Stage, uint64 InputCycles)
+{
+	if (InputCycles == 0) return;
+
+	const double Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - InputCycles);
+	Histograms[static_cast<int32>(Stage)].Add(Milliseconds);
+}
+
+void UCombatLatencySubsystem::RecordAtEndOfFrame(ECombatLatencyStage Stage, uint64 InputCycles)
+{
+	if (InputCycles == 0) return;
+
+	EndOfFrameSamples.Add({ Stage, InputCycles });
+}
+
+void UCombatLatencySubsystem::OnBeginFrame()
+{
+	FrameStartCycles = FPlatformTime::Cycles64();
+}
+
+void UCombatLatencySubsystem::OnEndFrame()
+{
+	for (const FPendingSample& Sample : EndOfFrameSamples)
+	{
+		Record(Sample.Stage, Sample.InputCycles);
+	}
+	EndOfFrameSamples.Reset();
+}
+
+void UCombatLatencySubsystem::Dump(bool bWriteReport) const
+{
+	FString Report = TEXT("Stage,Samples,P50Ms,P99Ms,MaxMs,MeanMs\n");
+
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(ECombatLatencyStage::Num); ++StageIndex)
+	{
+		const FCombatLatencyHistogram& Histogram = Histograms[StageIndex];
+
+		UE_LOG(LogTemp, Log, TEXT("Combat latency %s: %d samples, p50 %.2f ms, p99 %.2f ms, max %.2f ms"),
+			CombatLatency::StageNames[StageIndex], Histogram.Num(), Histogram.GetPercentile(50.0), Histogram.GetPercentile(99.0), Histogram.GetMax());
+
+		Report += FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f\n"),
+			CombatLatency::StageNames[StageIndex], Histogram.Num(), Histogram.GetPercentile(50.0), Histogram.GetPercentile(99.0), Histogram.GetMax(), Histogram.GetMean());
+	}
+
+	if (bWriteReport)
+	{
+		const FString ReportPath = FPaths::ProfilingDir() / TEXT("CombatLatency") / FString::Printf(TEXT("Session_%s.csv"), *SessionStart.ToString());
+		FFileHelper::SaveStringToFile(Report, *ReportPath);
+	}
+}
+
+void UCombatLatencySubsystem::Reset()
+{
+	EndOfFrameSamples.Reset();
+
+	for (FCombatLatencyHistogram& Histogram : Histograms)
+	{
+		Histogram.Reset();
+	}
+}
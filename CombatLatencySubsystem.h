@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "CombatLatencySubsystem.generated.h"
+
+// Where a fire press has got to when its latency is sampled
+enum class ECombatLatencyStage : uint8
+{
+	Trace,
+	Damage,
+	FX,
+	Num
+};
+
+/**
+ * Fixed-bucket latency histogram. 0.1 ms buckets cover the first 250 ms, slower samples
+ * land in the last bucket; the max is kept exact.
+ */
+struct COMBATSYSTEM_API FCombatLatencyHistogram
+{
+	static constexpr double BucketMs = 0.1;
+
+	static constexpr int32 NumBuckets = 2500;
+
+	void Add(double Milliseconds);
+
+	// Upper edge of the bucket holding the given percentile (0-100), 0 when empty
+	double GetPercentile(double Percentile) const;
+
+	int32 Num() const { return Count; }
+
+	double GetMax() const { return MaxMs; }
+
+	double GetMean() const { return Count > 0 ? SumMs / Count : 0.0; }
+
+	void Reset();
+
+private:
+
+	TArray<uint32> Buckets;
+
+	int32 Count = 0;
+
+	double MaxMs = 0.0;
+
+	double SumMs = 0.0;
+};
+
+/**
+ * Input-to-hit latency for the local player's fire presses. A press is stamped with the
+ * start of the frame that polled it (GetFrameStartCycles): input is only read once per
+ * frame, so the press can have waited that long before StartFiring saw it. The weapon
+ * manager carries the stamp through the first batch it fires and records press-to-trace
+ * and press-to-damage here. Press-to-FX is taken at the end of the frame that spawned the
+ * FX, when it is handed to the renderer. Histograms cover the whole session and are dumped
+ * to the log and Saved/Profiling/CombatLatency when the game instance shuts down.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatLatencySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatLatencySubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// Records the time from InputCycles until now. A zero stamp (AI or scripted fire) is ignored.
+	void Record(ECombatLatencyStage Stage, uint64 InputCycles);
+
+	// Like Record, but measured once the current frame ends
+	void RecordAtEndOfFrame(ECombatLatencyStage Stage, uint64 InputCycles);
+
+	// FPlatformTime::Cycles64 when the current frame began, the stamp for input read this frame
+	uint64 GetFrameStartCycles() const { return FrameStartCycles; }
+
+	const FCombatLatencyHistogram& GetHistogram(ECombatLatencyStage Stage) const { return Histograms[static_cast<int32>(Stage)]; }
+
+	// Logs every stage and, when bWriteReport is set, writes them to a CSV for the session
+	void Dump(bool bWriteReport) const;
+
+	void Reset();
+
+private:
+
+	void OnBeginFrame();
+
+	void OnEndFrame();
+
+	FCombatLatencyHistogram Histograms[static_cast<int32>(ECombatLatencyStage::Num)];
+
+	uint64 FrameStartCycles = 0;
+
+	struct FPendingSample
+	{
+		ECombatLatencyStage Stage;
+		uint64 InputCycles;
+	};
+
+	TArray<FPendingSample> EndOfFrameSamples;
+
+	FDateTime SessionStart;
+};
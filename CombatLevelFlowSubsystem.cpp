@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatLevelFlowSubsystem.h"
+#include "CombatStartupSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+static TAutoConsoleVariable<bool> CVarCombatLevelPreload(
+	TEXT("Combat.LevelFlow.Preload"),
+	true,
+	TEXT("Asynchronously preload the next level while the current one is played. Disable to measure the blocking transition."));
+
+namespace CombatLevelFlow
+{
+	// Where a level goes when neither the node nor the progression names a next level
+	static const TCHAR* FallbackNextLevel = TEXT("MainMenuMap");
+
+	static FString ToLongPackageName(const FString& LevelName)
+	{
+		if (FPackageName::IsValidLongPackageName(LevelName))
+		{
+			return LevelName;
+		}
+
+		FString LongPackageName;
+		return FPackageName::SearchForPackageOnDisk(LevelName + FPackageName::GetMapPackageExtension(), &LongPackageName) ? LongPackageName : LevelName;
+	}
+}
+
+UCombatLevelFlowSubsystem* UCombatLevelFlowSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UCombatLevelFlowSubsystem>() : nullptr;
+}
+
+void UCombatLevelFlowSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UCombatLevelFlowSubsystem::OnPostLoadMap);
+
+	// Searching the disk is slow, so it happens once here rather than on every level start
+	FallbackLevelPackage = CombatLevelFlow::ToLongPackageName(CombatLevelFlow::FallbackNextLevel);
+}
+
+void UCombatLevelFlowSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	ReleasePreload();
+
+	Super::Deinitialize();
+}
+
+void UCombatLevelFlowSubsystem::BeginLevel(UWorld* World, const UCombatLevelProgression* Progression)
+{
+	if (!World) return;
+
+	FString LevelName = World->GetMapName();
+	LevelName.RemoveFromStart(World->StreamingLevelsPrefix);
+
+	const FCombatLevelNode* Node = Progression ? Progression->FindNode(FName(*LevelName)) : nullptr;
+	if (Node)
+	{
+		CurrentNode = *Node;
+	}
+	else
+	{
+		CurrentNode = FCombatLevelNode();
+		CurrentNode.LevelName = FName(*LevelName);
+
+		// Built-in flow used when no progression asset is assigned
+		if (!Progression && LevelName.Equals(TEXT("GameLevel_1")))
+		{
+			CurrentNode.UnlocksLevel = FName("GameLevel_2");
+		}
+	}
+
+	if (!CurrentNode.NextLevelOnComplete.IsNull())
+	{
+		NextLevelPackage = CurrentNode.NextLevelOnComplete.GetLongPackageName();
+	}
+	else if (Progression && !Progression->DefaultNextLevel.IsNull())
+	{
+		NextLevelPackage = Progression->DefaultNextLevel.GetLongPackageName();
+	}
+	else
+	{
+		NextLevelPackage = FallbackLevelPackage;
+	}
+
+	// PIE loads duplicated UEDPIE_ packages on travel, so a preloaded package would never be used there
+	if (!CVarCombatLevelPreload.GetValueOnGameThread() || World->WorldType == EWorldType::PIE) return;
+
+	// Startup work comes first; the preload only competes with gameplay for IO once it has drained
+	UCombatStartupSubsystem::Defer(World, TEXT("LevelFlow.PreloadNextLevel"), ECombatStartupPriority::Low,
+		[WeakThis = TWeakObjectPtr<UCombatLevelFlowSubsystem>(this), Package = NextLevelPackage]()
+		{
+			if (UCombatLevelFlowSubsystem* Subsystem = WeakThis.Get())
+			{
+				Subsystem->StartPreload(Package);
+			}
+		});
+}
+
+void UCombatLevelFlowSubsystem::StartPreload(const FString& PackageName)
+{
+	if (!FPackageName::IsValidLongPackageName(PackageName))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot preload level %s: no map package found."), *PackageName);
+		return;
+	}
+
+	if (PackageName == PreloadingPackage) return;
+
+	ReleasePreload();
+
+	PreloadingPackage = PackageName;
+	PreloadStartTime = FPlatformTime::Seconds();
+
+	LoadPackageAsync(PackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UCombatLevelFlowSubsystem::OnPreloadComplete));
+}
+
+void UCombatLevelFlowSubsystem::ReleasePreload()
+{
+	PreloadedPackage = nullptr;
+	PreloadedWorld = nullptr;
+	PreloadingPackage.Reset();
+}
+
+void UCombatLevelFlowSubsystem::OnPreloadComplete(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	// A newer preload or a finished transition may have replaced this request
+	if (PackageName.ToString() != PreloadingPackage) return;
+
+	if (Result != EAsyncLoadingResult::Succeeded || !LoadedPackage)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to preload level %s."), *PreloadingPackage);
+		PreloadingPackage.Reset();
+		return;
+	}
+
+	// Holding the world keeps the package's objects resident until travel picks them up
+	PreloadedPackage = LoadedPackage;
+	PreloadedWorld = UWorld::FindWorldInPackage(LoadedPackage);
+
+	UE_LOG(LogTemp, Log, TEXT("Preloaded level %s in %.1f ms."), *PreloadingPackage, (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+}
+
+void UCombatLevelFlowSubsystem::TravelToNextLevel(UWorld* World)
+{
+	if (!World || NextLevelPackage.IsEmpty()) return;
+
+	TransitionStartTime = FPlatformTime::Seconds();
+	bTransitionWasPreloaded = PreloadedWorld != nullptr;
+	TransitionFromLevel = CurrentNode.LevelName;
+
+	AGameModeBase* GameMode = World->GetAuthGameMode();
+	bTransitionWasSeamless = CurrentNode.bSeamlessTravel && GameMode && GameMode->bUseSeamlessTravel;
+
+	if (bTransitionWasSeamless)
+	{
+		World->ServerTravel(NextLevelPackage);
+	}
+	else
+	{
+		UGameplayStatics::OpenLevel(World, FName(*NextLevelPackage));
+	}
+}
+
+void UCombatLevelFlowSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (TransitionStartTime <= 0.0) return;
+
+	const double LatencyMs = (FPlatformTime::Seconds() - TransitionStartTime) * 1000.0;
+	const FString ToLevel = LoadedWorld ? LoadedWorld->GetMapName() : FString();
+	TransitionStartTime = 0.0;
+
+	UE_LOG(LogTemp, Display, TEXT("Level transition %s -> %s took %.1f ms (preloaded: %s, seamless: %s)."),
+		*TransitionFromLevel.ToString(), *ToLevel, LatencyMs,
+		bTransitionWasPreloaded ? TEXT("yes") : TEXT("no"), bTransitionWasSeamless ? TEXT("yes") : TEXT("no"));
+
+	// One row per transition, so runs with Combat.LevelFlow.Preload 0 and 1 can be compared side by side
+	const FString ReportPath = FPaths::ProfilingDir() / TEXT("CombatLevelTransitions.csv");
+	FString Row;
+	if (!IFileManager::Get().FileExists(*ReportPath))
+	{
+		Row += TEXT("From,To,Preloaded,Seamless,LatencyMs\n");
+	}
+	Row += FString::Printf(TEXT("%s,%s,%d,%d,%.2f\n"), *TransitionFromLevel.ToString(), *ToLevel, bTransitionWasPreloaded ? 1 : 0, bTransitionWasSeamless ? 1 : 0, LatencyMs);
+	FFileHelper::SaveStringToFile(Row, *ReportPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	// The new world is owned by the engine now
+	ReleasePreload();
+}
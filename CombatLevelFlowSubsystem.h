@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/UObjectGlobals.h"
+#include "CombatLevelProgression.h"
+#include "CombatLevelFlowSubsystem.generated.h"
+
+class UPackage;
+class UWorld;
+
+/**
+ * Drives level-to-level travel from a UCombatLevelProgression. While a level is played
+ * the package of the level that most likely comes next is loaded asynchronously and
+ * kept resident, so the transition itself doesn't block on disk. Every transition's
+ * latency is logged and appended to Saved/Profiling/CombatLevelTransitions.csv.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatLevelFlowSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatLevelFlowSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// Called by the level manager when a combat level starts. Progression may be null for the built-in flow.
+	void BeginLevel(UWorld* World, const UCombatLevelProgression* Progression);
+
+	const FCombatLevelNode& GetCurrentNode() const { return CurrentNode; }
+
+	// Leaves the current level for its next level, using the preloaded package when it is ready
+	void TravelToNextLevel(UWorld* World);
+
+private:
+
+	FCombatLevelNode CurrentNode;
+
+	// Long package name of the level after the current one
+	FString NextLevelPackage;
+
+	// Long package name of the level used when nothing names a next level, resolved at startup
+	FString FallbackLevelPackage;
+
+	UPROPERTY()
+	UPackage* PreloadedPackage = nullptr;
+
+	UPROPERTY()
+	UWorld* PreloadedWorld = nullptr;
+
+	FString PreloadingPackage;
+
+	double PreloadStartTime = 0.0;
+
+	double TransitionStartTime = 0.0;
+
+	FName TransitionFromLevel;
+
+	bool bTransitionWasPreloaded = false;
+
+	bool bTransitionWasSeamless = false;
+
+	void StartPreload(const FString& PackageName);
+
+	void ReleasePreload();
+
+	void OnPreloadComplete(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+};
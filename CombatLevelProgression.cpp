@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatLevelProgression.h"
+
+const FCombatLevelNode* UCombatLevelProgression::FindNode(FName LevelName) const
+{
+	return Levels.FindByPredicate([LevelName](const FCombatLevelNode& Node) { return Node.LevelName == LevelName; });
+}
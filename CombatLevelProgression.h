@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/SoftObjectPtr.h"
+#include "CombatLevelProgression.generated.h"
+
+class UWorld;
+
+USTRUCT(BlueprintType)
+struct FCombatLevelNode
+{
+	GENERATED_BODY()
+
+	// Short map name, e.g. GameLevel_1
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level Progression")
+	FName LevelName;
+
+	// Level opened once every enemy is dead. Falls back to the progression's DefaultNextLevel when unset.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level Progression")
+	TSoftObjectPtr<UWorld> NextLevelOnComplete;
+
+	// Level unlocked in the save when this one is completed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level Progression")
+	FName UnlocksLevel;
+
+	// Use seamless travel when the game mode allows it, instead of a full OpenLevel
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level Progression")
+	bool bSeamlessTravel = false;
+};
+
+/**
+ * Data-driven level flow: which level follows which and what completing a level unlocks.
+ */
+UCLASS(BlueprintType)
+class COMBATSYSTEM_API UCombatLevelProgression : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Level Progression")
+	TArray<FCombatLevelNode> Levels;
+
+	// Where levels without an explicit next level go, normally the main menu
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Level Progression")
+	TSoftObjectPtr<UWorld> DefaultNextLevel;
+
+	const FCombatLevelNode* FindNode(FName LevelName) const;
+};
@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/VectorRegister.h"
+
+/**
+ * Combat rules that don't need an actor: the shield-first damage split, pool regeneration
+ * and magazine reforming on reload. Header-only and free of UObjects, so the same code runs
+ * in the actors, in batches over structure-of-arrays data and in Combat.Bench.Math. The
+ * CombatSystem.Math automation tests pin the scalar rules and check the batch kernels against them.
+ *
+ * Batch kernels process four lanes per step with the engine's vector intrinsics (SSE/NEON)
+ * and finish the tail with the scalar rule. Damage and reload batches match the scalar
+ * results exactly; regen may differ in the last bit where the platform fuses multiply-add.
+ */
+namespace CombatMath
+{
+	// Shield absorbs first, whatever gets through comes off health clamped to [0, MaxHealth].
+	// Returns true when this hit took the shield from positive to empty.
+	FORCEINLINE bool ApplyDamage(float& Shield, float& Health, float MaxHealth, float Amount)
+	{
+		bool bShieldBroken = false;
+
+		if (Shield > 0.0f)
+		{
+			const float ShieldDamage = FMath::Min(Shield, Amount);
+			Shield -= ShieldDamage;
+			Amount -= ShieldDamage;
+
+			bShieldBroken = Shield <= 0.0f;
+		}
+
+		if (Amount > 0.0f)
+		{
+			Health = FMath::Clamp(Health - Amount, 0.0f, MaxHealth);
+		}
+
+		return bShieldBroken;
+	}
+
+	// Refills a pool at Rate per second once Delay seconds have passed since the last damage
+	FORCEINLINE float RegenPool(float Pool, float MaxPool, float Rate, float DeltaTime, float TimeSinceDamage, float Delay)
+	{
+		if (Pool >= 0.0f && Pool < MaxPool && Rate > 0.0f && TimeSinceDamage >= Delay)
+		{
+			return FMath::Clamp(Pool + Rate * DeltaTime, 0.0f, MaxPool);
+		}
+		return Pool;
+	}
+
+	// Player rule: health refills first, the shield only starts once health is full
+	FORCEINLINE void RegenHealthThenShield(float& Health, float MaxHealth, float& Shield, float MaxShield, float Rate, float DeltaTime,
+		float TimeSinceDamage, float HealthDelay, float ShieldDelay)
+	{
+		Health = RegenPool(Health, MaxHealth, Rate, DeltaTime, TimeSinceDamage, HealthDelay);
+
+		if (Health >= MaxHealth)
+		{
+			Shield = RegenPool(Shield, MaxShield, Rate, DeltaTime, TimeSinceDamage, ShieldDelay);
+		}
+	}
+
+	// Swaps in a full magazine and reforms the rounds left in the old one with the spare
+	// magazines; rounds that don't make a full magazine go to the temp pool. Without spare
+	// magazines the temp pool is loaded instead, and the rounds left in the old magazine are
+	// discarded. Returns false when nothing could be reloaded.
+	FORCEINLINE bool ResolveReload(int32& CurrentAmmo, int32& Magazines, int32& TempAmmoPool, int32 AmmoPerMag)
+	{
+		if (AmmoPerMag <= 0 || CurrentAmmo == AmmoPerMag) return false;
+
+		if (Magazines <= 0 && TempAmmoPool <= 0) return false;
+
+		if (Magazines > 0)
+		{
+			const int32 AmmoToSave = CurrentAmmo;
+
+			Magazines--;
+			CurrentAmmo = AmmoPerMag;
+
+			if (AmmoToSave > 0)
+			{
+				const int32 TotalAmmo = AmmoToSave + Magazines * AmmoPerMag;
+				Magazines = TotalAmmo / AmmoPerMag;
+				TempAmmoPool += TotalAmmo % AmmoPerMag;
+			}
+		}
+		else
+		{
+			const int32 LoadAmount = FMath::Min(AmmoPerMag, TempAmmoPool);
+			CurrentAmmo = LoadAmount;
+			TempAmmoPool -= LoadAmount;
+		}
+
+		return true;
+	}
+
+	// ----- Batches over structure-of-arrays data. Out arrays are optional, max pools must not be negative. -----
+
+	inline void ApplyDamageBatchScalar(float* Shields, float* Healths, const float* MaxHealths, const float* Amounts, int32 Num, bool* OutShieldBroken = nullptr)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			const bool bShieldBroken = ApplyDamage(Shields[Index], Healths[Index], MaxHealths[Index], Amounts[Index]);
+			if (OutShieldBroken)
+			{
+				OutShieldBroken[Index] = bShieldBroken;
+			}
+		}
+	}
+
+	inline void ApplyDamageBatch(float* Shields, float* Healths, const float* MaxHealths, const float* Amounts, int32 Num, bool* OutShieldBroken = nullptr)
+	{
+		const VectorRegister4Float Zero = VectorZeroFloat();
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Float Shield = VectorLoad(Shields + Index);
+			const VectorRegister4Float Health = VectorLoad(Healths + Index);
+			const VectorRegister4Float MaxHealth = VectorLoad(MaxHealths + Index);
+			const VectorRegister4Float Amount = VectorLoad(Amounts + Index);
+
+			// Lanes without shield take no shield damage, so the full amount goes through
+			const VectorRegister4Float HasShield = VectorCompareGT(Shield, Zero);
+			const VectorRegister4Float ShieldDamage = VectorSelect(HasShield, VectorMin(Shield, Amount), Zero);
+			const VectorRegister4Float NewShield = VectorSubtract(Shield, ShieldDamage);
+			const VectorRegister4Float Remaining = VectorSubtract(Amount, ShieldDamage);
+
+			const VectorRegister4Float Damaged = VectorMin(VectorMax(VectorSubtract(Health, Remaining), Zero), MaxHealth);
+			const VectorRegister4Float NewHealth = VectorSelect(VectorCompareGT(Remaining, Zero), Damaged, Health);
+
+			VectorStore(NewShield, Shields + Index);
+			VectorStore(NewHealth, Healths + Index);
+
+			if (OutShieldBroken)
+			{
+				const int32 BrokenBits = VectorMaskBits(VectorBitwiseAnd(HasShield, VectorCompareLE(NewShield, Zero)));
+				for (int32 Lane = 0; Lane < 4; ++Lane)
+				{
+					OutShieldBroken[Index + Lane] = (BrokenBits & (1 << Lane)) != 0;
+				}
+			}
+		}
+
+		ApplyDamageBatchScalar(Shields + Index, Healths + Index, MaxHealths + Index, Amounts + Index, Num - Index,
+			OutShieldBroken ? OutShieldBroken + Index : nullptr);
+	}
+
+	inline void RegenPoolsBatchScalar(float* Pools, const float* MaxPools, const float* Rates, const float* TimeSinceDamage, const float* Delays, float DeltaTime, int32 Num)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Pools[Index] = RegenPool(Pools[Index], MaxPools[Index], Rates[Index], DeltaTime, TimeSinceDamage[Index], Delays[Index]);
+		}
+	}
+
+	inline void RegenPoolsBatch(float* Pools, const float* MaxPools, const float* Rates, const float* TimeSinceDamage, const float* Delays, float DeltaTime, int32 Num)
+	{
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		const VectorRegister4Float Delta = VectorSetFloat1(DeltaTime);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Float Pool = VectorLoad(Pools + Index);
+			const VectorRegister4Float MaxPool = VectorLoad(MaxPools + Index);
+			const VectorRegister4Float Rate = VectorLoad(Rates + Index);
+
+			const VectorRegister4Float Eligible = VectorBitwiseAnd(
+				VectorBitwiseAnd(VectorCompareGE(Pool, Zero), VectorCompareLT(Pool, MaxPool)),
+				VectorBitwiseAnd(VectorCompareGT(Rate, Zero), VectorCompareGE(VectorLoad(TimeSinceDamage + Index), VectorLoad(Delays + Index))));
+
+			const VectorRegister4Float Regen = VectorMin(VectorMax(VectorAdd(Pool, VectorMultiply(Rate, Delta)), Zero), MaxPool);
+
+			VectorStore(VectorSelect(Eligible, Regen, Pool), Pools + Index);
+		}
+
+		RegenPoolsBatchScalar(Pools + Index, MaxPools + Index, Rates + Index, TimeSinceDamage + Index, Delays + Index, DeltaTime, Num - Index);
+	}
+
+	inline void ResolveReloadBatchScalar(int32* CurrentAmmo, int32* Magazines, int32* TempAmmoPools, const int32* AmmoPerMag, int32 Num, bool* OutReloaded = nullptr)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			const bool bReloaded = ResolveReload(CurrentAmmo[Index], Magazines[Index], TempAmmoPools[Index], AmmoPerMag[Index]);
+			if (OutReloaded)
+			{
+				OutReloaded[Index] = bReloaded;
+			}
+		}
+	}
+
+	// Vector lanes assume the loadout invariants: no negative counts, CurrentAmmo <= AmmoPerMag
+	// and fewer than 2^24 rounds in total, so the quotient can be taken in float and corrected
+	inline void ResolveReloadBatch(int32* CurrentAmmo, int32* Magazines, int32* TempAmmoPools, const int32* AmmoPerMag, int32 Num, bool* OutReloaded = nullptr)
+	{
+		const VectorRegister4Int Zero = GlobalVectorConstants::IntZero;
+		const VectorRegister4Int One = GlobalVectorConstants::IntOne;
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Int Current = VectorIntLoad(CurrentAmmo + Index);
+			const VectorRegister4Int Mags = VectorIntLoad(Magazines + Index);
+			const VectorRegister4Int Temp = VectorIntLoad(TempAmmoPools + Index);
+			const VectorRegister4Int PerMag = VectorIntLoad(AmmoPerMag + Index);
+
+			const VectorRegister4Int NoOp = VectorIntOr(
+				VectorIntOr(VectorIntCompareLE(PerMag, Zero), VectorIntCompareEQ(Current, PerMag)),
+				VectorIntAnd(VectorIntCompareLE(Mags, Zero), VectorIntCompareLE(Temp, Zero)));
+
+			// Magazine path: one spare goes in and the old rounds are reformed with the rest
+			const VectorRegister4Int SafePerMag = VectorIntMax(PerMag, One);
+			const VectorRegister4Int Total = VectorIntAdd(Current, VectorIntMultiply(VectorIntSubtract(Mags, One), SafePerMag));
+
+			VectorRegister4Int Quotient = VectorFloatToInt(VectorDivide(VectorIntToFloat(Total), VectorIntToFloat(SafePerMag)));
+			VectorRegister4Int Remainder = VectorIntSubtract(Total, VectorIntMultiply(Quotient, SafePerMag));
+
+			// The float quotient can round one off either way
+			const VectorRegister4Int Under = VectorIntCompareLT(Remainder, Zero);
+			Quotient = VectorIntAdd(Quotient, Under);
+			Remainder = VectorIntAdd(Remainder, VectorIntAnd(Under, SafePerMag));
+
+			const VectorRegister4Int Over = VectorIntCompareGE(Remainder, SafePerMag);
+			Quotient = VectorIntSubtract(Quotient, Over);
+			Remainder = VectorIntSubtract(Remainder, VectorIntAnd(Over, SafePerMag));
+
+			// Temp path: as much of the temp pool as fits in one magazine
+			const VectorRegister4Int LoadAmount = VectorIntMin(PerMag, Temp);
+
+			const VectorRegister4Int HasMags = VectorIntCompareGT(Mags, Zero);
+			const VectorRegister4Int NewCurrent = VectorIntSelect(HasMags, PerMag, LoadAmount);
+			const VectorRegister4Int NewMags = VectorIntSelect(HasMags, Quotient, Mags);
+			const VectorRegister4Int NewTemp = VectorIntSelect(HasMags, VectorIntAdd(Temp, Remainder), VectorIntSubtract(Temp, LoadAmount));
+
+			VectorIntStore(VectorIntSelect(NoOp, Current, NewCurrent), CurrentAmmo + Index);
+			VectorIntStore(VectorIntSelect(NoOp, Mags, NewMags), Magazines + Index);
+			VectorIntStore(VectorIntSelect(NoOp, Temp, NewTemp), TempAmmoPools + Index);
+
+			if (OutReloaded)
+			{
+				int32 NoOpLanes[4];
+				VectorIntStore(NoOp, NoOpLanes);
+				for (int32 Lane = 0; Lane < 4; ++Lane)
+				{
+					OutReloaded[Index + Lane] = NoOpLanes[Lane] == 0;
+				}
+			}
+		}
+
+		ResolveReloadBatchScalar(CurrentAmmo + Index, Magazines + Index, TempAmmoPools + Index, AmmoPerMag + Index, Num - Index,
+			OutReloaded ? OutReloaded + Index : nullptr);
+	}
+}
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatMath.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatMathApplyDamageTest, "CombatSystem.Math.ApplyDamage",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatMathApplyDamageTest::RunTest(const FString& Parameters)
+{
+	// Shield takes the whole hit
+	{
+		float Shield = 50.0f, Health = 100.0f;
+		TestFalse(TEXT("Absorbed hit does not break the shield"), CombatMath::ApplyDamage(Shield, Health, 100.0f, 20.0f));
+		TestEqual(TEXT("Absorbed hit: shield"), Shield, 30.0f);
+		TestEqual(TEXT("Absorbed hit: health"), Health, 100.0f);
+	}
+
+	// Shield breaks and the rest comes off health
+	{
+		float Shield = 10.0f, Health = 100.0f;
+		TestTrue(TEXT("Overflowing hit breaks the shield"), CombatMath::ApplyDamage(Shield, Health, 100.0f, 25.0f));
+		TestEqual(TEXT("Overflowing hit: shield"), Shield, 0.0f);
+		TestEqual(TEXT("Overflowing hit: health"), Health, 85.0f);
+	}
+
+	// Exactly the shield breaks it without touching health
+	{
+		float Shield = 10.0f, Health = 100.0f;
+		TestTrue(TEXT("Exact hit breaks the shield"), CombatMath::ApplyDamage(Shield, Health, 100.0f, 10.0f));
+		TestEqual(TEXT("Exact hit: health"), Health, 100.0f);
+	}
+
+	// No shield left: health only, clamped at zero, and nothing to break
+	{
+		float Shield = 0.0f, Health = 15.0f;
+		TestFalse(TEXT("Unshielded hit breaks nothing"), CombatMath::ApplyDamage(Shield, Health, 100.0f, 40.0f));
+		TestEqual(TEXT("Unshielded hit: shield"), Shield, 0.0f);
+		TestEqual(TEXT("Lethal hit clamps health to zero"), Health, 0.0f);
+	}
+
+	// Negative damage does nothing
+	{
+		float Shield = 0.0f, Health = 95.0f;
+		CombatMath::ApplyDamage(Shield, Health, 100.0f, -20.0f);
+		TestEqual(TEXT("Negative damage leaves health alone"), Health, 95.0f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatMathRegenTest, "CombatSystem.Math.Regen",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatMathRegenTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("No regen inside the delay"), CombatMath::RegenPool(40.0f, 100.0f, 10.0f, 0.5f, 1.9f, 2.0f), 40.0f);
+	TestEqual(TEXT("Regen at Rate per second once the delay passed"), CombatMath::RegenPool(40.0f, 100.0f, 10.0f, 0.5f, 2.0f, 2.0f), 45.0f);
+	TestEqual(TEXT("Regen stops at the max"), CombatMath::RegenPool(98.0f, 100.0f, 10.0f, 0.5f, 3.0f, 2.0f), 100.0f);
+	TestEqual(TEXT("A full pool stays full"), CombatMath::RegenPool(100.0f, 100.0f, 10.0f, 0.5f, 3.0f, 2.0f), 100.0f);
+	TestEqual(TEXT("No regen without a rate"), CombatMath::RegenPool(40.0f, 100.0f, 0.0f, 0.5f, 3.0f, 2.0f), 40.0f);
+
+	// Player rule: health first, the shield once health is full
+	{
+		float Health = 50.0f, Shield = 0.0f;
+		CombatMath::RegenHealthThenShield(Health, 100.0f, Shield, 100.0f, 10.0f, 1.0f, 10.0f, 2.0f, 5.0f);
+		TestEqual(TEXT("Health regens first: health"), Health, 60.0f);
+		TestEqual(TEXT("Health regens first: shield"), Shield, 0.0f);
+	}
+	{
+		float Health = 100.0f, Shield = 20.0f;
+		CombatMath::RegenHealthThenShield(Health, 100.0f, Shield, 100.0f, 10.0f, 1.0f, 10.0f, 2.0f, 5.0f);
+		TestEqual(TEXT("Shield regens once health is full"), Shield, 30.0f);
+	}
+	{
+		float Health = 100.0f, Shield = 20.0f;
+		CombatMath::RegenHealthThenShield(Health, 100.0f, Shield, 100.0f, 10.0f, 1.0f, 3.0f, 2.0f, 5.0f);
+		TestEqual(TEXT("Shield waits for its own delay"), Shield, 20.0f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatMathReloadTest, "CombatSystem.Math.ResolveReload",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatMathReloadTest::RunTest(const FString& Parameters)
+{
+	struct FCase
+	{
+		const TCHAR* Name;
+		int32 Current, Magazines, Temp, AmmoPerMag;
+		bool bReloaded;
+		int32 ExpectedCurrent, ExpectedMagazines, ExpectedTemp;
+	};
+
+	const FCase Cases[] =
+	{
+		{ TEXT("Empty magazine swaps in a spare"), 0, 3, 0, 30, true, 30, 2, 0 },
+		{ TEXT("Leftover rounds reform with the spares"), 20, 2, 0, 30, true, 30, 1, 20 },
+		{ TEXT("Leftover rounds complete a temp magazine"), 20, 2, 5, 30, true, 30, 1, 25 },
+		{ TEXT("Leftovers and spares reform into a full magazine"), 15, 3, 0, 30, true, 30, 2, 15 },
+		{ TEXT("Temp pool replaces the magazine and its rounds"), 10, 0, 12, 30, true, 12, 0, 0 },
+		{ TEXT("Temp pool fills the magazine and keeps the rest"), 10, 0, 40, 30, true, 30, 0, 10 },
+		{ TEXT("Empty magazine loads from the temp pool"), 0, 0, 12, 30, true, 12, 0, 0 },
+		{ TEXT("Full magazine does not reload"), 30, 2, 5, 30, false, 30, 2, 5 },
+		{ TEXT("Nothing to reload with"), 4, 0, 0, 30, false, 4, 0, 0 },
+		{ TEXT("Weapon without magazines"), 0, 2, 5, 0, false, 0, 2, 5 },
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		int32 Current = Case.Current, Magazines = Case.Magazines, Temp = Case.Temp;
+		TestEqual(FString::Printf(TEXT("%s: reloaded"), Case.Name), CombatMath::ResolveReload(Current, Magazines, Temp, Case.AmmoPerMag), Case.bReloaded);
+		TestEqual(FString::Printf(TEXT("%s: current"), Case.Name), Current, Case.ExpectedCurrent);
+		TestEqual(FString::Printf(TEXT("%s: magazines"), Case.Name), Magazines, Case.ExpectedMagazines);
+		TestEqual(FString::Printf(TEXT("%s: temp"), Case.Name), Temp, Case.ExpectedTemp);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatMemory.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Components/ActorComponent.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectIterator.h"
+#include "EnemyBase.h"
+#include "WeaponActor.h"
+#include "WeaponDefinition.h"
+#include "PlayerCharacterController.h"
+#include "CombatActorRegistry.h"
+#include "CombatEventBus.h"
+#include "CombatSnapshotSubsystem.h"
+
+LLM_DEFINE_TAG(Combat);
+LLM_DEFINE_TAG(Combat_Enemies, NAME_None, TEXT("Combat"));
+LLM_DEFINE_TAG(Combat_Weapons, NAME_None, TEXT("Combat"));
+LLM_DEFINE_TAG(Combat_FX, NAME_None, TEXT("Combat"));
+LLM_DEFINE_TAG(Combat_Systems, NAME_None, TEXT("Combat"));
+
+namespace CombatMemory
+{
+	struct FFootprint
+	{
+		int32 Count = 0;
+
+		SIZE_T TotalBytes = 0;
+
+		void Add(SIZE_T Bytes)
+		{
+			Count++;
+			TotalBytes += Bytes;
+		}
+	};
+
+	// Object memory plus what it owns on the heap and its exclusive render/audio resources.
+	// Shared assets (meshes, particle templates) are left out, they don't scale with instance count.
+	static SIZE_T GetObjectBytes(UObject* Object)
+	{
+		FArchiveCountMem CountMem(Object);
+		return Object->GetClass()->GetStructureSize() + CountMem.GetMax() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	}
+
+	static SIZE_T GetActorBytes(AActor* Actor)
+	{
+		SIZE_T Bytes = GetObjectBytes(Actor);
+		for (UActorComponent* Component : Actor->GetComponents())
+		{
+			if (Component)
+			{
+				Bytes += GetObjectBytes(Component);
+			}
+		}
+		return Bytes;
+	}
+
+	static void PrintRow(FOutputDevice& Ar, const TCHAR* Label, const FFootprint& Footprint)
+	{
+		const double TotalKB = Footprint.TotalBytes / 1024.0;
+		const double AverageKB = Footprint.Count > 0 ? TotalKB / Footprint.Count : 0.0;
+		Ar.Logf(TEXT("  %-28s %6d  avg %9.1f KB  total %10.1f KB"), Label, Footprint.Count, AverageKB, TotalKB);
+	}
+
+	static void MemReport(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World) return;
+
+		FFootprint Enemies;
+		FFootprint EnemyWeapons;
+		FFootprint Players;
+		FFootprint PlayerWeapons;
+		FFootprint Tracers;
+		FFootprint Emitters;
+		FFootprint Systems;
+
+		// Tracers have no native class of their own, collect every class the combat code spawns them from
+		TSet<UClass*> TracerClasses;
+		for (TObjectIterator<UWeaponDefinition> It; It; ++It)
+		{
+			if (UClass* TracerClass = It->BulletTracerClass.Get())
+			{
+				TracerClasses.Add(TracerClass);
+			}
+		}
+
+		TSet<AActor*> EnemyWeaponActors;
+		for (TActorIterator<AEnemyBase> It(World); It; ++It)
+		{
+			if (It->TracerClass)
+			{
+				TracerClasses.Add(It->TracerClass);
+			}
+
+			if (It->SpawnedWeapon)
+			{
+				EnemyWeaponActors.Add(It->SpawnedWeapon);
+			}
+		}
+
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			AActor* Actor = *It;
+
+			if (Actor->IsA<AEnemyBase>())
+			{
+				Enemies.Add(GetActorBytes(Actor));
+			}
+			else if (EnemyWeaponActors.Contains(Actor))
+			{
+				EnemyWeapons.Add(GetActorBytes(Actor));
+			}
+			else if (Actor->IsA<APlayerCharacterController>())
+			{
+				Players.Add(GetActorBytes(Actor));
+			}
+			else if (Actor->IsA<AWeaponActor>())
+			{
+				PlayerWeapons.Add(GetActorBytes(Actor));
+			}
+			else if (TracerClasses.Contains(Actor->GetClass()))
+			{
+				Tracers.Add(GetActorBytes(Actor));
+			}
+		}
+
+		// SpawnEmitterAttached/AtLocation create auto-destroying components, placed emitters don't
+		for (TObjectIterator<UParticleSystemComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && It->bAutoDestroy && !It->IsTemplate())
+			{
+				Emitters.Add(GetObjectBytes(*It));
+			}
+		}
+
+		UObject* Subsystems[] = { World->GetSubsystem<UCombatActorRegistry>(), World->GetSubsystem<UCombatEventBus>(), World->GetSubsystem<UCombatSnapshotSubsystem>() };
+		for (UObject* Subsystem : Subsystems)
+		{
+			if (Subsystem)
+			{
+				Systems.Add(GetObjectBytes(Subsystem));
+			}
+		}
+
+		Ar.Logf(TEXT("Combat memory report for %s"), *World->GetMapName());
+		PrintRow(Ar, TEXT("AEnemyBase"), Enemies);
+		PrintRow(Ar, TEXT("Enemy weapon actors"), EnemyWeapons);
+		PrintRow(Ar, TEXT("APlayerCharacterController"), Players);
+		PrintRow(Ar, TEXT("AWeaponActor (player)"), PlayerWeapons);
+		PrintRow(Ar, TEXT("Tracer actors"), Tracers);
+		PrintRow(Ar, TEXT("Spawned emitters"), Emitters);
+		PrintRow(Ar, TEXT("Combat world subsystems"), Systems);
+
+		if (Enemies.Count == 0) return;
+
+		// What one more enemy costs, the number enemy caps are sized from
+		const double PerEnemyKB = (Enemies.TotalBytes + EnemyWeapons.TotalBytes) / 1024.0 / Enemies.Count;
+		Ar.Logf(TEXT("  Per enemy including its weapon: %.1f KB"), PerEnemyKB);
+
+		if (Args.Num() > 0)
+		{
+			const double BudgetMB = FCString::Atod(*Args[0]);
+			if (BudgetMB > 0.0 && PerEnemyKB > 0.0)
+			{
+				Ar.Logf(TEXT("  Enemy cap for a %.1f MB budget: %d"), BudgetMB, FMath::FloorToInt32(BudgetMB * 1024.0 / PerEnemyKB));
+			}
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice MemReportCommand(
+		TEXT("Combat.MemReport"),
+		TEXT("Reports instance counts and average/total footprint of combat actors, weapons, tracers and emitters. Combat.MemReport [EnemyBudgetMB]"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&MemReport));
+}
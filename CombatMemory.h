@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// Low-level memory tags for the combat module, visible with -llm under "Combat" in stat LLMFULL
+// and the LLM CSV. Allocations made inside an LLM_SCOPE_BYTAG(Combat_*) are charged to that tag.
+LLM_DECLARE_TAG_API(Combat, COMBATSYSTEM_API);
+LLM_DECLARE_TAG_API(Combat_Enemies, COMBATSYSTEM_API);
+LLM_DECLARE_TAG_API(Combat_Weapons, COMBATSYSTEM_API);
+LLM_DECLARE_TAG_API(Combat_FX, COMBATSYSTEM_API);
+LLM_DECLARE_TAG_API(Combat_Systems, COMBATSYSTEM_API);
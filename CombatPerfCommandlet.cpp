@@ -0,0 +1,465 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatPerfCommandlet.h"
+#include "CombatHeadlessWorld.h"
+#include "PlayerCharacterController.h"
+#include "WeaponManagerComponent.h"
+#include "EnemyBase.h"
+#include "WallRunSurfaceIndex.h"
+#include "Algo/Find.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Dom/JsonObject.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace CombatPerf
+{
+	static constexpr float FrameDelta = 1.0f / 60.0f;
+
+	static constexpr int32 WarmupFrames = 60;
+
+	// Used when neither the baseline file nor the scenario entry names a tolerance
+	static constexpr double DefaultTolerancePct = 15.0;
+
+	struct FSettings
+	{
+		int32 Frames = 600;
+
+		int32 Enemies = 50;
+
+		int32 SwitchesPerFrame = 20;
+
+		int32 Walls = 400;
+	};
+
+	struct FResult
+	{
+		FString Name;
+
+		int32 Frames = 0;
+
+		double MeanMs = 0.0;
+
+		double P95Ms = 0.0;
+
+		double MaxMs = 0.0;
+	};
+
+	static FResult Summarize(const TCHAR* Name, TArray<double>& FrameTimes)
+	{
+		FResult Result;
+		Result.Name = Name;
+		Result.Frames = FrameTimes.Num();
+		if (FrameTimes.Num() == 0) return Result;
+
+		FrameTimes.Sort();
+
+		double TotalMs = 0.0;
+		for (double FrameMs : FrameTimes)
+		{
+			TotalMs += FrameMs;
+		}
+
+		Result.MeanMs = TotalMs / FrameTimes.Num();
+		Result.P95Ms = FrameTimes[FMath::Min(FrameTimes.Num() - 1, FMath::FloorToInt32(FrameTimes.Num() * 0.95))];
+		Result.MaxMs = FrameTimes.Last();
+		return Result;
+	}
+
+	// Frame time covers the scenario's per-frame driver (input it simulates) and the world tick
+	static FResult Run(const TCHAR* Name, const FSettings& Settings, TFunctionRef<void(FCombatHeadlessWorld&)> Setup, TFunctionRef<void(FCombatHeadlessWorld&, int32)> Drive)
+	{
+		FCombatHeadlessWorld HeadlessWorld;
+		Setup(HeadlessWorld);
+
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			Drive(HeadlessWorld, Frame);
+			HeadlessWorld.Tick(FrameDelta);
+		}
+
+		TArray<double> FrameTimes;
+		FrameTimes.Reserve(Settings.Frames);
+		for (int32 Frame = 0; Frame < Settings.Frames; ++Frame)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Drive(HeadlessWorld, WarmupFrames + Frame);
+			const double DriveMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			FrameTimes.Add(DriveMs + HeadlessWorld.Tick(FrameDelta));
+		}
+
+		return Summarize(Name, FrameTimes);
+	}
+
+	static void ArmPlayer(APlayerCharacterController* Player, EFireMode FireMode)
+	{
+		if (!Player || !Player->WeaponManager) return;
+
+		Player->WeaponManager->InitializeSlot(EWeaponSlot::Primary1, FCombatHeadlessWorld::CreateTransientWeapon(TEXT("PerfRifle"), FireMode, 10.0f));
+		Player->WeaponManager->InitializeSlot(EWeaponSlot::Primary2, FCombatHeadlessWorld::CreateTransientWeapon(TEXT("PerfShotgun"), EFireMode::Single, 1.0f));
+		Player->WeaponManager->InitializeSlot(EWeaponSlot::Secondary, FCombatHeadlessWorld::CreateTransientWeapon(TEXT("PerfPistol"), EFireMode::Single, 4.0f));
+		Player->WeaponManager->EquipWeapon(EWeaponSlot::Primary1);
+	}
+
+	// Keeps the player alive so the enemies keep shooting for the whole run
+	static void KeepAlive(APlayerCharacterController* Player)
+	{
+		if (Player && Player->CurrentHealthPool < Player->MaxHealthPool * 0.5f)
+		{
+			Player->RestoreCombatState(Player->MaxShieldPool, Player->MaxHealthPool);
+		}
+	}
+
+	static FResult RunEnemiesFiring(const FSettings& Settings)
+	{
+		APlayerCharacterController* Player = nullptr;
+
+		return Run(TEXT("EnemiesFiring"), Settings,
+			[&](FCombatHeadlessWorld& HeadlessWorld)
+			{
+				Player = HeadlessWorld.SpawnPlayer(FVector(0.0f, 0.0f, 100.0f));
+
+				TArray<AEnemyBase*> Enemies;
+				HeadlessWorld.SpawnFiringEnemies(Player, Settings.Enemies, 1500.0f, Enemies);
+			},
+			[&](FCombatHeadlessWorld& HeadlessWorld, int32 Frame)
+			{
+				KeepAlive(Player);
+			});
+	}
+
+	static FResult RunSustainedAutoFire(const FSettings& Settings)
+	{
+		APlayerCharacterController* Player = nullptr;
+
+		return Run(TEXT("SustainedAutoFire"), Settings,
+			[&](FCombatHeadlessWorld& HeadlessWorld)
+			{
+				Player = HeadlessWorld.SpawnPlayer(FVector(0.0f, 0.0f, 100.0f));
+				ArmPlayer(Player, EFireMode::Automatic);
+			},
+			[&](FCombatHeadlessWorld& HeadlessWorld, int32 Frame)
+			{
+				// Hold the trigger for the whole run; the magazine is large enough to never reload
+				if (Player && Player->WeaponManager && !Player->WeaponManager->bIsFiring)
+				{
+					Player->WeaponManager->StartFire();
+				}
+			});
+	}
+
+	static FResult RunWeaponSwitching(const FSettings& Settings)
+	{
+		APlayerCharacterController* Player = nullptr;
+
+		return Run(TEXT("WeaponSwitching"), Settings,
+			[&](FCombatHeadlessWorld& HeadlessWorld)
+			{
+				Player = HeadlessWorld.SpawnPlayer(FVector(0.0f, 0.0f, 100.0f));
+				ArmPlayer(Player, EFireMode::Automatic);
+			},
+			[&](FCombatHeadlessWorld& HeadlessWorld, int32 Frame)
+			{
+				if (!Player || !Player->WeaponManager) return;
+
+				for (int32 Switch = 0; Switch < Settings.SwitchesPerFrame; ++Switch)
+				{
+					Player->WeaponManager->EquipWeapon(static_cast<EWeaponSlot>((Frame * Settings.SwitchesPerFrame + Switch) % NumWeaponSlots));
+				}
+			});
+	}
+
+	static FResult RunWallRunTraversal(const FSettings& Settings)
+	{
+		APlayerCharacterController* Player = nullptr;
+		TArray<AActor*> Walls;
+		FRandomStream Random(1337);
+
+		return Run(TEXT("WallRunTraversal"), Settings,
+			[&](FCombatHeadlessWorld& HeadlessWorld)
+			{
+				HeadlessWorld.SpawnWallField(FVector::ZeroVector, Settings.Walls, Walls);
+
+				// Spawned after the walls so its runtime bake picks them up
+				FActorSpawnParameters SpawnParams;
+				HeadlessWorld.GetWorld()->SpawnActor<AWallRunSurfaceIndex>(SpawnParams);
+
+				Player = HeadlessWorld.SpawnPlayer(FVector(0.0f, 0.0f, 100.0f));
+			},
+			[&](FCombatHeadlessWorld& HeadlessWorld, int32 Frame)
+			{
+				// Every 45 frames jump alongside a random wall, the player's tick finds it and starts the run
+				if (!Player || Walls.Num() == 0 || Frame % 45 != 0) return;
+
+				const AActor* Wall = Walls[Random.RandHelper(Walls.Num())];
+				const FVector Start = Wall->GetActorLocation() + FVector(-200.0f, 62.0f, 50.0f);
+
+				Player->GetCharacterMovement()->StopMovementImmediately();
+				Player->SetActorLocation(Start, false, nullptr, ETeleportType::TeleportPhysics);
+				Player->LaunchCharacter(FVector(Player->WalkSpeed * 2.0f, 0.0f, 300.0f), true, true);
+			});
+	}
+
+	struct FScenario
+	{
+		const TCHAR* Name;
+		FResult (*Run)(const FSettings&);
+	};
+
+	static const FScenario Scenarios[] =
+	{
+		{ TEXT("EnemiesFiring"), &RunEnemiesFiring },
+		{ TEXT("SustainedAutoFire"), &RunSustainedAutoFire },
+		{ TEXT("WeaponSwitching"), &RunWeaponSwitching },
+		{ TEXT("WallRunTraversal"), &RunWallRunTraversal },
+	};
+
+	static FString GetDefaultBaselinePath()
+	{
+		return FPaths::ProjectConfigDir() / TEXT("CombatPerfBaseline.json");
+	}
+
+	// Frames and Enemies record what the timings were measured with, so a run with other settings isn't compared against them
+	static TSharedRef<FJsonObject> ScenarioToJson(const FResult& Result, const FSettings& Settings)
+	{
+		TSharedRef<FJsonObject> Scenario = MakeShared<FJsonObject>();
+		Scenario->SetNumberField(TEXT("Frames"), Result.Frames);
+		Scenario->SetNumberField(TEXT("Enemies"), Settings.Enemies);
+		Scenario->SetNumberField(TEXT("MeanMs"), Result.MeanMs);
+		Scenario->SetNumberField(TEXT("P95Ms"), Result.P95Ms);
+		Scenario->SetNumberField(TEXT("MaxMs"), Result.MaxMs);
+		return Scenario;
+	}
+
+	static TSharedRef<FJsonObject> ToJson(const TArray<FResult>& Results, const FSettings& Settings, double TolerancePct)
+	{
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetNumberField(TEXT("TolerancePct"), TolerancePct);
+
+		TSharedRef<FJsonObject> Scenarios = MakeShared<FJsonObject>();
+		for (const FResult& Result : Results)
+		{
+			Scenarios->SetObjectField(Result.Name, ScenarioToJson(Result, Settings));
+		}
+		Root->SetObjectField(TEXT("Scenarios"), Scenarios);
+
+		return Root;
+	}
+
+	// Replaces only the scenarios that ran, so updating one scenario keeps the others and any hand-tuned tolerances
+	static void MergeIntoBaseline(FJsonObject& Baseline, const TArray<FResult>& Results, const FSettings& Settings)
+	{
+		const TSharedPtr<FJsonObject>* ExistingScenarios = nullptr;
+		TSharedPtr<FJsonObject> Scenarios = Baseline.TryGetObjectField(TEXT("Scenarios"), ExistingScenarios) ? *ExistingScenarios : MakeShared<FJsonObject>();
+
+		for (const FResult& Result : Results)
+		{
+			TSharedRef<FJsonObject> Scenario = ScenarioToJson(Result, Settings);
+
+			const TSharedPtr<FJsonObject>* Previous = nullptr;
+			double TolerancePct = 0.0;
+			if (Scenarios->TryGetObjectField(Result.Name, Previous) && (*Previous)->TryGetNumberField(TEXT("TolerancePct"), TolerancePct))
+			{
+				Scenario->SetNumberField(TEXT("TolerancePct"), TolerancePct);
+			}
+
+			Scenarios->SetObjectField(Result.Name, Scenario);
+		}
+
+		Baseline.SetObjectField(TEXT("Scenarios"), Scenarios);
+	}
+
+	static bool SaveJson(const TSharedRef<FJsonObject>& Root, const FString& Path)
+	{
+		FString Json;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		return FJsonSerializer::Serialize(Root, Writer) && FFileHelper::SaveStringToFile(Json, *Path);
+	}
+
+	static TSharedPtr<FJsonObject> LoadJson(const FString& Path)
+	{
+		FString Json;
+		if (!FFileHelper::LoadFileToString(Json, *Path)) return nullptr;
+
+		TSharedPtr<FJsonObject> Root;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+		return FJsonSerializer::Deserialize(Reader, Root) ? Root : nullptr;
+	}
+
+	// Compares mean and p95 with the baseline; max is reported but too noisy to gate on.
+	// A scenario recorded with other settings fails instead of being compared.
+	static int32 CompareWithBaseline(const TArray<FResult>& Results, const FSettings& Settings, const FJsonObject& Baseline)
+	{
+		const double FileTolerancePct = Baseline.HasTypedField<EJson::Number>(TEXT("TolerancePct")) ? Baseline.GetNumberField(TEXT("TolerancePct")) : DefaultTolerancePct;
+
+		const TSharedPtr<FJsonObject>* Scenarios = nullptr;
+		if (!Baseline.TryGetObjectField(TEXT("Scenarios"), Scenarios)) return 0;
+
+		int32 Regressions = 0;
+		for (const FResult& Result : Results)
+		{
+			const TSharedPtr<FJsonObject>* Scenario = nullptr;
+			if (!(*Scenarios)->TryGetObjectField(Result.Name, Scenario))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s has no baseline, run with -updatebaseline to add it."), *Result.Name);
+				continue;
+			}
+
+			int32 BaseFrames = Result.Frames;
+			int32 BaseEnemies = Settings.Enemies;
+			(*Scenario)->TryGetNumberField(TEXT("Frames"), BaseFrames);
+			(*Scenario)->TryGetNumberField(TEXT("Enemies"), BaseEnemies);
+			if (BaseFrames != Result.Frames || BaseEnemies != Settings.Enemies)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s baseline was recorded with %d frames and %d enemies, this run used %d and %d. Run with matching -frames= and -enemies=, or -updatebaseline."),
+					*Result.Name, BaseFrames, BaseEnemies, Result.Frames, Settings.Enemies);
+				Regressions++;
+				continue;
+			}
+
+			double TolerancePct = FileTolerancePct;
+			(*Scenario)->TryGetNumberField(TEXT("TolerancePct"), TolerancePct);
+
+			const double BaseMeanMs = (*Scenario)->GetNumberField(TEXT("MeanMs"));
+			const double BaseP95Ms = (*Scenario)->GetNumberField(TEXT("P95Ms"));
+			const double Limit = 1.0 + TolerancePct / 100.0;
+
+			const bool bRegressed = Result.MeanMs > BaseMeanMs * Limit || Result.P95Ms > BaseP95Ms * Limit;
+			if (bRegressed)
+			{
+				Regressions++;
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("%-18s mean %.3f ms (baseline %.3f), p95 %.3f ms (baseline %.3f), tolerance %.0f%%: %s"),
+				*Result.Name, Result.MeanMs, BaseMeanMs, Result.P95Ms, BaseP95Ms, TolerancePct, bRegressed ? TEXT("REGRESSED") : TEXT("ok"));
+		}
+
+		return Regressions;
+	}
+}
+
+UCombatPerfCommandlet::UCombatPerfCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatPerfCommandlet::Main(const FString& Params)
+{
+	using namespace CombatPerf;
+
+	FSettings Settings;
+	FParse::Value(*Params, TEXT("frames="), Settings.Frames);
+	FParse::Value(*Params, TEXT("enemies="), Settings.Enemies);
+	Settings.Frames = FMath::Max(1, Settings.Frames);
+
+	FString BaselinePath = GetDefaultBaselinePath();
+	FParse::Value(*Params, TEXT("baseline="), BaselinePath);
+
+	FString OnlyScenario;
+	FParse::Value(*Params, TEXT("scenario="), OnlyScenario);
+
+	TArray<FResult> Results;
+	for (const FScenario& Scenario : Scenarios)
+	{
+		if (!OnlyScenario.IsEmpty() && OnlyScenario != Scenario.Name) continue;
+
+		const FResult& Result = Results.Add_GetRef(Scenario.Run(Settings));
+		UE_LOG(LogTemp, Display, TEXT("%-18s %d frames: mean %.3f ms, p95 %.3f ms, max %.3f ms"), *Result.Name, Result.Frames, Result.MeanMs, Result.P95Ms, Result.MaxMs);
+	}
+
+	const TSharedPtr<FJsonObject> Baseline = LoadJson(BaselinePath);
+	const double TolerancePct = Baseline.IsValid() && Baseline->HasTypedField<EJson::Number>(TEXT("TolerancePct")) ? Baseline->GetNumberField(TEXT("TolerancePct")) : DefaultTolerancePct;
+
+	const FString ResultsPath = FPaths::ProfilingDir() / TEXT("CombatPerf") / FString::Printf(TEXT("Results_%s.json"), *FDateTime::Now().ToString());
+	SaveJson(ToJson(Results, Settings, TolerancePct), ResultsPath);
+	UE_LOG(LogTemp, Display, TEXT("Combat perf results written to %s"), *ResultsPath);
+
+	if (FParse::Param(*Params, TEXT("updatebaseline")))
+	{
+		const TSharedRef<FJsonObject> NewBaseline = Baseline.IsValid() ? Baseline.ToSharedRef() : ToJson(TArray<FResult>(), Settings, TolerancePct);
+		MergeIntoBaseline(*NewBaseline, Results, Settings);
+
+		const bool bSaved = SaveJson(NewBaseline, BaselinePath);
+		UE_LOG(LogTemp, Display, TEXT("Baseline %s %s."), *BaselinePath, bSaved ? TEXT("updated") : TEXT("could not be written"));
+		return bSaved ? 0 : 1;
+	}
+
+	// A gate without a baseline would pass everything, so that takes an explicit opt-in
+	if (!Baseline.IsValid())
+	{
+		if (FParse::Param(*Params, TEXT("allowmissingbaseline")))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("No baseline at %s, nothing to compare."), *BaselinePath);
+			return 0;
+		}
+
+		UE_LOG(LogTemp, Error, TEXT("No baseline at %s. Run with -updatebaseline on the reference machine, or pass -allowmissingbaseline."), *BaselinePath);
+		return 1;
+	}
+
+	const int32 Regressions = CompareWithBaseline(Results, *Baseline);
+	if (Regressions > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%d combat scenario(s) regressed or don't match their baseline's settings."), Regressions);
+		return 1;
+	}
+
+	return 0;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// The same scenarios as the commandlet, one automation test each, gated on the same baseline
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FCombatPerfScenarioTest, "CombatSystem.Perf",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FCombatPerfScenarioTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const CombatPerf::FScenario& Scenario : CombatPerf::Scenarios)
+	{
+		OutBeautifiedNames.Add(Scenario.Name);
+		OutTestCommands.Add(Scenario.Name);
+	}
+}
+
+bool FCombatPerfScenarioTest::RunTest(const FString& Parameters)
+{
+	using namespace CombatPerf;
+
+	const FScenario* Scenario = Algo::FindByPredicate(Scenarios, [&Parameters](const FScenario& Candidate) { return Parameters == Candidate.Name; });
+	if (!Scenario)
+	{
+		AddError(FString::Printf(TEXT("Unknown combat perf scenario %s"), *Parameters));
+		return false;
+	}
+
+	TArray<FResult> Results;
+	const FResult& Result = Results.Add_GetRef(Scenario->Run(FSettings()));
+	AddInfo(FString::Printf(TEXT("%s %d frames: mean %.3f ms, p95 %.3f ms, max %.3f ms"), *Result.Name, Result.Frames, Result.MeanMs, Result.P95Ms, Result.MaxMs));
+
+	TestEqual(TEXT("Frames measured"), Result.Frames, FSettings().Frames);
+
+	const FString BaselinePath = GetDefaultBaselinePath();
+	const TSharedPtr<FJsonObject> Baseline = LoadJson(BaselinePath);
+	if (!Baseline.IsValid())
+	{
+		AddError(FString::Printf(TEXT("No baseline at %s. Run -run=CombatPerf -updatebaseline on the reference machine."), *BaselinePath));
+		return false;
+	}
+
+	TestEqual(TEXT("Scenarios regressed against the baseline"), CompareWithBaseline(Results, FSettings(), *Baseline), 0);
+	return true;
+}
+
+#endif
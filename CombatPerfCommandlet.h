@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatPerfCommandlet.generated.h"
+
+/**
+ * Combat performance regression run. Plays fixed scenarios in a headless world, records
+ * game-thread frame time for each and compares it with the checked-in baseline:
+ *
+ *   UnrealEditor-Cmd <Project> -run=CombatPerf -nullrhi -unattended
+ *     [-baseline=<json>] [-updatebaseline] [-allowmissingbaseline] [-scenario=<Name>] [-frames=600] [-enemies=50]
+ *
+ * Scenarios: EnemiesFiring, SustainedAutoFire, WeaponSwitching, WallRunTraversal, also run
+ * as the CombatSystem.Perf automation tests. Returns non-zero when a scenario is slower than
+ * its baseline by more than the tolerance, when its baseline was recorded with other -frames
+ * or -enemies, or when there is no baseline unless -allowmissingbaseline is passed.
+ * Results are written to Saved/Profiling/CombatPerf; -updatebaseline replaces the baseline
+ * entries of the scenarios that ran and keeps the rest.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatPerfCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatPerfCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
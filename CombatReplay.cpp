@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatReplay.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+CombatReplay::FListener* CombatReplay::GListener = nullptr;
+
+int32 CombatReplay::GInputDepth = 0;
+
+const TCHAR* CombatReplay::GetInputName(ECombatReplayInput Input)
+{
+	switch (Input)
+	{
+	case ECombatReplayInput::Move: return TEXT("Move");
+	case ECombatReplayInput::Jump: return TEXT("Jump");
+	case ECombatReplayInput::StopJump: return TEXT("StopJump");
+	case ECombatReplayInput::StartRun: return TEXT("StartRun");
+	case ECombatReplayInput::StopRun: return TEXT("StopRun");
+	case ECombatReplayInput::StartFire: return TEXT("StartFire");
+	case ECombatReplayInput::StopFire: return TEXT("StopFire");
+	case ECombatReplayInput::StartAim: return TEXT("StartAim");
+	case ECombatReplayInput::StopAim: return TEXT("StopAim");
+	case ECombatReplayInput::Reload: return TEXT("Reload");
+	case ECombatReplayInput::SwitchToPrimary1: return TEXT("SwitchToPrimary1");
+	case ECombatReplayInput::SwitchToPrimary2: return TEXT("SwitchToPrimary2");
+	case ECombatReplayInput::SwitchToSecondary: return TEXT("SwitchToSecondary");
+	case ECombatReplayInput::ToggleHolster: return TEXT("ToggleHolster");
+	default: return TEXT("Unknown");
+	}
+}
+
+CombatReplay::FFileWriter::~FFileWriter()
+{
+	delete File;
+}
+
+bool CombatReplay::FFileWriter::Open(const FString& Path, int32 Seed)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+	File = PlatformFile.OpenWrite(*Path);
+	if (!File) return false;
+
+	Header = FFileHeader();
+	Header.Seed = Seed;
+	File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	BytesWritten = sizeof(Header);
+	return true;
+}
+
+void CombatReplay::FFileWriter::WriteChunk(uint32 Kind, uint32 FirstFrame, uint32 FrameCount, const TArray<uint8>& Payload)
+{
+	if (!File) return;
+
+	FChunkHeader Chunk;
+	Chunk.Kind = Kind;
+	Chunk.Size = Payload.Num();
+	Chunk.FirstFrame = FirstFrame;
+	Chunk.FrameCount = FrameCount;
+
+	File->Write(reinterpret_cast<const uint8*>(&Chunk), sizeof(Chunk));
+	File->Write(Payload.GetData(), Payload.Num());
+	BytesWritten += sizeof(Chunk) + Payload.Num();
+}
+
+void CombatReplay::FFileWriter::Close(uint32 FrameCount, double RecordedSeconds)
+{
+	if (!File) return;
+
+	Header.FrameCount = FrameCount;
+	Header.RecordedSeconds = RecordedSeconds;
+	File->Seek(0);
+	File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+	delete File;
+	File = nullptr;
+}
+
+CombatReplay::FFileReader::~FFileReader()
+{
+	// The region has to go before the file it maps
+	Region.Reset();
+	File.Reset();
+}
+
+bool CombatReplay::FFileReader::Open(const FString& Path)
+{
+	File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!File || File->GetFileSize() < int64(sizeof(FFileHeader))) return false;
+
+	Region.Reset(File->MapRegion(0, sizeof(FFileHeader)));
+	if (!Region) return false;
+
+	FMemory::Memcpy(&Header, Region->GetMappedPtr(), sizeof(Header));
+	Region.Reset();
+
+	Rewind();
+	return Header.Magic == FileMagic && Header.Version == FileVersion;
+}
+
+bool CombatReplay::FFileReader::NextChunk(FChunkHeader& OutChunk, TArrayView<const uint8>& OutPayload)
+{
+	Region.Reset();
+	if (!File || Offset + int64(sizeof(FChunkHeader)) > File->GetFileSize()) return false;
+
+	// The chunk header says how much to map
+	{
+		TUniquePtr<IMappedFileRegion> ChunkHeaderRegion(File->MapRegion(Offset, sizeof(FChunkHeader)));
+		if (!ChunkHeaderRegion) return false;
+		FMemory::Memcpy(&OutChunk, ChunkHeaderRegion->GetMappedPtr(), sizeof(OutChunk));
+	}
+
+	// A chunk cut short by a crash mid-write ends the file
+	const int64 ChunkSize = int64(sizeof(FChunkHeader)) + OutChunk.Size;
+	if (Offset + ChunkSize > File->GetFileSize()) return false;
+
+	Region.Reset(File->MapRegion(Offset, ChunkSize));
+	if (!Region) return false;
+
+	OutPayload = TArrayView<const uint8>(Region->GetMappedPtr() + sizeof(FChunkHeader), OutChunk.Size);
+	Offset += ChunkSize;
+	return true;
+}
+
+void CombatReplay::FFileReader::Rewind()
+{
+	Region.Reset();
+	Offset = sizeof(FFileHeader);
+}
@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WeaponManagerComponent.h"
+
+class AActor;
+class APlayerCharacterController;
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Player input as the handlers on APlayerCharacterController receive it. Look is not an input
+// here: the control rotation it produces is recorded per frame instead.
+enum class ECombatReplayInput : uint8
+{
+	Move,
+	Jump,
+	StopJump,
+	StartRun,
+	StopRun,
+	StartFire,
+	StopFire,
+	StartAim,
+	StopAim,
+	Reload,
+	SwitchToPrimary1,
+	SwitchToPrimary2,
+	SwitchToSecondary,
+	ToggleHolster,
+	Num
+};
+
+// Events inside a frame, in the order they happened
+enum class ECombatReplayEvent : uint8
+{
+	// Input, then for Move the axis and the control yaw it was applied with
+	Input,
+	// Full FCombatReplayEnemy record
+	EnemySpawned,
+	// Enemy index; destroyed or unregistered for any reason other than dying in play
+	EnemyRemoved,
+	// Enemy index and its AI's aim state
+	EnemyAim,
+	// Enemy index, location and rotation, when its AI moved it
+	EnemyMoved,
+	// Target index (0 is the player), amount, shield and health after the hit. Only checked on playback.
+	Damage,
+	// Start and end of the player's aim ray for a fire batch, which depends on the viewport
+	Aim
+};
+
+// Serialized per-actor records. Single precision, like the combat snapshots.
+struct FCombatReplayGeometry
+{
+	FString MeshPath;
+	FVector3f Location = FVector3f::ZeroVector;
+	FRotator3f Rotation = FRotator3f::ZeroRotator;
+	FVector3f Scale = FVector3f::OneVector;
+	TArray<FName> Tags;
+
+	friend FArchive& operator<<(FArchive& Ar, FCombatReplayGeometry& Record)
+	{
+		return Ar << Record.MeshPath << Record.Location << Record.Rotation << Record.Scale << Record.Tags;
+	}
+};
+
+struct FCombatReplayWeapon
+{
+	// Definition asset; transient definitions are rebuilt from the values below
+	FString DefinitionPath;
+	FName WeaponName;
+	uint8 FireMode = 0;
+	float FireRate = 0.0f;
+	int32 AmmoPerMag = 0;
+	float DamagePerBullet = 0.0f;
+	int32 CurrentAmmo = 0;
+	int32 Magazines = 0;
+	int32 TempAmmoPool = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FCombatReplayWeapon& Record)
+	{
+		return Ar << Record.DefinitionPath << Record.WeaponName << Record.FireMode << Record.FireRate << Record.AmmoPerMag
+			<< Record.DamagePerBullet << Record.CurrentAmmo << Record.Magazines << Record.TempAmmoPool;
+	}
+};
+
+struct FCombatReplayPlayer
+{
+	FString ClassPath;
+	FVector3f Location = FVector3f::ZeroVector;
+	FRotator3f Rotation = FRotator3f::ZeroRotator;
+	FRotator3f ControlRotation = FRotator3f::ZeroRotator;
+	float Shield = 0.0f;
+	float MaxShield = 0.0f;
+	float Health = 0.0f;
+	float MaxHealth = 0.0f;
+	uint8 CurrentSlot = static_cast<uint8>(EWeaponSlot::None);
+	FCombatReplayWeapon Weapons[NumWeaponSlots];
+
+	friend FArchive& operator<<(FArchive& Ar, FCombatReplayPlayer& Record)
+	{
+		Ar << Record.ClassPath << Record.Location << Record.Rotation << Record.ControlRotation
+			<< Record.Shield << Record.MaxShield << Record.Health << Record.MaxHealth << Record.CurrentSlot;
+		for (FCombatReplayWeapon& Weapon : Record.Weapons)
+		{
+			Ar << Weapon;
+		}
+		return Ar;
+	}
+};
+
+struct FCombatReplayEnemy
+{
+	uint16 Index = 0;
+	FString ClassPath;
+	FString WeaponClassPath;
+	FVector3f Location = FVector3f::ZeroVector;
+	FRotator3f Rotation = FRotator3f::ZeroRotator;
+	TArray<FName> Tags;
+	float Shield = 0.0f;
+	float MaxShield = 0.0f;
+	float Health = 0.0f;
+	float MaxHealth = 0.0f;
+	bool bAiming = false;
+
+	friend FArchive& operator<<(FArchive& Ar, FCombatReplayEnemy& Record)
+	{
+		return Ar << Record.Index << Record.ClassPath << Record.WeaponClassPath << Record.Location << Record.Rotation << Record.Tags
+			<< Record.Shield << Record.MaxShield << Record.Health << Record.MaxHealth << Record.bAiming;
+	}
+};
+
+// Everything in the world at the start of the recording that playback has to rebuild
+struct FCombatReplayScene
+{
+	FString MapName;
+	TArray<FCombatReplayGeometry> Geometry;
+	FCombatReplayPlayer Player;
+	TArray<FCombatReplayEnemy> Enemies;
+
+	friend FArchive& operator<<(FArchive& Ar, FCombatReplayScene& Scene)
+	{
+		return Ar << Scene.MapName << Scene.Geometry << Scene.Player << Scene.Enemies;
+	}
+};
+
+/**
+ * Combat replay files: a header, then chunks. The scene chunk comes first, frame chunks hold
+ * a run of frames each: delta seconds, control rotation, player location (to measure drift
+ * on playback) and that frame's events. Recording appends a chunk every few hundred frames,
+ * playback maps one chunk at a time, so neither holds a whole session in memory.
+ */
+namespace CombatReplay
+{
+	static constexpr uint32 FileMagic = 0x4C505243; // "CRPL"
+
+	static constexpr uint32 FileVersion = 1;
+
+	static constexpr uint32 SceneChunk = 0x454E4353; // "SCNE"
+
+	static constexpr uint32 FramesChunk = 0x534D5246; // "FRMS"
+
+	struct FFileHeader
+	{
+		uint32 Magic = FileMagic;
+
+		uint32 Version = FileVersion;
+
+		// FMath::RandInit/SRandInit seed for the session, playback seeds the same
+		int32 Seed = 0;
+
+		// Written when the recording stops; 0 in a file whose recording never stopped
+		uint32 FrameCount = 0;
+
+		double RecordedSeconds = 0.0;
+	};
+
+	struct FChunkHeader
+	{
+		uint32 Kind = 0;
+
+		// Payload bytes after this header
+		uint32 Size = 0;
+
+		uint32 FirstFrame = 0;
+
+		uint32 FrameCount = 0;
+	};
+
+	// Receives the hooked gameplay calls while a recording or a playback is active. Game thread only.
+	class FListener
+	{
+	public:
+
+		virtual ~FListener() = default;
+
+		virtual void OnInput(const APlayerCharacterController* Player, ECombatReplayInput Input, const FVector2D& Value = FVector2D::ZeroVector) {}
+
+		virtual void OnDamage(const AActor* Target, float Amount, float ShieldPool, float HealthPool) {}
+
+		// Recording stores the ray, playback replaces it with the recorded one
+		virtual void OnAim(const AActor* Shooter, FVector& Start, FVector& End) {}
+	};
+
+	extern COMBATSYSTEM_API FListener* GListener;
+
+	// Input handlers currently running; handlers call each other (a weapon switch stops firing)
+	extern COMBATSYSTEM_API int32 GInputDepth;
+
+	// Reports the outermost input handler only, so nested calls replay as part of their caller
+	struct FInputScope
+	{
+		FInputScope(const APlayerCharacterController* Player, ECombatReplayInput Input, const FVector2D& Value = FVector2D::ZeroVector)
+		{
+			if (GInputDepth++ == 0 && GListener)
+			{
+				GListener->OnInput(Player, Input, Value);
+			}
+		}
+
+		~FInputScope()
+		{
+			--GInputDepth;
+		}
+	};
+
+	COMBATSYSTEM_API const TCHAR* GetInputName(ECombatReplayInput Input);
+
+	// Appends chunks to a replay file and patches the header when it is closed
+	class COMBATSYSTEM_API FFileWriter : public FNoncopyable
+	{
+	public:
+
+		~FFileWriter();
+
+		bool Open(const FString& Path, int32 Seed);
+
+		void WriteChunk(uint32 Kind, uint32 FirstFrame, uint32 FrameCount, const TArray<uint8>& Payload);
+
+		void Close(uint32 FrameCount, double RecordedSeconds);
+
+		bool IsOpen() const { return File != nullptr; }
+
+		int64 GetBytesWritten() const { return BytesWritten; }
+
+	private:
+
+		IFileHandle* File = nullptr;
+
+		FFileHeader Header;
+
+		int64 BytesWritten = 0;
+	};
+
+	// Walks the chunks of a replay file through a memory mapping of one chunk at a time
+	class COMBATSYSTEM_API FFileReader : public FNoncopyable
+	{
+	public:
+
+		~FFileReader();
+
+		bool Open(const FString& Path);
+
+		const FFileHeader& GetHeader() const { return Header; }
+
+		// The next chunk's header and payload; the payload stays mapped until the next call
+		bool NextChunk(FChunkHeader& OutChunk, TArrayView<const uint8>& OutPayload);
+
+		// Back to the first chunk
+		void Rewind();
+
+	private:
+
+		TUniquePtr<IMappedFileHandle> File;
+
+		TUniquePtr<IMappedFileRegion> Region;
+
+		FFileHeader Header;
+
+		int64 Offset = 0;
+	};
+}
+
+// First statement of an input handler, before it decides whether to act on the input
+#define COMBAT_REPLAY_INPUT(Player, Input, ...) \
+	const CombatReplay::FInputScope ReplayInputScope(Player, ECombatReplayInput::Input, ##__VA_ARGS__)
+
+#define COMBAT_REPLAY_DAMAGE(Target, Amount, ShieldPool, HealthPool) \
+	do { if (CombatReplay::GListener) { CombatReplay::GListener->OnDamage(Target, Amount, ShieldPool, HealthPool); } } while (0)
+
+#define COMBAT_REPLAY_AIM(Shooter, Start, End) \
+	do { if (CombatReplay::GListener) { CombatReplay::GListener->OnAim(Shooter, Start, End); } } while (0)
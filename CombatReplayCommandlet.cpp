@@ -0,0 +1,625 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatReplayCommandlet.h"
+#include "CombatReplay.h"
+#include "CombatHeadlessWorld.h"
+#include "CombatSimulationSubsystem.h"
+#include "EnemyBase.h"
+#include "PlayerCharacterController.h"
+#include "WeaponActor.h"
+#include "AIController.h"
+#include "InputActionValue.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+namespace CombatReplayPlayback
+{
+	// Damage within this of the recording counts as the same event
+	static constexpr float DamageTolerance = 0.01f;
+
+	// -verify fails a playback whose player ends up further than this from its recorded path
+	static constexpr float DriftTolerance = 50.0f;
+
+	static constexpr int32 WorstFrameCount = 10;
+
+	struct FDamage
+	{
+		uint16 Index = 0;
+		float Amount = 0.0f;
+		float Shield = 0.0f;
+		float Health = 0.0f;
+	};
+
+	struct FFrameResult
+	{
+		uint32 Frame = 0;
+		double Seconds = 0.0;
+		double FrameMs = 0.0;
+		float DriftCm = 0.0f;
+		int32 DamageEvents = 0;
+	};
+
+	// Feeds the recorded aim rays to the weapons and checks damage against the recording
+	class FPlaybackListener : public CombatReplay::FListener
+	{
+	public:
+
+		TMap<const AActor*, uint16> Indices;
+
+		const AActor* Player = nullptr;
+
+		TArray<FDamage> ExpectedDamage;
+
+		TArray<TPair<FVector, FVector>> AimRays;
+
+		int32 Matched = 0;
+
+		int32 Mismatched = 0;
+
+		// Recorded but not dealt on playback, and dealt on playback but not recorded
+		int32 Missing = 0;
+
+		int32 Unexpected = 0;
+
+		int64 FirstDivergentFrame = INDEX_NONE;
+
+		uint32 CurrentFrame = 0;
+
+		void BeginFrame(uint32 Frame)
+		{
+			CurrentFrame = Frame;
+			ExpectedDamage.Reset();
+			AimRays.Reset();
+			NextDamage = 0;
+			NextAim = 0;
+		}
+
+		void EndFrame()
+		{
+			const int32 FrameMissing = ExpectedDamage.Num() - NextDamage;
+			if (FrameMissing > 0)
+			{
+				Missing += FrameMissing;
+				Diverged();
+			}
+		}
+
+		virtual void OnDamage(const AActor* Target, float Amount, float ShieldPool, float HealthPool) override
+		{
+			const uint16* Index = Indices.Find(Target);
+			if (!Index) return;
+
+			if (NextDamage >= ExpectedDamage.Num())
+			{
+				Unexpected++;
+				Diverged();
+				return;
+			}
+
+			const FDamage& Expected = ExpectedDamage[NextDamage++];
+			if (Expected.Index == *Index && FMath::IsNearlyEqual(Expected.Amount, Amount, DamageTolerance)
+				&& FMath::IsNearlyEqual(Expected.Shield, ShieldPool, DamageTolerance) && FMath::IsNearlyEqual(Expected.Health, HealthPool, DamageTolerance))
+			{
+				Matched++;
+			}
+			else
+			{
+				Mismatched++;
+				Diverged();
+			}
+		}
+
+		virtual void OnAim(const AActor* Shooter, FVector& Start, FVector& End) override
+		{
+			if (Shooter != Player || NextAim >= AimRays.Num()) return;
+
+			Start = AimRays[NextAim].Key;
+			End = AimRays[NextAim].Value;
+			NextAim++;
+		}
+
+		bool HasDiverged() const { return FirstDivergentFrame != INDEX_NONE; }
+
+	private:
+
+		void Diverged()
+		{
+			if (FirstDivergentFrame == INDEX_NONE)
+			{
+				FirstDivergentFrame = CurrentFrame;
+			}
+		}
+
+		int32 NextDamage = 0;
+
+		int32 NextAim = 0;
+	};
+
+	template<typename ObjectType>
+	static ObjectType* LoadOrNull(const FString& Path)
+	{
+		return Path.IsEmpty() ? nullptr : LoadObject<ObjectType>(nullptr, *Path, nullptr, LOAD_NoWarn | LOAD_Quiet);
+	}
+
+	static void SpawnGeometry(UWorld* World, const TArray<FCombatReplayGeometry>& Geometry)
+	{
+		TMap<FString, UStaticMesh*> Meshes;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		for (const FCombatReplayGeometry& Record : Geometry)
+		{
+			UStaticMesh*& Mesh = Meshes.FindOrAdd(Record.MeshPath);
+			if (!Mesh)
+			{
+				Mesh = LoadOrNull<UStaticMesh>(Record.MeshPath);
+			}
+			if (!Mesh) continue;
+
+			AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(FVector(Record.Location), FRotator(Record.Rotation), SpawnParams);
+			if (!Actor) continue;
+
+			Actor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+			Actor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+			Actor->SetActorScale3D(FVector(Record.Scale));
+			Actor->Tags = Record.Tags;
+		}
+	}
+
+	static APlayerCharacterController* SpawnPlayer(FCombatHeadlessWorld& HeadlessWorld, const FCombatReplayPlayer& Record)
+	{
+		APlayerCharacterController* Player = HeadlessWorld.SpawnPlayer(FVector(Record.Location), LoadOrNull<UClass>(Record.ClassPath));
+		if (!Player) return nullptr;
+
+		Player->SetActorRotation(FRotator(Record.Rotation));
+
+		// The AI controller would otherwise turn the control rotation back to the pawn's every tick
+		if (AAIController* Controller = Cast<AAIController>(Player->GetController()))
+		{
+			Controller->bSetControlRotationFromPawnOrientation = false;
+			Controller->SetControlRotation(FRotator(Record.ControlRotation));
+		}
+
+		Player->MaxShieldPool = Record.MaxShield;
+		Player->MaxHealthPool = Record.MaxHealth;
+		Player->RestoreCombatState(Record.Shield, Record.Health);
+
+		if (UWeaponManagerComponent* WeaponManager = Player->WeaponManager)
+		{
+			for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
+			{
+				const FCombatReplayWeapon& Weapon = Record.Weapons[SlotIndex];
+				if (Weapon.WeaponName.IsNone()) continue;
+
+				// Transient definitions from headless runs have no asset to load
+				UWeaponDefinition* Definition = LoadOrNull<UWeaponDefinition>(Weapon.DefinitionPath);
+				if (!Definition)
+				{
+					Definition = FCombatHeadlessWorld::CreateTransientWeapon(Weapon.WeaponName, static_cast<EFireMode>(Weapon.FireMode), Weapon.FireRate, Weapon.AmmoPerMag);
+					Definition->DamagePerBullet = Weapon.DamagePerBullet;
+				}
+
+				const EWeaponSlot Slot = static_cast<EWeaponSlot>(SlotIndex);
+				WeaponManager->InitializeSlot(Slot, Definition);
+				WeaponManager->RestoreSlotAmmo(Slot, Weapon.CurrentAmmo, Weapon.Magazines, Weapon.TempAmmoPool);
+			}
+
+			if (Record.CurrentSlot < NumWeaponSlots)
+			{
+				WeaponManager->EquipWeapon(static_cast<EWeaponSlot>(Record.CurrentSlot));
+			}
+		}
+
+		return Player;
+	}
+
+	// Enemies are puppets on playback: no AI controller, the recording says when they aim and where they move
+	static AEnemyBase* SpawnEnemy(UWorld* World, const FCombatReplayEnemy& Record, APawn* Player)
+	{
+		UClass* EnemyClass = LoadOrNull<UClass>(Record.ClassPath);
+		if (!EnemyClass || !EnemyClass->IsChildOf(AEnemyBase::StaticClass()))
+		{
+			EnemyClass = AEnemyBase::StaticClass();
+		}
+
+		const FTransform SpawnTransform(FRotator(Record.Rotation), FVector(Record.Location));
+		AEnemyBase* Enemy = World->SpawnActorDeferred<AEnemyBase>(EnemyClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		if (!Enemy) return nullptr;
+
+		Enemy->AutoPossessAI = EAutoPossessAI::Disabled;
+		if (UClass* WeaponClass = LoadOrNull<UClass>(Record.WeaponClassPath))
+		{
+			Enemy->WeaponBlueprint = WeaponClass;
+		}
+		if (!Enemy->WeaponBlueprint)
+		{
+			Enemy->WeaponBlueprint = AWeaponActor::StaticClass();
+		}
+		Enemy->Tags = Record.Tags;
+		Enemy->FinishSpawning(SpawnTransform);
+
+		Enemy->MaxShieldPool = Record.MaxShield;
+		Enemy->MaxHealthPool = Record.MaxHealth;
+		Enemy->RestoreCombatState(Record.Shield, Record.Health);
+
+		// Skip the startup deferral, like FCombatHeadlessWorld::ArmEnemy
+		Enemy->SpawnEnemyWeapon();
+		Enemy->PlayerPawn = Player;
+		Enemy->bIsEnemyAimingWeapon = Record.bAiming;
+		Enemy->SetEnemyAiming();
+		return Enemy;
+	}
+
+	static void ApplyInput(APlayerCharacterController* Player, ECombatReplayInput Input, const FVector2D& Axis)
+	{
+		switch (Input)
+		{
+		case ECombatReplayInput::Move: Player->Move(FInputActionValue(Axis)); break;
+		case ECombatReplayInput::Jump: Player->HandleJump(); break;
+		case ECombatReplayInput::StopJump: Player->StopJumping(); break;
+		case ECombatReplayInput::StartRun: Player->StartRunning(); break;
+		case ECombatReplayInput::StopRun: Player->StopRunning(); break;
+		case ECombatReplayInput::StartFire: Player->StartFiring(); break;
+		case ECombatReplayInput::StopFire: Player->StopFiring(); break;
+		case ECombatReplayInput::StartAim: Player->StartAiming(); break;
+		case ECombatReplayInput::StopAim: Player->StopAiming(); break;
+		case ECombatReplayInput::Reload: Player->Reloading(); break;
+		case ECombatReplayInput::SwitchToPrimary1: Player->StartSwitchToPrimary1(); break;
+		case ECombatReplayInput::SwitchToPrimary2: Player->StartSwitchToPrimary2(); break;
+		case ECombatReplayInput::SwitchToSecondary: Player->StartSwitchToSecondary(); break;
+		case ECombatReplayInput::ToggleHolster: Player->StartHolsterWeapon(); break;
+		default: break;
+		}
+	}
+
+	static double Percentile(const TArray<double>& Sorted, double Pct)
+	{
+		if (Sorted.Num() == 0) return 0.0;
+		return Sorted[FMath::Min(Sorted.Num() - 1, FMath::FloorToInt32(Sorted.Num() * Pct / 100.0))];
+	}
+}
+
+UCombatReplayCommandlet::UCombatReplayCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatReplayCommandlet::Main(const FString& Params)
+{
+	using namespace CombatReplayPlayback;
+
+	FString InPath;
+	if (!FParse::Value(*Params, TEXT("in="), InPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=CombatReplay -in=<file.crpl> [-speed=1] [-fast] [-verify] [-csv]"));
+		return 1;
+	}
+
+	CombatReplay::FFileReader Reader;
+	if (!Reader.Open(InPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a version %u combat replay"), *InPath, CombatReplay::FileVersion);
+		return 1;
+	}
+
+	CombatReplay::FChunkHeader Chunk;
+	TArrayView<const uint8> Payload;
+	if (!Reader.NextChunk(Chunk, Payload) || Chunk.Kind != CombatReplay::SceneChunk)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s has no scene to play back"), *InPath);
+		return 1;
+	}
+
+	FCombatReplayScene Scene;
+	{
+		FMemoryReaderView SceneReader(Payload);
+		SceneReader << Scene;
+		if (SceneReader.IsError())
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s has a corrupt scene"), *InPath);
+			return 1;
+		}
+	}
+
+	if (CombatReplay::GListener)
+	{
+		UE_LOG(LogTemp, Error, TEXT("A combat replay is already recording, cannot play one back"));
+		return 1;
+	}
+
+	const bool bFast = FParse::Param(*Params, TEXT("fast"));
+	const bool bVerify = FParse::Param(*Params, TEXT("verify"));
+	const bool bCsv = FParse::Param(*Params, TEXT("csv"));
+
+	float Speed = 1.0f;
+	FParse::Value(*Params, TEXT("speed="), Speed);
+	Speed = FMath::Max(Speed, 0.01f);
+
+	const CombatReplay::FFileHeader& Header = Reader.GetHeader();
+	UE_LOG(LogTemp, Display, TEXT("Playing back %s: %s, %u frames, %.1f s, seed %d, %s"),
+		*InPath, *Scene.MapName, Header.FrameCount, Header.RecordedSeconds, Header.Seed,
+		bFast ? TEXT("unpaced") : *FString::Printf(TEXT("%.2fx real time"), Speed));
+
+	FCombatHeadlessWorld HeadlessWorld;
+	UWorld* World = HeadlessWorld.GetWorld();
+
+	if (UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(World))
+	{
+		Simulation->SetSeed(Header.Seed);
+	}
+
+	SpawnGeometry(World, Scene.Geometry);
+
+	APlayerCharacterController* Player = SpawnPlayer(HeadlessWorld, Scene.Player);
+	if (!Player)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to spawn the player"));
+		return 1;
+	}
+	AController* Controller = Player->GetController();
+
+	FPlaybackListener Listener;
+	Listener.Player = Player;
+	Listener.Indices.Add(Player, 0);
+
+	TMap<uint16, TWeakObjectPtr<AEnemyBase>> Enemies;
+	auto AddEnemy = [&](const FCombatReplayEnemy& Record)
+	{
+		if (AEnemyBase* Enemy = SpawnEnemy(World, Record, Player))
+		{
+			Enemies.Add(Record.Index, Enemy);
+			Listener.Indices.Add(Enemy, Record.Index);
+		}
+	};
+
+	for (const FCombatReplayEnemy& Record : Scene.Enemies)
+	{
+		AddEnemy(Record);
+	}
+
+	CombatReplay::GListener = &Listener;
+
+	TArray<FFrameResult> Frames;
+	Frames.Reserve(Header.FrameCount);
+
+	const double StartWallSeconds = FPlatformTime::Seconds();
+	double SimulatedSeconds = 0.0;
+	float MaxDriftCm = 0.0f;
+	bool bCorrupt = false;
+
+	// The frame's inputs and enemy changes, in recorded order
+	TArray<TFunction<void()>> Actions;
+
+	while (!bCorrupt && Reader.NextChunk(Chunk, Payload))
+	{
+		if (Chunk.Kind != CombatReplay::FramesChunk) continue;
+
+		FMemoryReaderView Ar(Payload);
+		for (uint32 ChunkFrame = 0; ChunkFrame < Chunk.FrameCount; ++ChunkFrame)
+		{
+			const uint32 Frame = Chunk.FirstFrame + ChunkFrame;
+
+			float Delta = 0.0f;
+			FRotator3f ControlRotation;
+			FVector3f RecordedLocation;
+			uint16 EventCount = 0;
+			Ar << Delta << ControlRotation << RecordedLocation << EventCount;
+
+			const double FrameStart = FPlatformTime::Seconds();
+
+			Listener.BeginFrame(Frame);
+			if (Controller)
+			{
+				Controller->SetControlRotation(FRotator(ControlRotation));
+			}
+
+			// Parsed in full before anything is applied: a recorded input's own aim and damage events
+			// follow it in the frame, and the listener needs them queued by the time the input fires
+			Actions.Reset();
+			int32 DamageEvents = 0;
+			for (uint16 EventIndex = 0; EventIndex < EventCount && !Ar.IsError(); ++EventIndex)
+			{
+				uint8 Kind = 0;
+				Ar << Kind;
+
+				switch (static_cast<ECombatReplayEvent>(Kind))
+				{
+				case ECombatReplayEvent::Input:
+				{
+					uint8 Input = 0;
+					Ar << Input;
+
+					FVector2f Axis = FVector2f::ZeroVector;
+					if (static_cast<ECombatReplayInput>(Input) == ECombatReplayInput::Move)
+					{
+						float Yaw = 0.0f;
+						Ar << Axis << Yaw;
+
+						// Move with the yaw it was recorded with, the frame's rotation is put back after the inputs
+						Actions.Add([&, ControlRotation, Yaw]()
+						{
+							if (Controller)
+							{
+								Controller->SetControlRotation(FRotator(ControlRotation.Pitch, Yaw, ControlRotation.Roll));
+							}
+						});
+					}
+
+					Actions.Add([&, Input, Axis]() { ApplyInput(Player, static_cast<ECombatReplayInput>(Input), FVector2D(Axis)); });
+					break;
+				}
+				case ECombatReplayEvent::EnemySpawned:
+				{
+					FCombatReplayEnemy Record;
+					Ar << Record;
+					Actions.Add([&, Record]() { AddEnemy(Record); });
+					break;
+				}
+				case ECombatReplayEvent::EnemyRemoved:
+				{
+					uint16 Index = 0;
+					Ar << Index;
+					Actions.Add([&, Index]()
+					{
+						if (AEnemyBase* Enemy = Enemies.FindRef(Index).Get())
+						{
+							if (Enemy->SpawnedWeapon)
+							{
+								Enemy->SpawnedWeapon->Destroy();
+							}
+							Enemy->Destroy();
+						}
+					});
+					break;
+				}
+				case ECombatReplayEvent::EnemyAim:
+				{
+					uint16 Index = 0;
+					bool bAiming = false;
+					Ar << Index << bAiming;
+					Actions.Add([&, Index, bAiming]()
+					{
+						if (AEnemyBase* Enemy = Enemies.FindRef(Index).Get())
+						{
+							Enemy->bIsEnemyAimingWeapon = bAiming;
+						}
+					});
+					break;
+				}
+				case ECombatReplayEvent::EnemyMoved:
+				{
+					uint16 Index = 0;
+					FVector3f Location;
+					FRotator3f Rotation;
+					Ar << Index << Location << Rotation;
+					Actions.Add([&, Index, Location, Rotation]()
+					{
+						if (AEnemyBase* Enemy = Enemies.FindRef(Index).Get())
+						{
+							Enemy->SetActorLocationAndRotation(FVector(Location), FRotator(Rotation), false, nullptr, ETeleportType::TeleportPhysics);
+						}
+					});
+					break;
+				}
+				case ECombatReplayEvent::Damage:
+				{
+					FDamage Damage;
+					Ar << Damage.Index << Damage.Amount << Damage.Shield << Damage.Health;
+					Listener.ExpectedDamage.Add(Damage);
+					DamageEvents++;
+					break;
+				}
+				case ECombatReplayEvent::Aim:
+				{
+					FVector3f AimStart;
+					FVector3f AimEnd;
+					Ar << AimStart << AimEnd;
+					Listener.AimRays.Emplace(FVector(AimStart), FVector(AimEnd));
+					break;
+				}
+				default:
+					Ar.SetError();
+					break;
+				}
+			}
+
+			if (Ar.IsError())
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Corrupt event data in frame %u, stopping the playback there"), Frame);
+				bCorrupt = true;
+				break;
+			}
+
+			for (const TFunction<void()>& Action : Actions)
+			{
+				Action();
+			}
+
+			if (Controller)
+			{
+				Controller->SetControlRotation(FRotator(ControlRotation));
+			}
+
+			HeadlessWorld.Tick(Delta);
+			Listener.EndFrame();
+
+			FFrameResult& Result = Frames.AddDefaulted_GetRef();
+			Result.Frame = Frame;
+			Result.Seconds = SimulatedSeconds;
+			Result.FrameMs = (FPlatformTime::Seconds() - FrameStart) * 1000.0;
+			Result.DriftCm = static_cast<float>(FVector::Dist(Player->GetActorLocation(), FVector(RecordedLocation)));
+			Result.DamageEvents = DamageEvents;
+			MaxDriftCm = FMath::Max(MaxDriftCm, Result.DriftCm);
+
+			SimulatedSeconds += Delta;
+
+			// Paced against the whole session rather than per frame, so short sleeps do not add up
+			if (!bFast)
+			{
+				const double AheadSeconds = StartWallSeconds + SimulatedSeconds / Speed - FPlatformTime::Seconds();
+				if (AheadSeconds > 0.0)
+				{
+					FPlatformProcess::Sleep(static_cast<float>(AheadSeconds));
+				}
+			}
+		}
+	}
+
+	CombatReplay::GListener = nullptr;
+
+	const double WallSeconds = FPlatformTime::Seconds() - StartWallSeconds;
+
+	TArray<double> FrameTimes;
+	FrameTimes.Reserve(Frames.Num());
+	for (const FFrameResult& Result : Frames)
+	{
+		FrameTimes.Add(Result.FrameMs);
+	}
+	FrameTimes.Sort();
+
+	UE_LOG(LogTemp, Display, TEXT("Played %d frames, %.1f s of combat in %.1f s (%.1fx real time)"),
+		Frames.Num(), SimulatedSeconds, WallSeconds, WallSeconds > 0.0 ? SimulatedSeconds / WallSeconds : 0.0);
+	UE_LOG(LogTemp, Display, TEXT("Frame ms: p50 %.3f, p95 %.3f, p99 %.3f, max %.3f"),
+		Percentile(FrameTimes, 50.0), Percentile(FrameTimes, 95.0), Percentile(FrameTimes, 99.0), FrameTimes.Num() > 0 ? FrameTimes.Last() : 0.0);
+
+	TArray<FFrameResult> WorstFrames = Frames;
+	WorstFrames.Sort([](const FFrameResult& A, const FFrameResult& B) { return A.FrameMs > B.FrameMs; });
+	for (int32 Index = 0; Index < FMath::Min(WorstFrameCount, WorstFrames.Num()); ++Index)
+	{
+		const FFrameResult& Result = WorstFrames[Index];
+		UE_LOG(LogTemp, Display, TEXT("  frame %6u at %8.2f s: %8.3f ms, %d damage events"), Result.Frame, Result.Seconds, Result.FrameMs, Result.DamageEvents);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Damage events: %d matched, %d different, %d missing, %d unexpected. Player drift up to %.1f cm."),
+		Listener.Matched, Listener.Mismatched, Listener.Missing, Listener.Unexpected, MaxDriftCm);
+	if (Listener.HasDiverged())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Playback diverged from the recording at frame %lld"), Listener.FirstDivergentFrame);
+	}
+
+	if (bCsv)
+	{
+		FString Report = TEXT("Frame,Seconds,FrameMs,DriftCm,DamageEvents\n");
+		for (const FFrameResult& Result : Frames)
+		{
+			Report += FString::Printf(TEXT("%u,%.4f,%.3f,%.2f,%d\n"), Result.Frame, Result.Seconds, Result.FrameMs, Result.DriftCm, Result.DamageEvents);
+		}
+
+		const FString ReportPath = FPaths::ProfilingDir() / TEXT("CombatReplay") / FString::Printf(TEXT("%s_%s.csv"), *FPaths::GetBaseFilename(InPath), *FDateTime::Now().ToString());
+		FFileHelper::SaveStringToFile(Report, *ReportPath);
+		UE_LOG(LogTemp, Display, TEXT("Per-frame playback written to %s"), *ReportPath);
+	}
+
+	if (bCorrupt) return 1;
+	return bVerify && (Listener.HasDiverged() || MaxDriftCm > DriftTolerance) ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatReplayCommandlet.generated.h"
+
+/**
+ * Plays a combat replay (recorded with Combat.Replay.Record or -CombatReplay) back in a
+ * headless world, so a firefight that spiked can be profiled and re-checked on demand:
+ *
+ *   UnrealEditor-Cmd <Project> -run=CombatReplay -nullrhi -unattended -in=<file.crpl>
+ *     [-speed=1] [-fast] [-verify] [-csv]
+ *
+ * Frames are re-simulated with their recorded delta times, paced to real time or -speed
+ * times it; -fast does not pace at all, for bulk analysis. Frame time percentiles and the
+ * worst frames are logged, -csv writes every frame to Saved/Profiling/CombatReplay. Every
+ * damage event is checked against the recording and the player's drift from its recorded
+ * path is measured; -verify returns non-zero when the playback diverged.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
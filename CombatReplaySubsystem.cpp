@@ -0,0 +1,450 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatReplaySubsystem.h"
+#include "CombatActorRegistry.h"
+#include "CombatSimulationSubsystem.h"
+#include "EnemyBase.h"
+#include "PlayerCharacterController.h"
+#include "WeaponManagerComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace CombatReplayRecording
+{
+	// About ten seconds of frames per chunk, or sooner when a firefight makes the frames big
+	static constexpr uint32 ChunkFrames = 600;
+
+	static constexpr int32 ChunkBytes = 64 * 1024;
+
+	// Enemy moves below this are not recorded
+	static constexpr float MoveTolerance = 1.0f;
+
+	static constexpr float RotationTolerance = 0.5f;
+
+	static void StartRecording(const TArray<FString>& Args, UWorld* World)
+	{
+		UCombatReplaySubsystem* Replay = UCombatReplaySubsystem::Get(World);
+		if (!Replay) return;
+
+		Replay->StartRecording(Args.Num() > 0 ? Args[0] : FString(), Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0);
+	}
+
+	static void StopRecording(UWorld* World)
+	{
+		if (UCombatReplaySubsystem* Replay = UCombatReplaySubsystem::Get(World))
+		{
+			Replay->StopRecording();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs RecordCommand(
+		TEXT("Combat.Replay.Record"),
+		TEXT("Combat.Replay.Record [File] [Seed]: records this level's combat for headless playback with -run=CombatReplay."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartRecording));
+
+	static FAutoConsoleCommandWithWorld StopCommand(
+		TEXT("Combat.Replay.Stop"),
+		TEXT("Stops the combat replay recording and closes the file."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&StopRecording));
+}
+
+UCombatReplaySubsystem* UCombatReplaySubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatReplaySubsystem>() : nullptr;
+}
+
+void UCombatReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bRecordWhenPlayerSpawns = FParse::Value(FCommandLine::Get(), TEXT("CombatReplay="), CommandLinePath) || FParse::Param(FCommandLine::Get(), TEXT("CombatReplay"));
+
+	// A fixed file name would be overwritten by the next level, so it becomes a prefix
+	if (!CommandLinePath.IsEmpty())
+	{
+		CommandLinePath = FPaths::GetBaseFilename(CommandLinePath, false) + TEXT("_") + GetWorld()->GetMapName() + TEXT(".crpl");
+	}
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UCombatReplaySubsystem::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCombatReplaySubsystem::OnWorldPostActorTick);
+}
+
+void UCombatReplaySubsystem::Deinitialize()
+{
+	StopRecording();
+
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+bool UCombatReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCombatReplaySubsystem::StartRecording(const FString& Path, int32 Seed)
+{
+	if (IsRecording())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Already recording a combat replay to %s"), *RecordingPath);
+		return false;
+	}
+
+	// One recording or playback at a time owns the gameplay hooks
+	if (CombatReplay::GListener)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Another combat replay is recording or playing, not recording %s"), *GetWorld()->GetMapName());
+		return false;
+	}
+
+	APlayerCharacterController* PlayerCharacter = Cast<APlayerCharacterController>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+	if (!PlayerCharacter)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No player to record a combat replay of in %s"), *GetWorld()->GetMapName());
+		return false;
+	}
+
+	RecordingPath = !Path.IsEmpty() ? Path
+		: FPaths::ProfilingDir() / TEXT("CombatReplay") / FString::Printf(TEXT("Replay_%s_%s.crpl"), *GetWorld()->GetMapName(), *FDateTime::Now().ToString());
+
+	if (Seed == 0)
+	{
+		Seed = static_cast<int32>(FPlatformTime::Cycles() | 1);
+	}
+
+	if (!Writer.Open(RecordingPath, Seed))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open %s for the combat replay"), *RecordingPath);
+		return false;
+	}
+
+	// Anything in the session drawing from the combat or global streams draws the same numbers on playback
+	if (UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(GetWorld()))
+	{
+		Simulation->SetSeed(Seed);
+	}
+
+	Player = PlayerCharacter;
+	TrackedEnemies.Reset();
+	ActorIndices.Reset();
+	ActorIndices.Add(PlayerCharacter, 0);
+	NextEnemyIndex = 1;
+
+	FrameEvents.Reset();
+	FrameEventCount = 0;
+	FrameDelta = 0.0f;
+	ChunkData.Reset();
+	ChunkFirstFrame = 0;
+	ChunkFrameCount = 0;
+	FrameCount = 0;
+	RecordedSeconds = 0.0;
+
+	FCombatReplayScene Scene;
+	CaptureScene(Scene);
+
+	TArray<uint8> SceneData;
+	FMemoryWriter SceneWriter(SceneData);
+	SceneWriter << Scene;
+	Writer.WriteChunk(CombatReplay::SceneChunk, 0, 0, SceneData);
+
+	CombatReplay::GListener = this;
+
+	UE_LOG(LogTemp, Display, TEXT("Recording combat replay to %s (seed %d, %d enemies, %d static meshes)"),
+		*RecordingPath, Seed, Scene.Enemies.Num(), Scene.Geometry.Num());
+	return true;
+}
+
+void UCombatReplaySubsystem::StopRecording()
+{
+	if (!IsRecording()) return;
+
+	if (CombatReplay::GListener == this)
+	{
+		CombatReplay::GListener = nullptr;
+	}
+
+	FlushChunk();
+	Writer.Close(FrameCount, RecordedSeconds);
+
+	UE_LOG(LogTemp, Display, TEXT("Combat replay written to %s (%u frames, %.1f s, %lld bytes)"),
+		*RecordingPath, FrameCount, RecordedSeconds, Writer.GetBytesWritten());
+}
+
+void UCombatReplaySubsystem::CaptureScene(FCombatReplayScene& OutScene)
+{
+	UWorld* World = GetWorld();
+	OutScene.MapName = World->GetMapName();
+
+	// Static mesh actors are what the traces and the wall runs hit; landscapes and brushes are not rebuilt
+	for (TActorIterator<AStaticMeshActor> It(World); It; ++It)
+	{
+		const UStaticMeshComponent* MeshComponent = It->GetStaticMeshComponent();
+		const UStaticMesh* Mesh = MeshComponent ? MeshComponent->GetStaticMesh() : nullptr;
+		if (!Mesh || MeshComponent->GetCollisionEnabled() == ECollisionEnabled::NoCollision) continue;
+
+		FCombatReplayGeometry& Geometry = OutScene.Geometry.AddDefaulted_GetRef();
+		Geometry.MeshPath = Mesh->GetPathName();
+		Geometry.Location = FVector3f(It->GetActorLocation());
+		Geometry.Rotation = FRotator3f(It->GetActorRotation());
+		Geometry.Scale = FVector3f(It->GetActorScale3D());
+		Geometry.Tags = It->Tags;
+	}
+
+	APlayerCharacterController* PlayerCharacter = Player.Get();
+	FCombatReplayPlayer& PlayerRecord = OutScene.Player;
+	PlayerRecord.ClassPath = PlayerCharacter->GetClass()->GetPathName();
+	PlayerRecord.Location = FVector3f(PlayerCharacter->GetActorLocation());
+	PlayerRecord.Rotation = FRotator3f(PlayerCharacter->GetActorRotation());
+	PlayerRecord.ControlRotation = FRotator3f(PlayerCharacter->GetControlRotation());
+	PlayerRecord.Shield = PlayerCharacter->CurrentShieldPool;
+	PlayerRecord.MaxShield = PlayerCharacter->MaxShieldPool;
+	PlayerRecord.Health = PlayerCharacter->CurrentHealthPool;
+	PlayerRecord.MaxHealth = PlayerCharacter->MaxHealthPool;
+
+	if (const UWeaponManagerComponent* WeaponManager = PlayerCharacter->WeaponManager)
+	{
+		PlayerRecord.CurrentSlot = static_cast<uint8>(WeaponManager->CurrentSlot);
+
+		for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
+		{
+			const FWeaponSlotState& Slot = WeaponManager->WeaponSlots[SlotIndex];
+			FCombatReplayWeapon& Weapon = PlayerRecord.Weapons[SlotIndex];
+			if (const UWeaponDefinition* Definition = Slot.Definition)
+			{
+				Weapon.DefinitionPath = Definition->GetPathName();
+				Weapon.WeaponName = Definition->WeaponName;
+				Weapon.FireMode = static_cast<uint8>(Definition->FireMode);
+				Weapon.FireRate = Definition->FireRate;
+				Weapon.AmmoPerMag = Definition->AmmoPerMag;
+				Weapon.DamagePerBullet = Definition->DamagePerBullet;
+			}
+			Weapon.CurrentAmmo = Slot.CurrentAmmo;
+			Weapon.Magazines = Slot.Magazines;
+			Weapon.TempAmmoPool = Slot.TempAmmoPool;
+		}
+	}
+
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		for (AEnemyBase* Enemy : Registry->GetEnemies())
+		{
+			if (Enemy && !Enemy->bIsEnemyDead)
+			{
+				OutScene.Enemies.Add(TrackEnemy(Enemy));
+			}
+		}
+	}
+}
+
+FCombatReplayEnemy UCombatReplaySubsystem::TrackEnemy(AEnemyBase* Enemy)
+{
+	FTrackedEnemy& Tracked = TrackedEnemies.AddDefaulted_GetRef();
+	Tracked.Enemy = Enemy;
+	Tracked.Index = NextEnemyIndex++;
+	Tracked.bAiming = Enemy->bIsEnemyAimingWeapon;
+	Tracked.Location = Enemy->GetActorLocation();
+	Tracked.Rotation = Enemy->GetActorRotation();
+	ActorIndices.Add(Enemy, Tracked.Index);
+
+	FCombatReplayEnemy Record;
+	Record.Index = Tracked.Index;
+	Record.ClassPath = Enemy->GetClass()->GetPathName();
+	Record.WeaponClassPath = Enemy->WeaponBlueprint ? Enemy->WeaponBlueprint->GetPathName() : FString();
+	Record.Location = FVector3f(Tracked.Location);
+	Record.Rotation = FRotator3f(Tracked.Rotation);
+	Record.Tags = Enemy->Tags;
+	Record.Shield = Enemy->CurrentShieldPool;
+	Record.MaxShield = Enemy->MaxShieldPool;
+	Record.Health = Enemy->CurrentHealthPool;
+	Record.MaxHealth = Enemy->MaxHealthPool;
+	Record.bAiming = Tracked.bAiming;
+	return Record;
+}
+
+void UCombatReplaySubsystem::WriteEvent(ECombatReplayEvent Event, TFunctionRef<void(FArchive&)> Serialize)
+{
+	FMemoryWriter Ar(FrameEvents);
+	Ar.Seek(FrameEvents.Num());
+
+	uint8 Kind = static_cast<uint8>(Event);
+	Ar << Kind;
+	Serialize(Ar);
+
+	FrameEventCount++;
+}
+
+void UCombatReplaySubsystem::OnInput(const APlayerCharacterController* InPlayer, ECombatReplayInput Input, const FVector2D& Value)
+{
+	if (InPlayer != Player.Get()) return;
+
+	WriteEvent(ECombatReplayEvent::Input, [&](FArchive& Ar)
+	{
+		uint8 InputValue = static_cast<uint8>(Input);
+		Ar << InputValue;
+
+		// Move turns the axis into world directions with the control yaw of the moment
+		if (Input == ECombatReplayInput::Move)
+		{
+			FVector2f Axis(Value);
+			float Yaw = static_cast<float>(InPlayer->GetControlRotation().Yaw);
+			Ar << Axis << Yaw;
+		}
+	});
+}
+
+void UCombatReplaySubsystem::OnDamage(const AActor* Target, float Amount, float ShieldPool, float HealthPool)
+{
+	const uint16* Index = ActorIndices.Find(TWeakObjectPtr<const AActor>(Target));
+	if (!Index) return;
+
+	WriteEvent(ECombatReplayEvent::Damage, [&](FArchive& Ar)
+	{
+		uint16 TargetIndex = *Index;
+		Ar << TargetIndex << Amount << ShieldPool << HealthPool;
+	});
+}
+
+void UCombatReplaySubsystem::OnAim(const AActor* Shooter, FVector& Start, FVector& End)
+{
+	if (Shooter != Player.Get()) return;
+
+	WriteEvent(ECombatReplayEvent::Aim, [&](FArchive& Ar)
+	{
+		FVector3f AimStart(Start);
+		FVector3f AimEnd(End);
+		Ar << AimStart << AimEnd;
+	});
+}
+
+void UCombatReplaySubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld()) return;
+
+	if (bRecordWhenPlayerSpawns && !IsRecording() && UGameplayStatics::GetPlayerPawn(InWorld, 0))
+	{
+		bRecordWhenPlayerSpawns = false;
+		StartRecording(CommandLinePath);
+	}
+
+	FrameDelta = DeltaSeconds;
+}
+
+void UCombatReplaySubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld() || !IsRecording()) return;
+
+	RecordEnemyChanges();
+	EndFrame();
+}
+
+void UCombatReplaySubsystem::RecordEnemyChanges()
+{
+	using namespace CombatReplayRecording;
+
+	for (int32 Index = TrackedEnemies.Num() - 1; Index >= 0; --Index)
+	{
+		FTrackedEnemy& Tracked = TrackedEnemies[Index];
+		AEnemyBase* Enemy = Tracked.Enemy.Get();
+
+		if (!Enemy || Enemy->IsActorBeingDestroyed())
+		{
+			// Enemies that died in play die on playback too; anything else has to be removed there
+			if (!Tracked.bDead)
+			{
+				uint16 EnemyIndex = Tracked.Index;
+				WriteEvent(ECombatReplayEvent::EnemyRemoved, [&](FArchive& Ar) { Ar << EnemyIndex; });
+			}
+			ActorIndices.Remove(TWeakObjectPtr<const AActor>(Tracked.Enemy));
+			TrackedEnemies.RemoveAtSwap(Index);
+			continue;
+		}
+
+		Tracked.bDead = Enemy->bIsEnemyDead;
+
+		if (Enemy->bIsEnemyAimingWeapon != Tracked.bAiming)
+		{
+			Tracked.bAiming = Enemy->bIsEnemyAimingWeapon;
+
+			uint16 EnemyIndex = Tracked.Index;
+			bool bAiming = Tracked.bAiming;
+			WriteEvent(ECombatReplayEvent::EnemyAim, [&](FArchive& Ar) { Ar << EnemyIndex << bAiming; });
+		}
+
+		const FVector Location = Enemy->GetActorLocation();
+		const FRotator Rotation = Enemy->GetActorRotation();
+		if (!Location.Equals(Tracked.Location, MoveTolerance) || !Rotation.Equals(Tracked.Rotation, RotationTolerance))
+		{
+			Tracked.Location = Location;
+			Tracked.Rotation = Rotation;
+
+			uint16 EnemyIndex = Tracked.Index;
+			FVector3f MovedLocation(Location);
+			FRotator3f MovedRotation(Rotation);
+			WriteEvent(ECombatReplayEvent::EnemyMoved, [&](FArchive& Ar) { Ar << EnemyIndex << MovedLocation << MovedRotation; });
+		}
+	}
+
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this);
+	if (!Registry) return;
+
+	for (AEnemyBase* Enemy : Registry->GetEnemies())
+	{
+		if (Enemy && !Enemy->bIsEnemyDead && !ActorIndices.Contains(TWeakObjectPtr<const AActor>(Enemy)))
+		{
+			FCombatReplayEnemy Record = TrackEnemy(Enemy);
+			WriteEvent(ECombatReplayEvent::EnemySpawned, [&](FArchive& Ar) { Ar << Record; });
+		}
+	}
+}
+
+void UCombatReplaySubsystem::EndFrame()
+{
+	using namespace CombatReplayRecording;
+
+	const APlayerCharacterController* PlayerCharacter = Player.Get();
+
+	FMemoryWriter Ar(ChunkData);
+	Ar.Seek(ChunkData.Num());
+
+	float Delta = FrameDelta;
+	FRotator3f ControlRotation(PlayerCharacter ? PlayerCharacter->GetControlRotation() : FRotator::ZeroRotator);
+	FVector3f PlayerLocation(PlayerCharacter ? PlayerCharacter->GetActorLocation() : FVector::ZeroVector);
+	uint16 EventCount = FrameEventCount;
+	Ar << Delta << ControlRotation << PlayerLocation << EventCount;
+	Ar.Serialize(FrameEvents.GetData(), FrameEvents.Num());
+
+	FrameEvents.Reset();
+	FrameEventCount = 0;
+
+	RecordedSeconds += FrameDelta;
+	FrameCount++;
+	ChunkFrameCount++;
+
+	if (ChunkFrameCount >= ChunkFrames || ChunkData.Num() >= ChunkBytes)
+	{
+		FlushChunk();
+	}
+}
+
+void UCombatReplaySubsystem::FlushChunk()
+{
+	if (ChunkFrameCount == 0) return;
+
+	Writer.WriteChunk(CombatReplay::FramesChunk, ChunkFirstFrame, ChunkFrameCount, ChunkData);
+
+	ChunkData.Reset();
+	ChunkFirstFrame = FrameCount;
+	ChunkFrameCount = 0;
+}
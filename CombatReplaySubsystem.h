@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "CombatReplay.h"
+#include "CombatReplaySubsystem.generated.h"
+
+class AEnemyBase;
+class APlayerCharacterController;
+
+/**
+ * Records the combat in this world to a replay file (CombatReplay.h) for -run=CombatReplay
+ * to re-simulate headlessly: the scene at the start, then per frame the delta time, the
+ * player's inputs, control rotation and aim, what the enemies' AI decided (spawns, aim, moves)
+ * and every damage event, which playback checks itself against. The session's random
+ * seed is set when recording starts and stored with the file.
+ *
+ * Combat.Replay.Record [File] [Seed] / Combat.Replay.Stop, or -CombatReplay[=File] to record
+ * every level from the moment its player spawns. A recording ends with its world.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatReplaySubsystem : public UWorldSubsystem, public CombatReplay::FListener
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatReplaySubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	// Empty path records to Saved/Profiling/CombatReplay, seed 0 picks one
+	bool StartRecording(const FString& Path = FString(), int32 Seed = 0);
+
+	void StopRecording();
+
+	bool IsRecording() const { return Writer.IsOpen(); }
+
+	virtual void OnInput(const APlayerCharacterController* InPlayer, ECombatReplayInput Input, const FVector2D& Value) override;
+
+	virtual void OnDamage(const AActor* Target, float Amount, float ShieldPool, float HealthPool) override;
+
+	virtual void OnAim(const AActor* Shooter, FVector& Start, FVector& End) override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FTrackedEnemy
+	{
+		TWeakObjectPtr<AEnemyBase> Enemy;
+		uint16 Index = 0;
+		bool bAiming = false;
+		bool bDead = false;
+		FVector Location = FVector::ZeroVector;
+		FRotator Rotation = FRotator::ZeroRotator;
+	};
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	void CaptureScene(FCombatReplayScene& OutScene);
+
+	FCombatReplayEnemy TrackEnemy(AEnemyBase* Enemy);
+
+	// Enemy spawns, removals, aim and moves since the last frame
+	void RecordEnemyChanges();
+
+	void EndFrame();
+
+	void FlushChunk();
+
+	// Appends an event to the current frame, Serialize writes its payload
+	void WriteEvent(ECombatReplayEvent Event, TFunctionRef<void(FArchive&)> Serialize);
+
+	CombatReplay::FFileWriter Writer;
+
+	FString RecordingPath;
+
+	TWeakObjectPtr<APlayerCharacterController> Player;
+
+	TArray<FTrackedEnemy> TrackedEnemies;
+
+	// Player is 0, enemies from 1 in the order they were first seen. Weak keys, so an enemy
+	// spawned at a destroyed one's address is not mistaken for it.
+	TMap<TWeakObjectPtr<const AActor>, uint16> ActorIndices;
+
+	uint16 NextEnemyIndex = 1;
+
+	TArray<uint8> FrameEvents;
+
+	uint16 FrameEventCount = 0;
+
+	float FrameDelta = 0.0f;
+
+	TArray<uint8> ChunkData;
+
+	uint32 ChunkFirstFrame = 0;
+
+	uint32 ChunkFrameCount = 0;
+
+	uint32 FrameCount = 0;
+
+	double RecordedSeconds = 0.0;
+
+	// -CombatReplay: start as soon as the world has a player
+	bool bRecordWhenPlayerSpawns = false;
+
+	FString CommandLinePath;
+
+	FDelegateHandle TickStartHandle;
+
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatSaveSubsystem.h"
+#include "SaveGameData.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<float> CVarCombatSaveCoalesceDelay(
+	TEXT("Combat.Save.CoalesceDelay"),
+	0.25f,
+	TEXT("Seconds to wait after a save request so requests close together are written once."));
+
+namespace CombatSave
+{
+	// Slot used before the compact format existed, read once to migrate old progress
+	static const TCHAR* LegacySlotName = TEXT("PlayerSaveSlot");
+
+	struct FHeader
+	{
+		uint32 Magic = USaveGameData::CompactMagic;
+		uint16 Version = USaveGameData::CompactVersion;
+		uint16 Reserved = 0;
+		uint32 PayloadSize = 0;
+		uint32 PayloadCrc = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FHeader& Header)
+		{
+			return Ar << Header.Magic << Header.Version << Header.Reserved << Header.PayloadSize << Header.PayloadCrc;
+		}
+	};
+
+	// Written in full first, then moved over the slot
+	static FString GetTempPath(const FString& Path)
+	{
+		return Path + TEXT(".tmp");
+	}
+
+	enum class ELoadResult : uint8
+	{
+		Missing,
+		Corrupt,
+		Loaded
+	};
+
+	static ELoadResult LoadCompact(USaveGameData* SaveData, const FString& Path)
+	{
+		TArray<uint8> Bytes;
+		if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent)) return ELoadResult::Missing;
+
+		FMemoryReader Reader(Bytes);
+
+		FHeader Header;
+		Reader << Header;
+
+		const int64 PayloadOffset = Reader.Tell();
+		const bool bValidHeader = !Reader.IsError()
+			&& Header.Magic == USaveGameData::CompactMagic
+			&& Header.Version <= USaveGameData::CompactVersion
+			&& PayloadOffset + Header.PayloadSize <= Bytes.Num()
+			&& FCrc::MemCrc32(Bytes.GetData() + PayloadOffset, Header.PayloadSize) == Header.PayloadCrc;
+		if (!bValidHeader) return ELoadResult::Corrupt;
+
+		SaveData->SerializeCompact(Reader, Header.Version);
+		return Reader.IsError() ? ELoadResult::Corrupt : ELoadResult::Loaded;
+	}
+}
+
+UCombatSaveSubsystem* UCombatSaveSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UCombatSaveSubsystem>() : nullptr;
+}
+
+void UCombatSaveSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SavePath = FPaths::ProjectSavedDir() / TEXT("SaveGames") / TEXT("CombatProgress.bin");
+
+	// One small read at boot, outside gameplay, so the cached object is valid before any level asks for it
+	LoadSaveData();
+}
+
+void UCombatSaveSubsystem::Deinitialize()
+{
+	FlushSaves();
+
+	Super::Deinitialize();
+}
+
+bool UCombatSaveSubsystem::IsLevelUnlocked(FName LevelName) const
+{
+	const FLevelProgressRecord* Record = SaveData ? SaveData->FindLevel(LevelName) : nullptr;
+	return Record && Record->bUnlocked;
+}
+
+void UCombatSaveSubsystem::RecordLevelCompleted(FName LevelName, float CompletionSeconds, int32 EnemiesKilled, FName UnlockedLevel)
+{
+	FLevelProgressRecord& Record = SaveData->FindOrAddLevel(LevelName);
+	Record.bUnlocked = true;
+	Record.bCompleted = true;
+	Record.TimesCompleted++;
+	Record.EnemiesKilled += EnemiesKilled;
+
+	if (Record.BestCompletionSeconds <= 0.0f || CompletionSeconds < Record.BestCompletionSeconds)
+	{
+		Record.BestCompletionSeconds = CompletionSeconds;
+	}
+
+	if (!UnlockedLevel.IsNone())
+	{
+		SaveData->FindOrAddLevel(UnlockedLevel).bUnlocked = true;
+	}
+
+	RequestSave();
+}
+
+void UCombatSaveSubsystem::RequestSave()
+{
+	bSaveRequested = true;
+
+	if (!CoalesceTickerHandle.IsValid())
+	{
+		CoalesceTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &UCombatSaveSubsystem::OnCoalesceDelayElapsed),
+			CVarCombatSaveCoalesceDelay.GetValueOnGameThread());
+	}
+}
+
+void UCombatSaveSubsystem::FlushSaves()
+{
+	if (CoalesceTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(CoalesceTickerHandle);
+		CoalesceTickerHandle.Reset();
+	}
+
+	if (bWriteInFlight)
+	{
+		WriteFuture.Wait();
+		bWriteInFlight = false;
+	}
+
+	if (bSaveRequested)
+	{
+		StartWrite();
+		if (!WriteFuture.Get())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write save file %s"), *SavePath);
+		}
+		bWriteInFlight = false;
+	}
+}
+
+bool UCombatSaveSubsystem::OnCoalesceDelayElapsed(float DeltaTime)
+{
+	CoalesceTickerHandle.Reset();
+
+	// A write already in flight picks the request up when it finishes
+	if (!bWriteInFlight)
+	{
+		StartWrite();
+	}
+
+	return false;
+}
+
+void UCombatSaveSubsystem::StartWrite()
+{
+	bSaveRequested = false;
+	bWriteInFlight = true;
+	const uint32 Serial = ++WriteSerial;
+
+	// Serializing the cached object is cheap, only the file I/O leaves the game thread
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+	SaveData->SerializeCompact(PayloadWriter, USaveGameData::CompactVersion);
+
+	CombatSave::FHeader Header;
+	Header.PayloadSize = Payload.Num();
+	Header.PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << Header;
+	Bytes.Append(Payload);
+
+	WriteFuture = Async(EAsyncExecution::ThreadPool, [Bytes = MoveTemp(Bytes), FinalPath = SavePath, WeakThis = TWeakObjectPtr<UCombatSaveSubsystem>(this), Serial]()
+	{
+		const FString TempPath = CombatSave::GetTempPath(FinalPath);
+
+		const bool bSucceeded = FFileHelper::SaveArrayToFile(Bytes, *TempPath)
+			&& IFileManager::Get().Move(*FinalPath, *TempPath, true, true);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Serial, bSucceeded]()
+		{
+			if (UCombatSaveSubsystem* Subsystem = WeakThis.Get())
+			{
+				Subsystem->OnWriteFinished(Serial, bSucceeded);
+			}
+		});
+
+		return bSucceeded;
+	});
+}
+
+void UCombatSaveSubsystem::OnWriteFinished(uint32 Serial, bool bSucceeded)
+{
+	if (!bWriteInFlight || Serial != WriteSerial) return;
+
+	bWriteInFlight = false;
+
+	if (!bSucceeded)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write save file %s"), *SavePath);
+	}
+
+	// Requests that came in during the write get one more write
+	if (bSaveRequested && !CoalesceTickerHandle.IsValid())
+	{
+		RequestSave();
+	}
+}
+
+void UCombatSaveSubsystem::LoadSaveData()
+{
+	using namespace CombatSave;
+
+	SaveData = Cast<USaveGameData>(UGameplayStatics::CreateSaveGameObject(USaveGameData::StaticClass()));
+
+	const ELoadResult MainResult = LoadCompact(SaveData, SavePath);
+	if (MainResult == ELoadResult::Loaded) return;
+
+	// The write moves the .tmp over the slot by deleting the slot first; a crash in between
+	// leaves the finished .tmp as the only copy
+	SaveData = Cast<USaveGameData>(UGameplayStatics::CreateSaveGameObject(USaveGameData::StaticClass()));
+	const FString TempPath = GetTempPath(SavePath);
+	const ELoadResult TempResult = LoadCompact(SaveData, TempPath);
+	if (TempResult == ELoadResult::Loaded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Save file %s is %s, recovered progress from %s."), *SavePath,
+			MainResult == ELoadResult::Missing ? TEXT("missing") : TEXT("corrupt"), *TempPath);
+		RequestSave();
+		return;
+	}
+
+	SaveData = Cast<USaveGameData>(UGameplayStatics::CreateSaveGameObject(USaveGameData::StaticClass()));
+	// A half-written .tmp next to a missing slot is a first save that never finished
+	if (MainResult == ELoadResult::Corrupt)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Save file %s is corrupt or from a newer version, starting fresh."), *SavePath);
+		return;
+	}
+
+	// No compact save yet, migrate progress from the old slot
+	if (USaveGameData* LegacyData = Cast<USaveGameData>(UGameplayStatics::LoadGameFromSlot(LegacySlotName, 0)))
+	{
+		SaveData->bIsLevel2Unlocked = LegacyData->bIsLevel2Unlocked;
+		SaveData->LevelProgress = LegacyData->LevelProgress;
+		RequestSave();
+	}
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "CombatSaveSubsystem.generated.h"
+
+class USaveGameData;
+
+/**
+ * Owns the player's save data for the whole session. The save object stays cached
+ * in memory. Writes are coalesced, serialized to a compact versioned blob and written
+ * on a worker thread to a temp file, which is then renamed over the real one.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatSaveSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatSaveSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	UFUNCTION(BlueprintCallable, Category = "SaveData")
+	USaveGameData* GetSaveData() const { return SaveData; }
+
+	UFUNCTION(BlueprintCallable, Category = "SaveData")
+	bool IsLevelUnlocked(FName LevelName) const;
+
+	// Records a finished run of LevelName and unlocks UnlockedLevel, if any
+	void RecordLevelCompleted(FName LevelName, float CompletionSeconds, int32 EnemiesKilled, FName UnlockedLevel);
+
+	// Marks the save dirty. Requests that arrive close together are written once.
+	UFUNCTION(BlueprintCallable, Category = "SaveData")
+	void RequestSave();
+
+	// Writes any pending changes now and waits for the write to finish
+	void FlushSaves();
+
+private:
+
+	UPROPERTY()
+	USaveGameData* SaveData = nullptr;
+
+	FString SavePath;
+
+	bool bSaveRequested = false;
+
+	bool bWriteInFlight = false;
+
+	// Identifies the write in flight so a completion that was already waited on is ignored
+	uint32 WriteSerial = 0;
+
+	TFuture<bool> WriteFuture;
+
+	FTSTicker::FDelegateHandle CoalesceTickerHandle;
+
+	void LoadSaveData();
+
+	bool OnCoalesceDelayElapsed(float DeltaTime);
+
+	void StartWrite();
+
+	void OnWriteFinished(uint32 Serial, bool bSucceeded);
+};
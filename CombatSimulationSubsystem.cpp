@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatSimulationSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "TimerManager.h"
+
+static TAutoConsoleVariable<float> CVarCombatFixedStepRate(
+	TEXT("Combat.FixedStep.Rate"),
+	0.0f,
+	TEXT("Combat simulation steps per second, 0 to run combat on the frame's delta time. Read when a world starts."));
+
+static TAutoConsoleVariable<int32> CVarCombatFixedStepMaxSteps(
+	TEXT("Combat.FixedStep.MaxStepsPerFrame"),
+	8,
+	TEXT("Fixed steps a hitching frame may catch up before the rest of its time is dropped. Commandlets never drop steps."));
+
+UCombatSimulationSubsystem* UCombatSimulationSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatSimulationSubsystem>() : nullptr;
+}
+
+void UCombatSimulationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	float StepRate = CVarCombatFixedStepRate.GetValueOnGameThread();
+	FParse::Value(FCommandLine::Get(), TEXT("CombatFixedStep="), StepRate);
+
+	StepSeconds = StepRate > 0.0f ? 1.0f / StepRate : 0.0f;
+	MaxStepsPerFrame = IsRunningCommandlet() ? 0 : FMath::Max(1, CVarCombatFixedStepMaxSteps.GetValueOnGameThread());
+
+	// After time dilation and never while paused, so steps follow the world's own time
+	if (IsFixedStep())
+	{
+		PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UCombatSimulationSubsystem::OnWorldPreActorTick);
+	}
+
+	int32 SessionSeed = 0;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("CombatSeed="), SessionSeed) || SessionSeed == 0)
+	{
+		SessionSeed = static_cast<int32>(FPlatformTime::Cycles() | 1);
+	}
+	SetSeed(SessionSeed);
+
+	UE_LOG(LogTemp, Log, TEXT("Combat simulation in %s: %s, seed %d"), *GetWorld()->GetMapName(),
+		IsFixedStep() ? *FString::Printf(TEXT("fixed %.0f Hz steps"), StepRate) : TEXT("variable steps"), Seed);
+}
+
+void UCombatSimulationSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	StepTimers.Reset();
+	OnStep.Clear();
+
+	Super::Deinitialize();
+}
+
+bool UCombatSimulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatSimulationSubsystem::SetSeed(int32 InSeed)
+{
+	Seed = InSeed;
+
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+}
+
+void UCombatSimulationSubsystem::OnWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld()) return;
+
+	Accumulator += DeltaSeconds;
+
+	int32 Steps = FMath::FloorToInt32(Accumulator / StepSeconds);
+	if (MaxStepsPerFrame > 0 && Steps > MaxStepsPerFrame)
+	{
+		// Catching up on a long hitch would only make the next frame longer
+		Accumulator -= (Steps - MaxStepsPerFrame) * static_cast<double>(StepSeconds);
+		Steps = MaxStepsPerFrame;
+	}
+
+	for (int32 Step = 0; Step < Steps; ++Step)
+	{
+		Accumulator -= StepSeconds;
+		RunStep();
+	}
+
+	Alpha = FMath::Clamp(static_cast<float>(Accumulator / StepSeconds), 0.0f, 1.0f);
+}
+
+void UCombatSimulationSubsystem::RunStep()
+{
+	StepCount++;
+
+	// Multiplied rather than summed so long sessions do not drift
+	SimulationTime = StepCount * static_cast<double>(StepSeconds);
+
+	// Earliest first, one at a time: a callback may set or clear timers, including its own
+	for (;;)
+	{
+		int32 DueIndex = INDEX_NONE;
+		for (int32 Index = 0; Index < StepTimers.Num(); ++Index)
+		{
+			const FStepTimer& Timer = StepTimers[Index];
+			if (Timer.DueTime > SimulationTime) continue;
+
+			if (DueIndex == INDEX_NONE || Timer.DueTime < StepTimers[DueIndex].DueTime
+				|| (Timer.DueTime == StepTimers[DueIndex].DueTime && Timer.Id < StepTimers[DueIndex].Id))
+			{
+				DueIndex = Index;
+			}
+		}
+		if (DueIndex == INDEX_NONE) break;
+
+		const FTimerDelegate Delegate = StepTimers[DueIndex].Delegate;
+		if (StepTimers[DueIndex].bLoop)
+		{
+			StepTimers[DueIndex].DueTime += StepTimers[DueIndex].Rate;
+		}
+		else
+		{
+			StepTimers.RemoveAtSwap(DueIndex);
+		}
+
+		Delegate.ExecuteIfBound();
+	}
+
+	OnStep.Broadcast(StepSeconds);
+}
+
+int32 UCombatSimulationSubsystem::FindStepTimer(uint64 Id) const
+{
+	return StepTimers.IndexOfByPredicate([Id](const FStepTimer& Timer) { return Timer.Id == Id; });
+}
+
+double UCombatSimulationSubsystem::GetTime(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World) return 0.0;
+
+	const UCombatSimulationSubsystem* Simulation = World->GetSubsystem<UCombatSimulationSubsystem>();
+	return Simulation && Simulation->IsFixedStep() ? Simulation->SimulationTime : World->GetTimeSeconds();
+}
+
+void UCombatSimulationSubsystem::SetTimer(const UObject* WorldContextObject, FCombatTimerHandle& Handle, const FTimerDelegate& Delegate, float Rate, bool bLoop)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World) return;
+
+	UCombatSimulationSubsystem* Simulation = World->GetSubsystem<UCombatSimulationSubsystem>();
+	if (!Simulation || !Simulation->IsFixedStep())
+	{
+		World->GetTimerManager().SetTimer(Handle.WorldHandle, Delegate, Rate, bLoop);
+		return;
+	}
+
+	// Like FTimerManager: setting a handle replaces its timer, a zero rate only clears it
+	ClearTimer(WorldContextObject, Handle);
+	if (Rate <= 0.0f) return;
+
+	FStepTimer& Timer = Simulation->StepTimers.AddDefaulted_GetRef();
+	Timer.Id = Simulation->NextStepTimerId++;
+	Timer.DueTime = Simulation->SimulationTime + Rate;
+	Timer.Rate = Rate;
+	Timer.bLoop = bLoop;
+	Timer.Delegate = Delegate;
+
+	Handle.StepTimerId = Timer.Id;
+}
+
+void UCombatSimulationSubsystem::ClearTimer(const UObject* WorldContextObject, FCombatTimerHandle& Handle)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World) return;
+
+	if (Handle.WorldHandle.IsValid())
+	{
+		World->GetTimerManager().ClearTimer(Handle.WorldHandle);
+	}
+
+	if (Handle.StepTimerId != 0)
+	{
+		if (UCombatSimulationSubsystem* Simulation = World->GetSubsystem<UCombatSimulationSubsystem>())
+		{
+			const int32 Index = Simulation->FindStepTimer(Handle.StepTimerId);
+			if (Index != INDEX_NONE)
+			{
+				Simulation->StepTimers.RemoveAtSwap(Index);
+			}
+		}
+		Handle.StepTimerId = 0;
+	}
+}
+
+bool UCombatSimulationSubsystem::IsTimerActive(const UObject* WorldContextObject, const FCombatTimerHandle& Handle)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World) return false;
+
+	if (Handle.StepTimerId != 0)
+	{
+		const UCombatSimulationSubsystem* Simulation = World->GetSubsystem<UCombatSimulationSubsystem>();
+		return Simulation && Simulation->FindStepTimer(Handle.StepTimerId) != INDEX_NONE;
+	}
+
+	return World->GetTimerManager().IsTimerActive(Handle.WorldHandle);
+}
+
+void UCombatSimulationSubsystem::ClearAllTimersForObject(const UObject* Object)
+{
+	UWorld* World = Object ? Object->GetWorld() : nullptr;
+	if (!World) return;
+
+	World->GetTimerManager().ClearAllTimersForObject(Object);
+
+	if (UCombatSimulationSubsystem* Simulation = World->GetSubsystem<UCombatSimulationSubsystem>())
+	{
+		Simulation->StepTimers.RemoveAllSwap([Object](const FStepTimer& Timer) { return Timer.Delegate.IsBoundToObject(Object); });
+	}
+}
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/TimerHandle.h"
+#include "CombatSimulationSubsystem.generated.h"
+
+// A combat timer: a world timer with variable steps, a timer on the step clock with fixed steps
+struct FCombatTimerHandle
+{
+	FTimerHandle WorldHandle;
+
+	uint64 StepTimerId = 0;
+
+	bool IsValid() const { return WorldHandle.IsValid() || StepTimerId != 0; }
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCombatStep, float /*StepSeconds*/);
+
+/**
+ * The clock combat runs on. By default it is the world's own: regen, fire cadence and combat
+ * timers advance once per frame by the frame's delta time. With Combat.FixedStep.Rate set
+ * (or -CombatFixedStep=<Hz>) the world's combat runs in fixed steps instead. Before actors
+ * tick, the frame's time goes into an accumulator and whole steps are taken out of it; each
+ * step fires the combat timers due in it, then OnStep. GetAlpha is the fraction of a step
+ * left over, for presentation to interpolate between the last two steps.
+ *
+ * Fixed steps give the same combat at any frame rate. A headless world ticked with long
+ * deltas runs many steps per frame, and commandlets never drop steps.
+ *
+ * The session seed feeds the engine's global random state. It comes from -CombatSeed=<N>,
+ * or is picked and logged at start; a replay recording sets its own.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatSimulationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatSimulationSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	bool IsFixedStep() const { return StepSeconds > 0.0f; }
+
+	float GetStepSeconds() const { return StepSeconds; }
+
+	// Time of the last fixed step
+	double GetSimulationTime() const { return SimulationTime; }
+
+	float GetAlpha() const { return Alpha; }
+
+	uint64 GetStepCount() const { return StepCount; }
+
+	void SetSeed(int32 InSeed);
+
+	int32 GetSeed() const { return Seed; }
+
+	// Fixed steps only, after the step's timers
+	FOnCombatStep OnStep;
+
+	// Step clock time with fixed steps, world time otherwise
+	static double GetTime(const UObject* WorldContextObject);
+
+	static void SetTimer(const UObject* WorldContextObject, FCombatTimerHandle& Handle, const FTimerDelegate& Delegate, float Rate, bool bLoop);
+
+	template<typename UserClass>
+	static void SetTimer(UserClass* Object, FCombatTimerHandle& Handle, void (UserClass::*Method)(), float Rate, bool bLoop)
+	{
+		SetTimer(Object, Handle, FTimerDelegate::CreateUObject(Object, Method), Rate, bLoop);
+	}
+
+	static void ClearTimer(const UObject* WorldContextObject, FCombatTimerHandle& Handle);
+
+	static bool IsTimerActive(const UObject* WorldContextObject, const FCombatTimerHandle& Handle);
+
+	static void ClearAllTimersForObject(const UObject* Object);
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FStepTimer
+	{
+		uint64 Id = 0;
+		double DueTime = 0.0;
+		float Rate = 0.0f;
+		bool bLoop = false;
+		FTimerDelegate Delegate;
+	};
+
+	void OnWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	void RunStep();
+
+	int32 FindStepTimer(uint64 Id) const;
+
+	float StepSeconds = 0.0f;
+
+	// 0 never drops steps
+	int32 MaxStepsPerFrame = 0;
+
+	double SimulationTime = 0.0;
+
+	double Accumulator = 0.0;
+
+	float Alpha = 0.0f;
+
+	uint64 StepCount = 0;
+
+	TArray<FStepTimer> StepTimers;
+
+	uint64 NextStepTimerId = 1;
+
+	int32 Seed = 0;
+
+	FDelegateHandle PreActorTickHandle;
+};
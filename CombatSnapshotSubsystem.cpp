@@ -0,0 +1,342 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatSnapshotSubsystem.h"
+#include "CombatActorRegistry.h"
+#include "EnemyBase.h"
+#include "PlayerCharacterController.h"
+#include "WeaponManagerComponent.h"
+#include "CombatMemory.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace CombatSnapshot
+{
+	static constexpr uint32 Magic = 0x504E5343; // "CSNP"
+	static constexpr uint16 Version = 1;
+
+	enum EEnemyFlags : uint8
+	{
+		EnemyDead = 1 << 0,
+	};
+
+	// Single precision is plenty for the size of the combat levels and halves the record
+	struct FEnemyRecord
+	{
+		uint16 ClassIndex = 0;
+		uint8 Flags = 0;
+		FVector3f Location = FVector3f::ZeroVector;
+		FRotator3f Rotation = FRotator3f::ZeroRotator;
+		float Shield = 0.0f;
+		float MaxShield = 0.0f;
+		float Health = 0.0f;
+		float MaxHealth = 0.0f;
+
+		friend FArchive& operator<<(FArchive& Ar, FEnemyRecord& Record)
+		{
+			return Ar << Record.ClassIndex << Record.Flags << Record.Location << Record.Rotation
+				<< Record.Shield << Record.MaxShield << Record.Health << Record.MaxHealth;
+		}
+	};
+
+	struct FPlayerRecord
+	{
+		FVector3f Location = FVector3f::ZeroVector;
+		FRotator3f Rotation = FRotator3f::ZeroRotator;
+		FRotator3f ControlRotation = FRotator3f::ZeroRotator;
+		float Shield = 0.0f;
+		float Health = 0.0f;
+		int32 CurrentAmmo[NumWeaponSlots] = {};
+		int32 Magazines[NumWeaponSlots] = {};
+		int32 TempAmmoPool[NumWeaponSlots] = {};
+
+		friend FArchive& operator<<(FArchive& Ar, FPlayerRecord& Record)
+		{
+			Ar << Record.Location << Record.Rotation << Record.ControlRotation << Record.Shield << Record.Health;
+			for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
+			{
+				Ar << Record.CurrentAmmo[SlotIndex] << Record.Magazines[SlotIndex] << Record.TempAmmoPool[SlotIndex];
+			}
+			return Ar;
+		}
+	};
+
+	static void CaptureCheckpoint(UWorld* World)
+	{
+		if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(World))
+		{
+			Snapshots->CaptureCheckpoint();
+		}
+	}
+
+	static void RestoreCheckpoint(UWorld* World)
+	{
+		UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(World);
+		if (!Snapshots || !Snapshots->RestoreCheckpoint())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("No combat checkpoint to restore."));
+		}
+	}
+
+	static FAutoConsoleCommandWithWorld CaptureCommand(
+		TEXT("Combat.Snapshot.Capture"),
+		TEXT("Captures the current combat state as the checkpoint."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&CaptureCheckpoint));
+
+	static FAutoConsoleCommandWithWorld RestoreCommand(
+		TEXT("Combat.Snapshot.Restore"),
+		TEXT("Restores the combat checkpoint in place."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&RestoreCheckpoint));
+}
+
+void FCombatSnapshot::Reset()
+{
+	Data.Reset();
+	Enemies.Reset();
+	EnemyClasses.Reset();
+}
+
+UCombatSnapshotSubsystem* UCombatSnapshotSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatSnapshotSubsystem>() : nullptr;
+}
+
+bool UCombatSnapshotSubsystem::CaptureSnapshot(FCombatSnapshot& OutSnapshot) const
+{
+	LLM_SCOPE_BYTAG(Combat_Systems);
+
+	using namespace CombatSnapshot;
+
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this);
+	if (!Registry) return false;
+
+	OutSnapshot.Reset();
+
+	const TArray<AEnemyBase*>& Enemies = Registry->GetEnemies();
+	OutSnapshot.Data.Reserve(64 + Enemies.Num() * 48);
+	OutSnapshot.Enemies.Reserve(Enemies.Num());
+
+	FMemoryWriter Ar(OutSnapshot.Data);
+
+	uint32 SnapshotMagic = Magic;
+	uint16 SnapshotVersion = Version;
+	Ar << SnapshotMagic << SnapshotVersion;
+
+	APlayerCharacterController* Player = Cast<APlayerCharacterController>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+	uint8 bHasPlayer = Player ? 1 : 0;
+	Ar << bHasPlayer;
+
+	if (Player)
+	{
+		FPlayerRecord Record;
+		Record.Location = FVector3f(Player->GetActorLocation());
+		Record.Rotation = FRotator3f(Player->GetActorRotation());
+		Record.ControlRotation = FRotator3f(Player->GetControlRotation());
+		Record.Shield = Player->CurrentShieldPool;
+		Record.Health = Player->CurrentHealthPool;
+
+		if (Player->WeaponManager)
+		{
+			for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
+			{
+				const FWeaponSlotState& Weapon = Player->WeaponManager->WeaponSlots[SlotIndex];
+				Record.CurrentAmmo[SlotIndex] = Weapon.CurrentAmmo;
+				Record.Magazines[SlotIndex] = Weapon.Magazines;
+				Record.TempAmmoPool[SlotIndex] = Weapon.TempAmmoPool;
+			}
+		}
+
+		Ar << Record;
+	}
+
+	// Enemies already destroyed stay dead on restore
+	int32 DeadEnemyCount = Registry->GetDeadEnemyCount();
+	int32 EnemyCount = Enemies.Num();
+	Ar << DeadEnemyCount << EnemyCount;
+
+	for (AEnemyBase* Enemy : Enemies)
+	{
+		FEnemyRecord Record;
+
+		TSubclassOf<AEnemyBase> EnemyClass = Enemy->GetClass();
+		int32 ClassIndex = OutSnapshot.EnemyClasses.Find(EnemyClass);
+		if (ClassIndex == INDEX_NONE)
+		{
+			ClassIndex = OutSnapshot.EnemyClasses.Add(EnemyClass);
+		}
+
+		Record.ClassIndex = static_cast<uint16>(ClassIndex);
+		Record.Flags = Enemy->bIsEnemyDead ? EnemyDead : 0;
+		Record.Location = FVector3f(Enemy->GetActorLocation());
+		Record.Rotation = FRotator3f(Enemy->GetActorRotation());
+		Record.Shield = Enemy->CurrentShieldPool;
+		Record.MaxShield = Enemy->MaxShieldPool;
+		Record.Health = Enemy->CurrentHealthPool;
+		Record.MaxHealth = Enemy->MaxHealthPool;
+
+		Ar << Record;
+		OutSnapshot.Enemies.Add(Enemy);
+	}
+
+	return true;
+}
+
+bool UCombatSnapshotSubsystem::RestoreSnapshot(FCombatSnapshot& Snapshot)
+{
+	// Mostly respawned enemies
+	LLM_SCOPE_BYTAG(Combat_Enemies);
+
+	using namespace CombatSnapshot;
+
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this);
+	if (!Registry || !Snapshot.IsValid()) return false;
+
+	FMemoryReader Ar(Snapshot.Data);
+
+	uint32 SnapshotMagic = 0;
+	uint16 SnapshotVersion = 0;
+	Ar << SnapshotMagic << SnapshotVersion;
+	if (SnapshotMagic != Magic || SnapshotVersion != Version) return false;
+
+	uint8 bHasPlayer = 0;
+	Ar << bHasPlayer;
+
+	if (bHasPlayer)
+	{
+		FPlayerRecord Record;
+		Ar << Record;
+
+		if (APlayerCharacterController* Player = Cast<APlayerCharacterController>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0)))
+		{
+			Player->SetActorLocationAndRotation(FVector(Record.Location), FRotator(Record.Rotation), false, nullptr, ETeleportType::ResetPhysics);
+			Player->GetCharacterMovement()->StopMovementImmediately();
+
+			if (AController* Controller = Player->GetController())
+			{
+				Controller->SetControlRotation(FRotator(Record.ControlRotation));
+			}
+
+			Player->RestoreCombatState(Record.Shield, Record.Health);
+
+			if (Player->WeaponManager)
+			{
+				for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
+				{
+					Player->WeaponManager->RestoreSlotAmmo(static_cast<EWeaponSlot>(SlotIndex), Record.CurrentAmmo[SlotIndex], Record.Magazines[SlotIndex], Record.TempAmmoPool[SlotIndex]);
+				}
+			}
+		}
+	}
+
+	int32 DeadEnemyCount = 0;
+	int32 EnemyCount = 0;
+	Ar << DeadEnemyCount << EnemyCount;
+	if (Ar.IsError() || EnemyCount != Snapshot.Enemies.Num()) return false;
+
+	TSet<AEnemyBase*> RestoredEnemies;
+	RestoredEnemies.Reserve(EnemyCount);
+
+	// Enemies that were already dying at capture time finish dying once the counts are reset
+	TArray<AEnemyBase*> DyingEnemies;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 Index = 0; Index < EnemyCount; ++Index)
+	{
+		FEnemyRecord Record;
+		Ar << Record;
+
+		AEnemyBase* Enemy = Snapshot.Enemies[Index].Get();
+		if (Enemy && Enemy->IsActorBeingDestroyed())
+		{
+			Enemy = nullptr;
+		}
+
+		if (Record.Flags & EnemyDead)
+		{
+			if (Enemy)
+			{
+				DyingEnemies.Add(Enemy);
+				RestoredEnemies.Add(Enemy);
+			}
+			else
+			{
+				DeadEnemyCount++;
+			}
+			continue;
+		}
+
+		const FVector Location(Record.Location);
+		const FRotator Rotation(Record.Rotation);
+
+		if (!Enemy)
+		{
+			UClass* EnemyClass = Snapshot.EnemyClasses.IsValidIndex(Record.ClassIndex) ? Snapshot.EnemyClasses[Record.ClassIndex].Get() : nullptr;
+			if (!EnemyClass) continue;
+
+			Enemy = GetWorld()->SpawnActor<AEnemyBase>(EnemyClass, Location, Rotation, SpawnParams);
+			if (!Enemy) continue;
+
+			if (!Enemy->GetController())
+			{
+				Enemy->SpawnDefaultController();
+			}
+
+			Snapshot.Enemies[Index] = Enemy;
+		}
+		else
+		{
+			Enemy->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		}
+
+		Enemy->MaxShieldPool = Record.MaxShield;
+		Enemy->MaxHealthPool = Record.MaxHealth;
+		Enemy->RestoreCombatState(Record.Shield, Record.Health);
+
+		RestoredEnemies.Add(Enemy);
+	}
+
+	// Enemies spawned after the capture don't exist in the restored state
+	TArray<AEnemyBase*> ExtraEnemies;
+	for (AEnemyBase* Enemy : Registry->GetEnemies())
+	{
+		if (!RestoredEnemies.Contains(Enemy))
+		{
+			ExtraEnemies.Add(Enemy);
+		}
+	}
+
+	for (AEnemyBase* Enemy : ExtraEnemies)
+	{
+		if (Enemy->SpawnedWeapon)
+		{
+			Enemy->SpawnedWeapon->Destroy();
+		}
+		Enemy->Destroy();
+	}
+
+	Registry->RestoreEnemyCounts(DeadEnemyCount);
+
+	for (AEnemyBase* Enemy : DyingEnemies)
+	{
+		Enemy->DestroyEnemy();
+	}
+
+	return true;
+}
+
+void UCombatSnapshotSubsystem::CaptureCheckpoint()
+{
+	CaptureSnapshot(Checkpoint);
+}
+
+bool UCombatSnapshotSubsystem::RestoreCheckpoint()
+{
+	return RestoreSnapshot(Checkpoint);
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatSnapshotSubsystem.generated.h"
+
+class AEnemyBase;
+
+// Restartable combat state of a world, packed into one binary blob
+USTRUCT()
+struct FCombatSnapshot
+{
+	GENERATED_BODY()
+
+	// Player, weapon ammo and one fixed-size record per enemy
+	TArray<uint8> Data;
+
+	// Parallel to the enemy records, used to find the live actor to restore in place
+	TArray<TWeakObjectPtr<AEnemyBase>> Enemies;
+
+	// Classes referenced by the enemy records, for respawning enemies destroyed since the capture
+	UPROPERTY()
+	TArray<TSubclassOf<AEnemyBase>> EnemyClasses;
+
+	bool IsValid() const { return Data.Num() > 0; }
+
+	void Reset();
+};
+
+/**
+ * Captures the combat state of the world (player, weapon ammo, enemies) and restores it
+ * in place, so a retry doesn't need a map reload. Enemies destroyed since the capture
+ * are respawned and enemies spawned since the capture are removed.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatSnapshotSubsystem* Get(const UObject* WorldContextObject);
+
+	bool CaptureSnapshot(FCombatSnapshot& OutSnapshot) const;
+
+	bool RestoreSnapshot(FCombatSnapshot& Snapshot);
+
+	// Stores the current state as the checkpoint a retry returns to
+	UFUNCTION(BlueprintCallable, Category = "Combat Snapshot")
+	void CaptureCheckpoint();
+
+	UFUNCTION(BlueprintCallable, Category = "Combat Snapshot")
+	bool RestoreCheckpoint();
+
+	UFUNCTION(BlueprintCallable, Category = "Combat Snapshot")
+	bool HasCheckpoint() const { return Checkpoint.IsValid(); }
+
+private:
+
+	UPROPERTY()
+	FCombatSnapshot Checkpoint;
+};
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatStartupSubsystem.h"
+#include "Engine/World.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<float> CVarCombatStartupFrameBudgetMs(
+	TEXT("Combat.Startup.FrameBudgetMs"),
+	2.0f,
+	TEXT("Milliseconds of deferred startup jobs run per frame. At least one job runs every frame."));
+
+UCombatStartupSubsystem* UCombatStartupSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatStartupSubsystem>() : nullptr;
+}
+
+void UCombatStartupSubsystem::Defer(const UObject* WorldContextObject, FName Name, ECombatStartupPriority Priority, TFunction<void()>&& Job)
+{
+	if (UCombatStartupSubsystem* Subsystem = Get(WorldContextObject))
+	{
+		Subsystem->EnqueueDeferred(Name, Priority, MoveTemp(Job));
+	}
+	else
+	{
+		Job();
+	}
+}
+
+bool UCombatStartupSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatStartupSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	InitializeTime = FPlatformTime::Seconds();
+}
+
+void UCombatStartupSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Every level actor has run BeginPlay by now
+	BeginPlayTime = FPlatformTime::Seconds();
+	BeginPlayFrame = GFrameCounter;
+}
+
+void UCombatStartupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (BeginPlayTime == 0.0) return;
+	if (bReportWritten && PendingJobs.Num() == 0) return;
+
+	const double FrameStart = FPlatformTime::Seconds();
+
+	// First frame ticked after BeginPlay is the first one the player can act in
+	if (FirstInteractiveFrameTime == 0.0)
+	{
+		FirstInteractiveFrameTime = FrameStart;
+	}
+
+	const double Budget = CVarCombatStartupFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+
+	while (PendingJobs.Num() > 0)
+	{
+		FDeferredJob Job = MoveTemp(PendingJobs[0]);
+		PendingJobs.RemoveAt(0);
+
+		const double JobStart = FPlatformTime::Seconds();
+		Job.Job();
+		RecordPhase(Job.Name, FPlatformTime::Seconds() - JobStart, true);
+
+		if (FPlatformTime::Seconds() - FrameStart >= Budget)
+		{
+			break;
+		}
+	}
+
+	if (!bReportWritten && PendingJobs.Num() == 0)
+	{
+		DeferredCompleteTime = FPlatformTime::Seconds();
+		WriteReport();
+	}
+}
+
+TStatId UCombatStartupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatStartupSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatStartupSubsystem::RecordPhase(FName Name, double Seconds, bool bDeferred)
+{
+	FPhaseRecord& Record = Phases.AddDefaulted_GetRef();
+	Record.Name = Name;
+	Record.Seconds = Seconds;
+	Record.Frame = GFrameCounter;
+	Record.bDeferred = bDeferred;
+}
+
+void UCombatStartupSubsystem::EnqueueDeferred(FName Name, ECombatStartupPriority Priority, TFunction<void()>&& Job)
+{
+	FDeferredJob NewJob;
+	NewJob.Name = Name;
+	NewJob.Priority = Priority;
+	NewJob.Sequence = NextJobSequence++;
+	NewJob.Job = MoveTemp(Job);
+
+	const int32 InsertIndex = Algo::UpperBoundBy(PendingJobs, NewJob.Priority, [](const FDeferredJob& Pending) { return Pending.Priority; });
+	PendingJobs.Insert(MoveTemp(NewJob), InsertIndex);
+}
+
+void UCombatStartupSubsystem::WriteReport()
+{
+	bReportWritten = true;
+
+	const FString MapName = GetWorld() ? GetWorld()->GetMapName() : TEXT("Unknown");
+
+	double CriticalSeconds = 0.0;
+	double DeferredSeconds = 0.0;
+	for (const FPhaseRecord& Record : Phases)
+	{
+		(Record.bDeferred ? DeferredSeconds : CriticalSeconds) += Record.Seconds;
+	}
+
+	FString Report;
+	Report += FString::Printf(TEXT("Combat startup report for %s\n"), *MapName);
+	Report += FString::Printf(TEXT("Time to BeginPlay: %.2f ms\n"), (BeginPlayTime - InitializeTime) * 1000.0);
+	Report += FString::Printf(TEXT("Time to first interactive frame: %.2f ms\n"), (FirstInteractiveFrameTime - InitializeTime) * 1000.0);
+	Report += FString::Printf(TEXT("Time until deferred work drained: %.2f ms (%llu frames)\n"), (DeferredCompleteTime - InitializeTime) * 1000.0, GFrameCounter - BeginPlayFrame);
+	Report += FString::Printf(TEXT("Critical phases: %.2f ms, deferred jobs: %.2f ms\n\n"), CriticalSeconds * 1000.0, DeferredSeconds * 1000.0);
+	Report += TEXT("Phase,Deferred,Frame,Ms\n");
+
+	for (const FPhaseRecord& Record : Phases)
+	{
+		Report += FString::Printf(TEXT("%s,%d,%llu,%.3f\n"), *Record.Name.ToString(), Record.bDeferred ? 1 : 0, Record.Frame - BeginPlayFrame, Record.Seconds * 1000.0);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s"), *Report);
+
+	const FString ReportPath = FPaths::ProfilingDir() / TEXT("CombatStartup") / FString::Printf(TEXT("%s_%s.csv"), *MapName, *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(Report, *ReportPath);
+}
+
+FScopedCombatStartupPhase::FScopedCombatStartupPhase(const UObject* WorldContextObject, FName InName)
+	: Subsystem(UCombatStartupSubsystem::Get(WorldContextObject))
+	, Name(InName)
+	, StartTime(FPlatformTime::Seconds())
+{
+}
+
+FScopedCombatStartupPhase::~FScopedCombatStartupPhase()
+{
+	if (UCombatStartupSubsystem* StartupSubsystem = Subsystem.Get())
+	{
+		StartupSubsystem->RecordPhase(Name, FPlatformTime::Seconds() - StartTime, false);
+	}
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatStartupSubsystem.generated.h"
+
+UENUM()
+enum class ECombatStartupPriority : uint8
+{
+	High,
+	Normal,
+	Low
+};
+
+/**
+ * Times level startup and spreads non-critical init work over the first frames.
+ * Critical steps are timed with FScopedCombatStartupPhase. Deferred jobs run in
+ * priority order within a per-frame budget. Once the queue drains, a startup
+ * report is written to Saved/Profiling/CombatStartup.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatStartupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UCombatStartupSubsystem* Get(const UObject* WorldContextObject);
+
+	// Queues Job on the world's startup subsystem, or runs it right away when there is none
+	static void Defer(const UObject* WorldContextObject, FName Name, ECombatStartupPriority Priority, TFunction<void()>&& Job);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	void RecordPhase(FName Name, double Seconds, bool bDeferred);
+
+	void EnqueueDeferred(FName Name, ECombatStartupPriority Priority, TFunction<void()>&& Job);
+
+	bool HasPendingJobs() const { return PendingJobs.Num() > 0; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FPhaseRecord
+	{
+		FName Name;
+		double Seconds = 0.0;
+		uint64 Frame = 0;
+		bool bDeferred = false;
+	};
+
+	struct FDeferredJob
+	{
+		FName Name;
+		ECombatStartupPriority Priority = ECombatStartupPriority::Normal;
+		uint64 Sequence = 0;
+		TFunction<void()> Job;
+	};
+
+	TArray<FPhaseRecord> Phases;
+
+	// Sorted by priority, then by enqueue order
+	TArray<FDeferredJob> PendingJobs;
+
+	uint64 NextJobSequence = 0;
+
+	double InitializeTime = 0.0;
+
+	double BeginPlayTime = 0.0;
+
+	double FirstInteractiveFrameTime = 0.0;
+
+	double DeferredCompleteTime = 0.0;
+
+	uint64 BeginPlayFrame = 0;
+
+	bool bReportWritten = false;
+
+	void WriteReport();
+};
+
+// Times the enclosing scope as a critical startup phase
+struct COMBATSYSTEM_API FScopedCombatStartupPhase
+{
+	FScopedCombatStartupPhase(const UObject* WorldContextObject, FName InName);
+
+	~FScopedCombatStartupPhase();
+
+private:
+
+	TWeakObjectPtr<UCombatStartupSubsystem> Subsystem;
+
+	FName Name;
+
+	double StartTime;
+};
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatStats.h"
+
+DEFINE_STAT(STAT_CombatWeaponFire);
+DEFINE_STAT(STAT_CombatEquipWeapon);
+DEFINE_STAT(STAT_CombatEnemyTick);
+DEFINE_STAT(STAT_CombatEnemyFire);
+DEFINE_STAT(STAT_CombatReceiveDamage);
+DEFINE_STAT(STAT_CombatCheckForWallRun);
+
+DEFINE_STAT(STAT_CombatTraces);
+DEFINE_STAT(STAT_CombatTracers);
+DEFINE_STAT(STAT_CombatEmitters);
+DEFINE_STAT(STAT_CombatSounds);
+DEFINE_STAT(STAT_CombatDamageEvents);
+DEFINE_STAT(STAT_CombatActiveEnemies);
+
+CSV_DEFINE_CATEGORY_MODULE(COMBATSYSTEM_API, Combat, true);
+
+FCombatCounterTotals GCombatCounterTotals;
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+// "stat CombatSystem" in development builds; the CSV category below also records in Test builds
+
+DECLARE_STATS_GROUP(TEXT("CombatSystem"), STATGROUP_CombatSystem, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Weapon Fire"), STAT_CombatWeaponFire, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Equip Weapon"), STAT_CombatEquipWeapon, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Tick"), STAT_CombatEnemyTick, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy FireAtPlayer"), STAT_CombatEnemyFire, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive Damage"), STAT_CombatReceiveDamage, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Check For Wall Run"), STAT_CombatCheckForWallRun, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_CombatTraces, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Tracers Spawned"), STAT_CombatTracers, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Emitters Spawned"), STAT_CombatEmitters, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sounds Spawned"), STAT_CombatSounds, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_CombatDamageEvents, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Enemies"), STAT_CombatActiveEnemies, STATGROUP_CombatSystem, COMBATSYSTEM_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(COMBATSYSTEM_API, Combat);
+
+// Running totals behind the counters above. Tools diff them across frames when the stats system isn't
+// available (Test builds, commandlets). Game thread only.
+struct FCombatCounterTotals
+{
+	uint64 Traces = 0;
+
+	uint64 Tracers = 0;
+
+	uint64 Emitters = 0;
+
+	uint64 Sounds = 0;
+
+	uint64 DamageEvents = 0;
+};
+
+extern COMBATSYSTEM_API FCombatCounterTotals GCombatCounterTotals;
+
+// Cycle stat and CSV timing for one combat hot path
+#define COMBAT_SCOPE_CYCLE_COUNTER(StatName, CsvName) \
+	SCOPE_CYCLE_COUNTER(StatName); \
+	CSV_SCOPED_TIMING_STAT(Combat, CsvName)
+
+// Adds Amount to a per-frame combat counter in the stat group, the CSV profile and the running totals
+#define COMBAT_COUNT(Counter, Amount) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_Combat##Counter, Amount); \
+		CSV_CUSTOM_STAT(Combat, Counter, static_cast<int32>(Amount), ECsvCustomStatOp::Accumulate); \
+		GCombatCounterTotals.Counter += (Amount); \
+	} while (0)
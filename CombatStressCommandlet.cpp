@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatStressCommandlet.h"
+#include "CombatHeadlessWorld.h"
+#include "CombatActorRegistry.h"
+#include "CombatStats.h"
+#include "EnemyBase.h"
+#include "PlayerCharacterController.h"
+#include "Engine/World.h"
+
+namespace CombatStress
+{
+	static constexpr float FrameDelta = 1.0f / 60.0f;
+
+	static constexpr int32 WarmupFrames = 60;
+
+	static constexpr int32 NumTiers = 3;
+
+	// Stand-in for a tier run without a -tierN class: later tiers fire faster and take more to bring down
+	struct FNativeTier
+	{
+		float FireRate;
+
+		float ShieldPool;
+
+		float HealthPool;
+	};
+
+	static const FNativeTier NativeTiers[NumTiers] =
+	{
+		{ 2.0f, 100.0f, 100.0f },
+		{ 3.0f, 150.0f, 150.0f },
+		{ 4.0f, 200.0f, 200.0f },
+	};
+
+	struct FSweepPoint
+	{
+		int32 EnemyCount = 0;
+
+		double P50Ms = 0.0;
+
+		double P95Ms = 0.0;
+
+		double P99Ms = 0.0;
+
+		double MaxMs = 0.0;
+
+		// Per-frame averages over the measured frames
+		double Traces = 0.0;
+
+		double Tracers = 0.0;
+
+		double Emitters = 0.0;
+
+		double Sounds = 0.0;
+
+		double ActiveTimers = 0.0;
+	};
+
+	static TArray<int32> ParseIntList(const FString& List)
+	{
+		TArray<FString> Parts;
+		List.ParseIntoArray(Parts, TEXT(","));
+
+		TArray<int32> Values;
+		for (const FString& Part : Parts)
+		{
+			Values.Add(FMath::Max(0, FCString::Atoi(*Part)));
+		}
+		return Values;
+	}
+
+	static double Percentile(const TArray<double>& Sorted, double Pct)
+	{
+		if (Sorted.Num() == 0) return 0.0;
+		return Sorted[FMath::Min(Sorted.Num() - 1, FMath::FloorToInt32(Sorted.Num() * Pct / 100.0))];
+	}
+
+	static FSweepPoint RunSweepPoint(int32 EnemyCount, const int32 (&TierMix)[NumTiers], UClass* const (&TierClasses)[NumTiers], int32 Frames)
+	{
+		FCombatHeadlessWorld HeadlessWorld;
+		UWorld* World = HeadlessWorld.GetWorld();
+
+		UCombatActorRegistry* Registry = UCombatActorRegistry::Get(World);
+
+		APlayerCharacterController* Player = HeadlessWorld.SpawnPlayer(FVector(0.0f, 0.0f, 100.0f));
+
+		// Split the count across tiers by the mix, the remainder goes to tier 1
+		int32 MixTotal = 0;
+		for (int32 Weight : TierMix)
+		{
+			MixTotal += Weight;
+		}
+		MixTotal = FMath::Max(MixTotal, 1);
+
+		TArray<AEnemyBase*> Enemies;
+		int32 Assigned = 0;
+		for (int32 Tier = NumTiers - 1; Tier >= 0; --Tier)
+		{
+			const int32 TierCount = Tier == 0 ? EnemyCount - Assigned : EnemyCount * TierMix[Tier] / MixTotal;
+			const int32 FirstEnemy = Enemies.Num();
+
+			// Each tier gets its own ring, inside the enemies' 5500 unit firing range
+			HeadlessWorld.SpawnFiringEnemies(Player, TierCount, 1500.0f + Tier * 1000.0f, Enemies, TierClasses[Tier]);
+
+			const FName TierTag(*FString::Printf(TEXT("EnemyTier%d"), Tier + 1));
+			for (int32 Index = FirstEnemy; Index < Enemies.Num(); ++Index)
+			{
+				AEnemyBase* Enemy = Enemies[Index];
+				Enemy->Tags.AddUnique(TierTag);
+
+				if (!TierClasses[Tier])
+				{
+					// Rearmed so the fire timer picks up the tier's rate
+					const FNativeTier& Native = NativeTiers[Tier];
+					Enemy->FireRate = Native.FireRate;
+					Enemy->MaxShieldPool = Native.ShieldPool;
+					Enemy->MaxHealthPool = Native.HealthPool;
+					Enemy->RestoreCombatState(Native.ShieldPool, Native.HealthPool);
+					FCombatHeadlessWorld::ArmEnemy(Enemy, Player);
+				}
+			}
+
+			Assigned += TierCount;
+		}
+
+		auto KeepPlayerAlive = [Player]()
+		{
+			if (Player && Player->CurrentHealthPool < Player->MaxHealthPool * 0.5f)
+			{
+				Player->RestoreCombatState(Player->MaxShieldPool, Player->MaxHealthPool);
+			}
+		};
+
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			KeepPlayerAlive();
+			HeadlessWorld.Tick(FrameDelta);
+		}
+
+		const FCombatCounterTotals StartTotals = GCombatCounterTotals;
+		int64 TimerSamples = 0;
+
+		TArray<double> FrameTimes;
+		FrameTimes.Reserve(Frames);
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			KeepPlayerAlive();
+			FrameTimes.Add(HeadlessWorld.Tick(FrameDelta));
+			TimerSamples += Registry ? Registry->CountActiveCombatTimers() : 0;
+		}
+
+		FrameTimes.Sort();
+
+		FSweepPoint Point;
+		Point.EnemyCount = Enemies.Num();
+		Point.P50Ms = Percentile(FrameTimes, 50.0);
+		Point.P95Ms = Percentile(FrameTimes, 95.0);
+		Point.P99Ms = Percentile(FrameTimes, 99.0);
+		Point.MaxMs = FrameTimes.Num() > 0 ? FrameTimes.Last() : 0.0;
+		Point.Traces = double(GCombatCounterTotals.Traces - StartTotals.Traces) / Frames;
+		Point.Tracers = double(GCombatCounterTotals.Tracers - StartTotals.Tracers) / Frames;
+		Point.Emitters = double(GCombatCounterTotals.Emitters - StartTotals.Emitters) / Frames;
+		Point.Sounds = double(GCombatCounterTotals.Sounds - StartTotals.Sounds) / Frames;
+		Point.ActiveTimers = double(TimerSamples) / Frames;
+		return Point;
+	}
+}
+
+UCombatStressCommandlet::UCombatStressCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatStressCommandlet::Main(const FString& Params)
+{
+	using namespace CombatStress;
+
+	FString CountsParam = TEXT("25,50,100,200,400,800");
+	FParse::Value(*Params, TEXT("counts="), CountsParam, false);
+	const TArray<int32> Counts = ParseIntList(CountsParam);
+
+	int32 TierMix[NumTiers] = { 1, 1, 1 };
+	FString MixParam;
+	if (FParse::Value(*Params, TEXT("mix="), MixParam, false))
+	{
+		const TArray<int32> Mix = ParseIntList(MixParam);
+		for (int32 Tier = 0; Tier < NumTiers; ++Tier)
+		{
+			TierMix[Tier] = Mix.IsValidIndex(Tier) ? Mix[Tier] : 0;
+		}
+	}
+
+	// Native enemies unless a tier names its content class
+	UClass* TierClasses[NumTiers] = {};
+	for (int32 Tier = 0; Tier < NumTiers; ++Tier)
+	{
+		FString ClassPath;
+		if (FParse::Value(*Params, *FString::Printf(TEXT("tier%d="), Tier + 1), ClassPath))
+		{
+			TierClasses[Tier] = LoadClass<AEnemyBase>(nullptr, *ClassPath);
+			if (!TierClasses[Tier])
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Tier %d class %s could not be loaded, using AEnemyBase."), Tier + 1, *ClassPath);
+			}
+		}
+
+		if (!TierClasses[Tier])
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Tier %d runs native enemies firing %.0f shots/s with %.0f shield and %.0f health. Pass -tier%d=<class path> to measure the real tier."),
+				Tier + 1, NativeTiers[Tier].FireRate, NativeTiers[Tier].ShieldPool, NativeTiers[Tier].HealthPool, Tier + 1);
+		}
+	}
+
+	int32 Frames = 600;
+	FParse::Value(*Params, TEXT("frames="), Frames);
+	Frames = FMath::Max(1, Frames);
+
+	float BudgetMs = 1000.0f / 60.0f;
+	FParse::Value(*Params, TEXT("budgetms="), BudgetMs);
+
+	UE_LOG(LogTemp, Display, TEXT("Combat stress sweep: %d frames at %.1f Hz, tier mix %d/%d/%d, budget %.2f ms (p95)"),
+		Frames, 1.0f / FrameDelta, TierMix[0], TierMix[1], TierMix[2], BudgetMs);
+	UE_LOG(LogTemp, Display, TEXT("%8s %8s %8s %8s %8s | per frame: %8s %8s %8s %8s %8s"),
+		TEXT("Enemies"), TEXT("p50 ms"), TEXT("p95 ms"), TEXT("p99 ms"), TEXT("max ms"), TEXT("traces"), TEXT("tracers"), TEXT("emitters"), TEXT("sounds"), TEXT("timers"));
+
+	int32 LastWithinBudget = INDEX_NONE;
+	int32 FirstOverBudget = INDEX_NONE;
+
+	for (int32 Count : Counts)
+	{
+		const FSweepPoint Point = RunSweepPoint(Count, TierMix, TierClasses, Frames);
+
+		UE_LOG(LogTemp, Display, TEXT("%8d %8.3f %8.3f %8.3f %8.3f | per frame: %8.2f %8.2f %8.2f %8.2f %8.1f"),
+			Point.EnemyCount, Point.P50Ms, Point.P95Ms, Point.P99Ms, Point.MaxMs, Point.Traces, Point.Tracers, Point.Emitters, Point.Sounds, Point.ActiveTimers);
+
+		if (Point.P95Ms > BudgetMs)
+		{
+			FirstOverBudget = Point.EnemyCount;
+			break;
+		}
+
+		LastWithinBudget = Point.EnemyCount;
+	}
+
+	if (FirstOverBudget == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Frame budget never exceeded, up to %d enemies."), LastWithinBudget);
+	}
+	else if (LastWithinBudget == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Frame budget already exceeded at %d enemies."), FirstOverBudget);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Display, TEXT("Frame budget exceeded between %d and %d enemies."), LastWithinBudget, FirstOverBudget);
+	}
+
+	return 0;
+}
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatStressCommandlet.generated.h"
+
+/**
+ * Enemy-count ceiling sweep. For each count a fresh headless world is filled with enemies
+ * split across the three tiers, all shooting at a stand-in player, and run at a fixed step:
+ *
+ *   UnrealEditor-Cmd <Project> -run=CombatStress -nullrhi -unattended
+ *     [-counts=25,50,100,200,400,800] [-mix=1,1,1] [-frames=600] [-budgetms=16.67]
+ *     [-tier1=<class path>] [-tier2=<class path>] [-tier3=<class path>]
+ *
+ * Tiers without a class run AEnemyBase with a fire rate and pools that grow with the tier,
+ * so the mix still matters; the sweep warns that those numbers are not the content's.
+ *
+ * Prints frame-time percentiles and per-frame traces, tracers, emitters, sounds and active
+ * combat timers for every count, then the first count whose p95 frame exceeds the budget.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatStressCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatStressCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
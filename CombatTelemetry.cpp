@@ -0,0 +1,459 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatTelemetry.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DelayedAutoRegister.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace CombatTelemetry
+{
+	std::atomic<bool> GIsRecording{ false };
+}
+
+namespace CombatTelemetryImpl
+{
+	// 16k records, 512 KB per recording thread
+	static constexpr uint32 RingCapacity = 1 << 14;
+
+	static constexpr uint32 RingMask = RingCapacity - 1;
+
+	// The writer wakes this often; a ring fills in no less than a few seconds at combat rates
+	static constexpr float WriterIntervalSeconds = 0.05f;
+
+	// One producer (the owning thread), one consumer (the writer). Rings are never freed, a
+	// thread that exits leaves its ring to be drained and reused by nobody.
+	struct FRing
+	{
+		FCombatTelemetryRecord Records[RingCapacity];
+
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head{ 0 };
+
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail{ 0 };
+
+		std::atomic<uint32> Dropped{ 0 };
+
+		void Push(const FCombatTelemetryRecord& Record)
+		{
+			const uint32 H = Head.load(std::memory_order_relaxed);
+			if (H - Tail.load(std::memory_order_acquire) >= RingCapacity)
+			{
+				Dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			Records[H & RingMask] = Record;
+			Head.store(H + 1, std::memory_order_release);
+		}
+
+		// Appends an 'R' chunk with everything published so far
+		void Drain(TArray<uint8>& Out)
+		{
+			const uint32 T = Tail.load(std::memory_order_relaxed);
+			const uint32 H = Head.load(std::memory_order_acquire);
+			const uint32 Count = H - T;
+			if (Count == 0) return;
+
+			Out.Add('R');
+			Out.Append(reinterpret_cast<const uint8*>(&Count), sizeof(Count));
+
+			// At most two contiguous spans, before and after the wrap
+			const uint32 First = FMath::Min(Count, RingCapacity - (T & RingMask));
+			Out.Append(reinterpret_cast<const uint8*>(&Records[T & RingMask]), First * sizeof(FCombatTelemetryRecord));
+			Out.Append(reinterpret_cast<const uint8*>(&Records[0]), (Count - First) * sizeof(FCombatTelemetryRecord));
+
+			Tail.store(H, std::memory_order_release);
+		}
+
+		// Only while no writer is running
+		void Discard()
+		{
+			Tail.store(Head.load(std::memory_order_acquire), std::memory_order_release);
+			Dropped.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	static FCriticalSection RingsLock;
+
+	static TArray<FRing*> Rings;
+
+	static thread_local FRing* LocalRing = nullptr;
+
+	static FRing& GetLocalRing()
+	{
+		if (!LocalRing)
+		{
+			LocalRing = new FRing();
+
+			FScopeLock Lock(&RingsLock);
+			Rings.Add(LocalRing);
+		}
+		return *LocalRing;
+	}
+
+	static FRWLock NamesLock;
+
+	static TMap<FName, uint16> NameIds;
+
+	// Interned since the writer last ran, written ahead of the records
+	static TArray<TPair<FName, uint16>> PendingNames;
+
+	// Bumped with NamesLock held whenever NameIds is reset, so thread caches of an earlier file are dropped
+	static std::atomic<uint32> NamesGeneration{ 0 };
+
+	// Ids this thread has already looked up, read without NamesLock
+	struct FLocalNameCache
+	{
+		uint32 Generation = 0;
+
+		TMap<FName, uint16> Ids;
+	};
+
+	static thread_local FLocalNameCache LocalNames;
+
+	static uint16 InternSharedName(FName Name)
+	{
+		{
+			FReadScopeLock Lock(NamesLock);
+			if (const uint16* Id = NameIds.Find(Name))
+			{
+				return *Id;
+			}
+		}
+
+		FWriteScopeLock Lock(NamesLock);
+		if (const uint16* Id = NameIds.Find(Name))
+		{
+			return *Id;
+		}
+
+		// Id 0 is none; past the last id names are simply not recorded
+		if (NameIds.Num() >= MAX_uint16) return 0;
+
+		const uint16 Id = uint16(NameIds.Num() + 1);
+		NameIds.Add(Name, Id);
+		PendingNames.Emplace(Name, Id);
+		return Id;
+	}
+
+	static void DrainNames(TArray<uint8>& Out)
+	{
+		TArray<TPair<FName, uint16>> Names;
+		{
+			FWriteScopeLock Lock(NamesLock);
+			Names = MoveTemp(PendingNames);
+			PendingNames.Reset();
+		}
+
+		for (const TPair<FName, uint16>& Name : Names)
+		{
+			const uint16 Id = Name.Value;
+			const FTCHARToUTF8 Utf8(*Name.Key.ToString());
+			const uint16 Length = uint16(FMath::Min(Utf8.Length(), int32(MAX_uint16)));
+
+			Out.Add('N');
+			Out.Append(reinterpret_cast<const uint8*>(&Id), sizeof(Id));
+			Out.Append(reinterpret_cast<const uint8*>(&Length), sizeof(Length));
+			Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Length);
+		}
+	}
+
+	class FWriter : public FRunnable
+	{
+	public:
+
+		explicit FWriter(IFileHandle* InFile)
+			: File(InFile)
+		{
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopRequested.load(std::memory_order_relaxed))
+			{
+				FPlatformProcess::Sleep(WriterIntervalSeconds);
+				Flush();
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopRequested.store(true, std::memory_order_relaxed);
+		}
+
+		// Writer thread while running, the caller of CombatTelemetry::Stop after it has exited.
+		// Returns the records dropped since the last flush that wrote them.
+		uint32 Flush(bool bWriteDropped = false)
+		{
+			Buffer.Reset();
+
+			// Names first, so a reader usually knows a name by the time a record uses it
+			DrainNames(Buffer);
+
+			uint32 Dropped = 0;
+			{
+				FScopeLock Lock(&RingsLock);
+				for (FRing* Ring : Rings)
+				{
+					Ring->Drain(Buffer);
+					if (bWriteDropped)
+					{
+						Dropped += Ring->Dropped.exchange(0, std::memory_order_relaxed);
+					}
+				}
+			}
+
+			if (Dropped > 0)
+			{
+				Buffer.Add('D');
+				Buffer.Append(reinterpret_cast<const uint8*>(&Dropped), sizeof(Dropped));
+			}
+
+			if (Buffer.Num() > 0)
+			{
+				File->Write(Buffer.GetData(), Buffer.Num());
+				BytesWritten += Buffer.Num();
+			}
+			return Dropped;
+		}
+
+		IFileHandle* File = nullptr;
+
+		int64 BytesWritten = 0;
+
+	private:
+
+		std::atomic<bool> bStopRequested{ false };
+
+		TArray<uint8> Buffer;
+	};
+
+	// Start and Stop come from the game thread only
+	static FWriter* Writer = nullptr;
+
+	static FRunnableThread* WriterThread = nullptr;
+
+	static FString FilePath;
+
+	static uint32 ObjectId(const UObject* Object)
+	{
+		return Object ? Object->GetUniqueID() : 0;
+	}
+
+	static FCombatTelemetryRecord MakeRecord(ECombatTelemetryEvent Type, const UObject* Source)
+	{
+		FCombatTelemetryRecord Record;
+		Record.Cycles = FPlatformTime::Cycles64();
+		Record.Type = Type;
+		Record.SourceId = ObjectId(Source);
+		return Record;
+	}
+
+	static FAutoConsoleCommand StartCommand(
+		TEXT("Combat.Telemetry.Start"),
+		TEXT("Record binary combat telemetry. Combat.Telemetry.Start [File], decode it with -run=CombatTelemetryDecode."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			CombatTelemetry::Start(Args.Num() > 0 ? Args[0] : FString());
+		}));
+
+	static FAutoConsoleCommand StopCommand(
+		TEXT("Combat.Telemetry.Stop"),
+		TEXT("Stop recording combat telemetry and close the file."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			CombatTelemetry::Stop();
+		}));
+
+	// -CombatTelemetry[=File] records from startup; whatever is recording is closed on exit
+	static FDelayedAutoRegisterHelper RegisterStartup(EDelayedRegisterRunPhase::EndOfEngineInit, []()
+	{
+		FString Path;
+		if (FParse::Value(FCommandLine::Get(), TEXT("CombatTelemetry="), Path) || FParse::Param(FCommandLine::Get(), TEXT("CombatTelemetry")))
+		{
+			CombatTelemetry::Start(Path);
+		}
+
+		FCoreDelegates::OnPreExit.AddStatic(&CombatTelemetry::Stop);
+	});
+}
+
+bool CombatTelemetry::Start(const FString& InFilePath)
+{
+	using namespace CombatTelemetryImpl;
+
+	check(IsInGameThread());
+
+	if (Writer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Combat telemetry is already recording to %s"), *FilePath);
+		return false;
+	}
+
+	FilePath = !InFilePath.IsEmpty() ? InFilePath
+		: FPaths::ProfilingDir() / TEXT("CombatTelemetry") / FString::Printf(TEXT("Telemetry_%s.ctel"), *FDateTime::Now().ToString());
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	IFileHandle* File = PlatformFile.OpenWrite(*FilePath);
+	if (!File)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open %s for combat telemetry"), *FilePath);
+		return false;
+	}
+
+	// Leftovers from a record that raced the last Stop, and names the new file does not define
+	{
+		FScopeLock Lock(&RingsLock);
+		for (FRing* Ring : Rings)
+		{
+			Ring->Discard();
+		}
+	}
+	{
+		FWriteScopeLock Lock(NamesLock);
+		NameIds.Reset();
+		PendingNames.Reset();
+		NamesGeneration.fetch_add(1, std::memory_order_release);
+	}
+
+	FFileHeader Header;
+	Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	Header.StartCycles = FPlatformTime::Cycles64();
+	File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+	Writer = new FWriter(File);
+	WriterThread = FRunnableThread::Create(Writer, TEXT("CombatTelemetryWriter"), 0, TPri_BelowNormal);
+
+	GIsRecording.store(true, std::memory_order_relaxed);
+
+	UE_LOG(LogTemp, Display, TEXT("Recording combat telemetry to %s"), *FilePath);
+	return true;
+}
+
+void CombatTelemetry::Stop()
+{
+	using namespace CombatTelemetryImpl;
+
+	if (!Writer) return;
+
+	GIsRecording.store(false, std::memory_order_relaxed);
+
+	// Kill stops the runnable and waits for its last pass, the final flush here picks up the rest
+	WriterThread->Kill(true);
+	delete WriterThread;
+	WriterThread = nullptr;
+
+	const uint32 Dropped = Writer->Flush(true);
+
+	IFileHandle* File = Writer->File;
+	const int64 BytesWritten = Writer->BytesWritten + sizeof(FFileHeader);
+	delete Writer;
+	Writer = nullptr;
+
+	delete File;
+
+	UE_LOG(LogTemp, Display, TEXT("Combat telemetry written to %s (%lld bytes, %u records dropped on full rings)"), *FilePath, BytesWritten, Dropped);
+}
+
+uint16 CombatTelemetry::InternName(FName Name)
+{
+	using namespace CombatTelemetryImpl;
+
+	if (Name.IsNone()) return 0;
+
+	FLocalNameCache& Cache = LocalNames;
+	const uint32 Generation = NamesGeneration.load(std::memory_order_acquire);
+	if (Cache.Generation != Generation)
+	{
+		Cache.Ids.Reset();
+		Cache.Generation = Generation;
+	}
+
+	if (const uint16* Id = Cache.Ids.Find(Name))
+	{
+		return *Id;
+	}
+
+	const uint16 Id = InternSharedName(Name);
+	if (Id != 0)
+	{
+		Cache.Ids.Add(Name, Id);
+	}
+	return Id;
+}
+
+void CombatTelemetry::Record(const FCombatTelemetryRecord& Record)
+{
+	CombatTelemetryImpl::GetLocalRing().Push(Record);
+}
+
+const TCHAR* CombatTelemetry::GetEventName(ECombatTelemetryEvent Type)
+{
+	switch (Type)
+	{
+	case ECombatTelemetryEvent::ShotFired: return TEXT("ShotFired");
+	case ECombatTelemetryEvent::Hit: return TEXT("Hit");
+	case ECombatTelemetryEvent::DamageApplied: return TEXT("DamageApplied");
+	case ECombatTelemetryEvent::EnemyDied: return TEXT("EnemyDied");
+	case ECombatTelemetryEvent::ReloadStarted: return TEXT("ReloadStarted");
+	case ECombatTelemetryEvent::ReloadFinished: return TEXT("ReloadFinished");
+	default: return TEXT("Unknown");
+	}
+}
+
+void CombatTelemetry::ShotFired(const UObject* Shooter, FName Weapon, int32 ShotCount, int32 AmmoLeft)
+{
+	FCombatTelemetryRecord Record = CombatTelemetryImpl::MakeRecord(ECombatTelemetryEvent::ShotFired, Shooter);
+	Record.NameId = InternName(Weapon);
+	Record.Values[0] = float(FMath::Max(AmmoLeft, 0));
+	Record.Values[1] = float(ShotCount);
+	Record.Flags = AmmoLeft == INDEX_NONE ? FCombatTelemetryRecord::FlagNoAmmo : 0;
+	CombatTelemetry::Record(Record);
+}
+
+void CombatTelemetry::Hit(const UObject* Shooter, const UObject* Target, float Damage)
+{
+	FCombatTelemetryRecord Record = CombatTelemetryImpl::MakeRecord(ECombatTelemetryEvent::Hit, Shooter);
+	Record.TargetId = CombatTelemetryImpl::ObjectId(Target);
+	Record.Values[0] = Damage;
+	CombatTelemetry::Record(Record);
+}
+
+void CombatTelemetry::DamageApplied(const UObject* Target, float Amount, float ShieldPool, float HealthPool, bool bShieldBroken)
+{
+	FCombatTelemetryRecord Record = CombatTelemetryImpl::MakeRecord(ECombatTelemetryEvent::DamageApplied, Target);
+	Record.Values[0] = Amount;
+	Record.Values[1] = ShieldPool;
+	Record.Values[2] = HealthPool;
+	Record.Flags = bShieldBroken ? FCombatTelemetryRecord::FlagShieldBroken : 0;
+	CombatTelemetry::Record(Record);
+}
+
+void CombatTelemetry::EnemyDied(const UObject* Enemy)
+{
+	CombatTelemetry::Record(CombatTelemetryImpl::MakeRecord(ECombatTelemetryEvent::EnemyDied, Enemy));
+}
+
+void CombatTelemetry::ReloadStarted(const UObject* Owner, FName Weapon)
+{
+	FCombatTelemetryRecord Record = CombatTelemetryImpl::MakeRecord(ECombatTelemetryEvent::ReloadStarted, Owner);
+	Record.NameId = InternName(Weapon);
+	CombatTelemetry::Record(Record);
+}
+
+void CombatTelemetry::ReloadFinished(const UObject* Owner, FName Weapon)
+{
+	FCombatTelemetryRecord Record = CombatTelemetryImpl::MakeRecord(ECombatTelemetryEvent::ReloadFinished, Owner);
+	Record.NameId = InternName(Weapon);
+	CombatTelemetry::Record(Record);
+}
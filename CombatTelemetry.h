@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Per-shot and per-hit UE_LOG lines. Off by default: under load the formatting and the log
+// devices cost more than the shot itself. Build with COMBAT_HOTPATH_LOGS=1 to get them back.
+#ifndef COMBAT_HOTPATH_LOGS
+#define COMBAT_HOTPATH_LOGS 0
+#endif
+
+#if COMBAT_HOTPATH_LOGS
+#define COMBAT_HOTPATH_LOG(Verbosity, Format, ...) UE_LOG(LogTemp, Verbosity, Format, ##__VA_ARGS__)
+#else
+#define COMBAT_HOTPATH_LOG(Verbosity, Format, ...) do {} while (0)
+#endif
+
+enum class ECombatTelemetryEvent : uint8
+{
+	// Source shooter, Name weapon, Values ammo left and shots in the batch, NoAmmo flag when the shooter has no ammo count
+	ShotFired,
+	// Source shooter, Target hit actor, Value0 damage
+	Hit,
+	// Source damaged actor, Values amount, shield and health after the hit, ShieldBroken flag
+	DamageApplied,
+	EnemyDied,
+	// Source owner, Name weapon
+	ReloadStarted,
+	ReloadFinished,
+	Num
+};
+
+// Fixed-size event record, written as is to the telemetry file
+struct FCombatTelemetryRecord
+{
+	uint64 Cycles = 0;
+
+	// UObject::GetUniqueID, 0 for none
+	uint32 SourceId = 0;
+
+	uint32 TargetId = 0;
+
+	float Values[3] = {};
+
+	// Interned with CombatTelemetry::InternName, 0 for none
+	uint16 NameId = 0;
+
+	ECombatTelemetryEvent Type = ECombatTelemetryEvent::Num;
+
+	uint8 Flags = 0;
+
+	static constexpr uint8 FlagShieldBroken = 1 << 0;
+
+	static constexpr uint8 FlagNoAmmo = 1 << 1;
+};
+
+static_assert(sizeof(FCombatTelemetryRecord) == 32, "Telemetry records are read back by size, bump FileVersion when the layout changes");
+
+/**
+ * Binary combat telemetry. Recording threads write fixed-size records into their own
+ * lock-free single-producer ring; a background writer drains every ring a few times a
+ * second into a compact file under Saved/Profiling/CombatTelemetry. Records that find
+ * their ring full are dropped and counted, the game thread never waits on the writer.
+ * Decode a file with -run=CombatTelemetryDecode.
+ *
+ * Start with -CombatTelemetry on the command line or Combat.Telemetry.Start [File].
+ */
+namespace CombatTelemetry
+{
+	// File layout: header, then chunks. A chunk is a one-byte kind followed by its payload:
+	// 'N' uint16 id, uint16 length, UTF-8 name; 'R' uint32 count, records; 'D' uint32 records dropped.
+	static constexpr uint32 FileMagic = 0x4C455443; // "CTEL"
+
+	static constexpr uint32 FileVersion = 1;
+
+	struct FFileHeader
+	{
+		uint32 Magic = FileMagic;
+
+		uint32 Version = FileVersion;
+
+		uint32 RecordSize = sizeof(FCombatTelemetryRecord);
+
+		uint32 Padding = 0;
+
+		double SecondsPerCycle = 0.0;
+
+		uint64 StartCycles = 0;
+	};
+
+	extern COMBATSYSTEM_API std::atomic<bool> GIsRecording;
+
+	FORCEINLINE bool IsRecording() { return GIsRecording.load(std::memory_order_relaxed); }
+
+	// Empty path records to a new file in Saved/Profiling/CombatTelemetry
+	COMBATSYSTEM_API bool Start(const FString& FilePath = FString());
+
+	// Drains every ring and closes the file
+	COMBATSYSTEM_API void Stop();
+
+	// Stable small id for a name, written to the file once. Only a name's first use on each thread takes a lock.
+	COMBATSYSTEM_API uint16 InternName(FName Name);
+
+	COMBATSYSTEM_API void Record(const FCombatTelemetryRecord& Record);
+
+	COMBATSYSTEM_API const TCHAR* GetEventName(ECombatTelemetryEvent Type);
+
+	// AmmoLeft INDEX_NONE for shooters that don't count ammo
+	COMBATSYSTEM_API void ShotFired(const UObject* Shooter, FName Weapon, int32 ShotCount, int32 AmmoLeft);
+
+	COMBATSYSTEM_API void Hit(const UObject* Shooter, const UObject* Target, float Damage);
+
+	// Pools are the target's values after the damage is applied
+	COMBATSYSTEM_API void DamageApplied(const UObject* Target, float Amount, float ShieldPool, float HealthPool, bool bShieldBroken);
+
+	COMBATSYSTEM_API void EnemyDied(const UObject* Enemy);
+
+	COMBATSYSTEM_API void ReloadStarted(const UObject* Owner, FName Weapon);
+
+	COMBATSYSTEM_API void ReloadFinished(const UObject* Owner, FName Weapon);
+}
+
+// Costs one relaxed load when nothing is recording
+#define COMBAT_TELEMETRY(EventName, ...) \
+	do { if (CombatTelemetry::IsRecording()) { CombatTelemetry::EventName(__VA_ARGS__); } } while (0)
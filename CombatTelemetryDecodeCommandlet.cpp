@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatTelemetryDecodeCommandlet.h"
+#include "CombatTelemetry.h"
+#include "Misc/FileHelper.h"
+
+namespace CombatTelemetryDecode
+{
+	// Walks the chunks after the header; false when the file is cut short or corrupt
+	struct FChunkReader
+	{
+		const TArray<uint8>& Bytes;
+
+		int64 Offset = sizeof(CombatTelemetry::FFileHeader);
+
+		template<typename T>
+		bool Read(T& Out)
+		{
+			if (Offset + int64(sizeof(T)) > Bytes.Num()) return false;
+			FMemory::Memcpy(&Out, Bytes.GetData() + Offset, sizeof(T));
+			Offset += sizeof(T);
+			return true;
+		}
+
+		bool Skip(int64 Size)
+		{
+			if (Offset + Size > Bytes.Num()) return false;
+			Offset += Size;
+			return true;
+		}
+
+		// Calls OnName(Id, Name), OnRecords(Records, Count) and OnDropped(Count) per chunk
+		template<typename NameFn, typename RecordsFn, typename DroppedFn>
+		bool ForEachChunk(NameFn&& OnName, RecordsFn&& OnRecords, DroppedFn&& OnDropped)
+		{
+			while (Offset < Bytes.Num())
+			{
+				uint8 Kind = 0;
+				Read(Kind);
+
+				if (Kind == 'N')
+				{
+					uint16 Id = 0;
+					uint16 Length = 0;
+					if (!Read(Id) || !Read(Length) || Offset + Length > Bytes.Num()) return false;
+
+					const FUTF8ToTCHAR Name(reinterpret_cast<const ANSICHAR*>(Bytes.GetData() + Offset), Length);
+					OnName(Id, FString(Name.Length(), Name.Get()));
+					Skip(Length);
+				}
+				else if (Kind == 'R')
+				{
+					uint32 Count = 0;
+					if (!Read(Count)) return false;
+
+					const int64 Size = int64(Count) * sizeof(FCombatTelemetryRecord);
+					if (Offset + Size > Bytes.Num()) return false;
+
+					// Chunks are packed, so records are copied out rather than read in place
+					TArray<FCombatTelemetryRecord> Records;
+					Records.SetNumUninitialized(Count);
+					FMemory::Memcpy(Records.GetData(), Bytes.GetData() + Offset, Size);
+					OnRecords(Records);
+					Skip(Size);
+				}
+				else if (Kind == 'D')
+				{
+					uint32 Count = 0;
+					if (!Read(Count)) return false;
+					OnDropped(Count);
+				}
+				else
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	static FString FormatText(const FCombatTelemetryRecord& Record, double Seconds, const FString& Name)
+	{
+		const TCHAR* Event = CombatTelemetry::GetEventName(Record.Type);
+
+		switch (Record.Type)
+		{
+		case ECombatTelemetryEvent::ShotFired:
+			if (Record.Flags & FCombatTelemetryRecord::FlagNoAmmo)
+			{
+				return FString::Printf(TEXT("%12.6f %-14s #%u %s x%d"), Seconds, Event, Record.SourceId, *Name, int32(Record.Values[1]));
+			}
+			return FString::Printf(TEXT("%12.6f %-14s #%u %s x%d, %d ammo left"), Seconds, Event, Record.SourceId, *Name, int32(Record.Values[1]), int32(Record.Values[0]));
+		case ECombatTelemetryEvent::Hit:
+			return FString::Printf(TEXT("%12.6f %-14s #%u -> #%u for %.1f"), Seconds, Event, Record.SourceId, Record.TargetId, Record.Values[0]);
+		case ECombatTelemetryEvent::DamageApplied:
+			return FString::Printf(TEXT("%12.6f %-14s #%u %.1f, shield %.1f health %.1f%s"), Seconds, Event, Record.SourceId,
+				Record.Values[0], Record.Values[1], Record.Values[2], (Record.Flags & FCombatTelemetryRecord::FlagShieldBroken) ? TEXT(", shield broken") : TEXT(""));
+		case ECombatTelemetryEvent::ReloadStarted:
+		case ECombatTelemetryEvent::ReloadFinished:
+			return FString::Printf(TEXT("%12.6f %-14s #%u %s"), Seconds, Event, Record.SourceId, *Name);
+		default:
+			return FString::Printf(TEXT("%12.6f %-14s #%u"), Seconds, Event, Record.SourceId);
+		}
+	}
+
+	static FString FormatCsv(const FCombatTelemetryRecord& Record, double Seconds, const FString& Name)
+	{
+		return FString::Printf(TEXT("%.6f,%s,%u,%u,%s,%g,%g,%g,%u"), Seconds, CombatTelemetry::GetEventName(Record.Type),
+			Record.SourceId, Record.TargetId, *Name, Record.Values[0], Record.Values[1], Record.Values[2], uint32(Record.Flags));
+	}
+}
+
+UCombatTelemetryDecodeCommandlet::UCombatTelemetryDecodeCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatTelemetryDecodeCommandlet::Main(const FString& Params)
+{
+	using namespace CombatTelemetryDecode;
+
+	FString InPath;
+	if (!FParse::Value(*Params, TEXT("in="), InPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=CombatTelemetryDecode -in=<file.ctel> [-csv] [-out=<file>]"));
+		return 1;
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *InPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read %s"), *InPath);
+		return 1;
+	}
+
+	CombatTelemetry::FFileHeader Header;
+	if (Bytes.Num() < int32(sizeof(Header)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is too short for a telemetry file"), *InPath);
+		return 1;
+	}
+	FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(Header));
+
+	if (Header.Magic != CombatTelemetry::FileMagic || Header.Version != CombatTelemetry::FileVersion || Header.RecordSize != sizeof(FCombatTelemetryRecord))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a version %u combat telemetry file"), *InPath, CombatTelemetry::FileVersion);
+		return 1;
+	}
+
+	// Names can follow the first record that uses them, so they are all read up front
+	TMap<uint16, FString> Names;
+	{
+		FChunkReader Reader{ Bytes };
+		Reader.ForEachChunk(
+			[&Names](uint16 Id, FString&& Name) { Names.Add(Id, MoveTemp(Name)); },
+			[](const TArray<FCombatTelemetryRecord>&) {},
+			[](uint32) {});
+	}
+
+	const bool bCsv = FParse::Param(*Params, TEXT("csv"));
+
+	FString OutPath;
+	const bool bToFile = FParse::Value(*Params, TEXT("out="), OutPath);
+
+	FString Output;
+	if (bCsv)
+	{
+		Output += TEXT("Seconds,Event,Source,Target,Name,Value0,Value1,Value2,Flags\n");
+	}
+
+	int64 Counts[uint8(ECombatTelemetryEvent::Num) + 1] = {};
+	int64 Dropped = 0;
+
+	FChunkReader Reader{ Bytes };
+	const bool bComplete = Reader.ForEachChunk(
+		[](uint16, FString&&) {},
+		[&](const TArray<FCombatTelemetryRecord>& Records)
+		{
+			for (const FCombatTelemetryRecord& Record : Records)
+			{
+				Counts[FMath::Min(uint8(Record.Type), uint8(ECombatTelemetryEvent::Num))]++;
+
+				const double Seconds = double(int64(Record.Cycles - Header.StartCycles)) * Header.SecondsPerCycle;
+				const FString* Name = Names.Find(Record.NameId);
+				const FString Line = bCsv ? FormatCsv(Record, Seconds, Name ? *Name : FString()) : FormatText(Record, Seconds, Name ? *Name : FString());
+
+				if (bToFile)
+				{
+					Output += Line;
+					Output += TEXT("\n");
+				}
+				else
+				{
+					UE_LOG(LogTemp, Display, TEXT("%s"), *Line);
+				}
+			}
+		},
+		[&Dropped](uint32 Count) { Dropped += Count; });
+
+	if (!bComplete)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is truncated or corrupt at byte %lld, decoded what came before"), *InPath, Reader.Offset);
+	}
+
+	if (bToFile)
+	{
+		if (!FFileHelper::SaveStringToFile(Output, *OutPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write %s"), *OutPath);
+			return 1;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Decoded telemetry written to %s"), *OutPath);
+	}
+
+	for (uint8 Type = 0; Type <= uint8(ECombatTelemetryEvent::Num); ++Type)
+	{
+		if (Counts[Type] > 0)
+		{
+			UE_LOG(LogTemp, Display, TEXT("%-14s %lld"), CombatTelemetry::GetEventName(ECombatTelemetryEvent(Type)), Counts[Type]);
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("%lld records dropped on full rings"), Dropped);
+
+	return bComplete ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatTelemetryDecodeCommandlet.generated.h"
+
+/**
+ * Offline decoder for combat telemetry files (CombatTelemetry.h):
+ *
+ *   UnrealEditor-Cmd <Project> -run=CombatTelemetryDecode -in=<file.ctel> [-csv] [-out=<file>]
+ *
+ * Prints one line per event, seconds since the recording started, as text or as CSV, to the
+ * log or to -out. Event counts and records dropped on full rings are logged at the end.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCombatTelemetryDecodeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatTelemetryDecodeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatTrace.h"
+
+#if COMBAT_TRACE_ENABLED
+
+#include "Trace/Trace.inl"
+#include "GameFramework/Actor.h"
+
+UE_TRACE_CHANNEL(CombatChannel)
+
+UE_TRACE_EVENT_BEGIN(Combat, ShotFired)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, ShooterId)
+	UE_TRACE_EVENT_FIELD(int32, ShotCount)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Weapon)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, TraceIssued)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, ShooterId)
+	UE_TRACE_EVENT_FIELD(uint32, TraceId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, TraceResolved)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, ShooterId)
+	UE_TRACE_EVENT_FIELD(uint32, TraceId)
+	UE_TRACE_EVENT_FIELD(uint32, TargetId)
+	UE_TRACE_EVENT_FIELD(bool, bHit)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, DamageApplied)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, TargetId)
+	UE_TRACE_EVENT_FIELD(float, Amount)
+	UE_TRACE_EVENT_FIELD(float, ShieldPool)
+	UE_TRACE_EVENT_FIELD(float, HealthPool)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, ShieldBroken)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, TargetId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, EnemyDied)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, EnemyId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, Reload)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, OwnerId)
+	UE_TRACE_EVENT_FIELD(bool, bStarted)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Weapon)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, WeaponSwitched)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, OwnerId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, FromWeapon)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, ToWeapon)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Combat, WallRun)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, CharacterId)
+	UE_TRACE_EVENT_FIELD(uint32, WallId)
+	UE_TRACE_EVENT_FIELD(bool, bStarted)
+	UE_TRACE_EVENT_FIELD(bool, bRightSide)
+UE_TRACE_EVENT_END()
+
+namespace CombatTrace
+{
+	namespace
+	{
+		// Weapon and enemy traces both run on the game thread
+		uint32 LastTraceId = 0;
+
+		uint32 GetId(const UObject* Object)
+		{
+			return Object ? Object->GetUniqueID() : 0;
+		}
+
+		bool IsEnabled()
+		{
+			return UE_TRACE_CHANNELEXPR_IS_ENABLED(CombatChannel);
+		}
+
+		void LogReload(const UObject* Owner, FName Weapon, bool bStarted)
+		{
+			if (!IsEnabled()) return;
+
+			const FString WeaponName = Weapon.ToString();
+
+			UE_TRACE_LOG(Combat, Reload, CombatChannel)
+				<< Reload.Cycle(FPlatformTime::Cycles64())
+				<< Reload.OwnerId(GetId(Owner))
+				<< Reload.bStarted(bStarted)
+				<< Reload.Weapon(*WeaponName, WeaponName.Len());
+		}
+
+		void LogWallRun(const UObject* Character, const AActor* Wall, bool bStarted, bool bRightSide)
+		{
+			UE_TRACE_LOG(Combat, WallRun, CombatChannel)
+				<< WallRun.Cycle(FPlatformTime::Cycles64())
+				<< WallRun.CharacterId(GetId(Character))
+				<< WallRun.WallId(GetId(Wall))
+				<< WallRun.bStarted(bStarted)
+				<< WallRun.bRightSide(bRightSide);
+		}
+	}
+
+	void ShotFired(const UObject* Shooter, FName Weapon, int32 ShotCount)
+	{
+		if (!IsEnabled()) return;
+
+		const FString WeaponName = Weapon.ToString();
+
+		UE_TRACE_LOG(Combat, ShotFired, CombatChannel)
+			<< ShotFired.Cycle(FPlatformTime::Cycles64())
+			<< ShotFired.ShooterId(GetId(Shooter))
+			<< ShotFired.ShotCount(ShotCount)
+			<< ShotFired.Weapon(*WeaponName, WeaponName.Len());
+	}
+
+	void TraceIssued(const UObject* Shooter)
+	{
+		++LastTraceId;
+
+		UE_TRACE_LOG(Combat, TraceIssued, CombatChannel)
+			<< TraceIssued.Cycle(FPlatformTime::Cycles64())
+			<< TraceIssued.ShooterId(GetId(Shooter))
+			<< TraceIssued.TraceId(LastTraceId);
+	}
+
+	void TraceResolved(const UObject* Shooter, const AActor* HitActor, bool bHit)
+	{
+		UE_TRACE_LOG(Combat, TraceResolved, CombatChannel)
+			<< TraceResolved.Cycle(FPlatformTime::Cycles64())
+			<< TraceResolved.ShooterId(GetId(Shooter))
+			<< TraceResolved.TraceId(LastTraceId)
+			<< TraceResolved.TargetId(GetId(HitActor))
+			<< TraceResolved.bHit(bHit);
+	}
+
+	void DamageApplied(const UObject* Target, float Amount, float ShieldPool, float HealthPool)
+	{
+		UE_TRACE_LOG(Combat, DamageApplied, CombatChannel)
+			<< DamageApplied.Cycle(FPlatformTime::Cycles64())
+			<< DamageApplied.TargetId(GetId(Target))
+			<< DamageApplied.Amount(Amount)
+			<< DamageApplied.ShieldPool(ShieldPool)
+			<< DamageApplied.HealthPool(HealthPool);
+	}
+
+	void ShieldBroken(const UObject* Target)
+	{
+		UE_TRACE_LOG(Combat, ShieldBroken, CombatChannel)
+			<< ShieldBroken.Cycle(FPlatformTime::Cycles64())
+			<< ShieldBroken.TargetId(GetId(Target));
+	}
+
+	void EnemyDied(const UObject* Enemy)
+	{
+		UE_TRACE_LOG(Combat, EnemyDied, CombatChannel)
+			<< EnemyDied.Cycle(FPlatformTime::Cycles64())
+			<< EnemyDied.EnemyId(GetId(Enemy));
+	}
+
+	void ReloadStarted(const UObject* Owner, FName Weapon)
+	{
+		LogReload(Owner, Weapon, true);
+	}
+
+	void ReloadFinished(const UObject* Owner, FName Weapon)
+	{
+		LogReload(Owner, Weapon, false);
+	}
+
+	void WeaponSwitched(const UObject* Owner, FName FromWeapon, FName ToWeapon)
+	{
+		if (!IsEnabled()) return;
+
+		const FString FromName = FromWeapon.ToString();
+		const FString ToName = ToWeapon.ToString();
+
+		UE_TRACE_LOG(Combat, WeaponSwitched, CombatChannel)
+			<< WeaponSwitched.Cycle(FPlatformTime::Cycles64())
+			<< WeaponSwitched.OwnerId(GetId(Owner))
+			<< WeaponSwitched.FromWeapon(*FromName, FromName.Len())
+			<< WeaponSwitched.ToWeapon(*ToName, ToName.Len());
+	}
+
+	void WallRunStarted(const UObject* Character, const AActor* Wall, bool bRightSide)
+	{
+		LogWallRun(Character, Wall, true, bRightSide);
+	}
+
+	void WallRunEnded(const UObject* Character)
+	{
+		LogWallRun(Character, nullptr, false, false);
+	}
+}
+
+#endif
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+
+// Combat timeline events for Unreal Insights, recorded with -trace=default,Combat.
+// Everything below compiles to nothing in shipping builds.
+#define COMBAT_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+#if COMBAT_TRACE_ENABLED
+
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+class AActor;
+
+// Actors are identified by UObject::GetUniqueID, weapons by definition or class name
+namespace CombatTrace
+{
+	COMBATSYSTEM_API void ShotFired(const UObject* Shooter, FName Weapon, int32 ShotCount);
+
+	// Issued and resolved share a trace id so the pair can be matched on the timeline
+	COMBATSYSTEM_API void TraceIssued(const UObject* Shooter);
+	COMBATSYSTEM_API void TraceResolved(const UObject* Shooter, const AActor* HitActor, bool bHit);
+
+	// Pools are the target's values before the damage is applied
+	COMBATSYSTEM_API void DamageApplied(const UObject* Target, float Amount, float ShieldPool, float HealthPool);
+	COMBATSYSTEM_API void ShieldBroken(const UObject* Target);
+	COMBATSYSTEM_API void EnemyDied(const UObject* Enemy);
+
+	COMBATSYSTEM_API void ReloadStarted(const UObject* Owner, FName Weapon);
+	COMBATSYSTEM_API void ReloadFinished(const UObject* Owner, FName Weapon);
+	COMBATSYSTEM_API void WeaponSwitched(const UObject* Owner, FName FromWeapon, FName ToWeapon);
+
+	COMBATSYSTEM_API void WallRunStarted(const UObject* Character, const AActor* Wall, bool bRightSide);
+	COMBATSYSTEM_API void WallRunEnded(const UObject* Character);
+}
+
+#define COMBAT_TRACE_EVENT(EventName, ...) CombatTrace::EventName(__VA_ARGS__)
+#define COMBAT_TRACE_SCOPE(ScopeName) TRACE_CPUPROFILER_EVENT_SCOPE_STR(ScopeName)
+
+#else
+
+#define COMBAT_TRACE_EVENT(EventName, ...) do {} while (0)
+#define COMBAT_TRACE_SCOPE(ScopeName)
+
+#endif
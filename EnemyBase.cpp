@@ -7,6 +7,16 @@
 #include "AIController.h"
 #include "BrainComponent.h"
 #include "Engine/World.h"
+#include "CombatActorRegistry.h"
+#include "CombatStartupSubsystem.h"
+#include "CombatSimulationSubsystem.h"
+#include "CombatEventBus.h"
+#include "CombatStats.h"
+#include "CombatTrace.h"
+#include "CombatTelemetry.h"
+#include "CombatReplay.h"
+#include "CombatMemory.h"
+#include "CombatMath.h"
 
 AEnemyBase::AEnemyBase()
 {
@@ -19,8 +29,34 @@ void AEnemyBase::BeginPlay()
 
 	PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
 
-	if (WeaponBlueprint)
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
 	{
+		Registry->RegisterEnemy(this);
+	}
+
+	UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this);
+	if (Simulation && Simulation->IsFixedStep())
+	{
+		CombatStepHandle = Simulation->OnStep.AddUObject(this, &AEnemyBase::RegenerateShield);
+	}
+
+	// The enemy can't fire until this runs, but nothing fires in the very first frame anyway
+	UCombatStartupSubsystem::Defer(this, TEXT("Enemy.SpawnWeapon"), ECombatStartupPriority::Normal,
+		[WeakThis = TWeakObjectPtr<AEnemyBase>(this)]()
+		{
+			if (AEnemyBase* Enemy = WeakThis.Get())
+			{
+				Enemy->SpawnEnemyWeapon();
+			}
+		});
+}
+
+void AEnemyBase::SpawnEnemyWeapon()
+{
+	if (WeaponBlueprint && !SpawnedWeapon && !bIsEnemyDead)
+	{
+		LLM_SCOPE_BYTAG(Combat_Enemies);
+
 		FActorSpawnParameters SpawnParams;
 		SpawnParams.Owner = this;
 		SpawnParams.Instigator = GetInstigator();
@@ -39,11 +75,33 @@ void AEnemyBase::BeginPlay()
 	}
 }
 
+void AEnemyBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->UnregisterEnemy(this);
+	}
+
+	if (UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this))
+	{
+		Simulation->OnStep.Remove(CombatStepHandle);
+	}
+	UCombatSimulationSubsystem::ClearAllTimersForObject(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AEnemyBase::Tick(float DeltaTime)
 {
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatEnemyTick, EnemyTick);
+	COMBAT_TRACE_SCOPE("AEnemyBase::Tick");
+
 	Super::Tick(DeltaTime);
 
-	RegenerateShield(DeltaTime);
+	if (!CombatStepHandle.IsValid())
+	{
+		RegenerateShield(DeltaTime);
+	}
 
 	SetEnemyAiming();
 
@@ -52,19 +110,20 @@ void AEnemyBase::Tick(float DeltaTime)
 
 void AEnemyBase::ReceiveDamage(float Amount)
 {
-	if (CurrentShieldPool > 0.0f)
-	{
-		float ShieldDamage = FMath::Min(CurrentShieldPool, Amount);
-		CurrentShieldPool -= ShieldDamage;
-		Amount -= ShieldDamage;
-	}
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatReceiveDamage, ReceiveDamage);
+	COMBAT_TRACE_SCOPE("AEnemyBase::ReceiveDamage");
+	COMBAT_COUNT(DamageEvents, 1);
+	COMBAT_TRACE_EVENT(DamageApplied, this, Amount, CurrentShieldPool, CurrentHealthPool);
 
-	if (Amount > 0.0f)
+	const bool bShieldBroken = CombatMath::ApplyDamage(CurrentShieldPool, CurrentHealthPool, MaxHealthPool, Amount);
+	if (bShieldBroken)
 	{
-		CurrentHealthPool = FMath::Clamp(CurrentHealthPool - Amount, 0.0f, MaxHealthPool);
+		COMBAT_TRACE_EVENT(ShieldBroken, this);
 	}
+	COMBAT_TELEMETRY(DamageApplied, this, Amount, CurrentShieldPool, CurrentHealthPool, bShieldBroken);
+	COMBAT_REPLAY_DAMAGE(this, Amount, CurrentShieldPool, CurrentHealthPool);
 
-	LastDamageTime = GetWorld()->GetTimeSeconds();
+	LastDamageTime = UCombatSimulationSubsystem::GetTime(this);
 }
 
 
@@ -72,21 +131,18 @@ void AEnemyBase::RegenerateShield(float DeltaTime)
 {
 	if (bIsEnemyDead) return;
 	
-	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float CurrentTime = UCombatSimulationSubsystem::GetTime(this);
 
-	if (CurrentShieldPool >= 0.0f && CurrentShieldPool < MaxShieldPool && HealthRegenSpeed > 0.0f)
-	{
-		if (CurrentTime - LastDamageTime >= ShieldRegenDelay)
-		{
-			CurrentShieldPool += HealthRegenSpeed * DeltaTime;
-			CurrentShieldPool = FMath::Clamp(CurrentShieldPool, 0.0f, MaxShieldPool);
-		}
-	}
+	CurrentShieldPool = CombatMath::RegenPool(CurrentShieldPool, MaxShieldPool, HealthRegenSpeed, DeltaTime, CurrentTime - LastDamageTime, ShieldRegenDelay);
 }
 
 
 void AEnemyBase::FireAtPlayer()
 {
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatEnemyFire, EnemyFire);
+	COMBAT_TRACE_SCOPE("AEnemyBase::FireAtPlayer");
+	LLM_SCOPE_BYTAG(Combat_FX);
+
 	if (!PlayerPawn || !SpawnedWeaponMesh || !bIsEnemyAimingWeapon || bIsEnemyDead)
 		return;
 
@@ -111,13 +167,20 @@ void AEnemyBase::FireAtPlayer()
 			EAttachLocation::SnapToTarget,
 			true
 		);
+		COMBAT_COUNT(Emitters, 1);
 	}
 
 	if (FireSound)
 	{
 		UGameplayStatics::PlaySoundAtLocation(GetWorld(), FireSound, MuzzleLocation);
+		COMBAT_COUNT(Sounds, 1);
 	}
 
+	UCombatEventBus::Publish(this, FCombatShotFiredEvent{ this, NAME_None, 1, UCombatSimulationSubsystem::GetTime(this) });
+	COMBAT_TRACE_EVENT(ShotFired, this, SpawnedWeapon ? SpawnedWeapon->GetClass()->GetFName() : NAME_None, 1);
+	// Enemies do not track ammo
+	COMBAT_TELEMETRY(ShotFired, this, SpawnedWeapon ? SpawnedWeapon->GetClass()->GetFName() : NAME_None, 1, INDEX_NONE);
+
 	// --- Line Trace to Determine Impact ---
 	FHitResult Hit;
 	FVector TraceEnd = MuzzleLocation + Direction * 10000.f;
@@ -125,6 +188,7 @@ void AEnemyBase::FireAtPlayer()
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(this);
 
+	COMBAT_TRACE_EVENT(TraceIssued, this);
 	bool bHit = GetWorld()->LineTraceSingleByChannel(
 		Hit,
 		MuzzleLocation,
@@ -132,6 +196,8 @@ void AEnemyBase::FireAtPlayer()
 		ECC_Visibility,
 		QueryParams
 	);
+	COMBAT_COUNT(Traces, 1);
+	COMBAT_TRACE_EVENT(TraceResolved, this, Hit.GetActor(), bHit);
 
 	// --- Spawn Tracer FX ---
 	if (TracerClass)
@@ -147,6 +213,7 @@ void AEnemyBase::FireAtPlayer()
 			TracerRotation,
 			SpawnParams
 		);
+		COMBAT_COUNT(Tracers, 1);
 	}
 
 	if (bHit)
@@ -160,8 +227,11 @@ void AEnemyBase::FireAtPlayer()
 			APlayerCharacterController* HitCharacter = Cast<APlayerCharacterController>(HitActor);
 			if (HitCharacter)
 			{
-				UE_LOG(LogTemp, Warning, TEXT("Player Is Hit"));
+				COMBAT_HOTPATH_LOG(Warning, TEXT("Player Is Hit"));
+				COMBAT_TELEMETRY(Hit, this, HitCharacter, Damage);
 				HitCharacter->ReceiveDamage(Damage);
+
+				UCombatEventBus::Publish(this, FCombatHitEvent{ this, HitCharacter, Hit.ImpactPoint, Damage });
 			}
 			else
 			{
@@ -181,11 +251,11 @@ void AEnemyBase::SetEnemyAiming()
 
 	if (bIsAiming)
 	{
-		if (!GetWorld()->GetTimerManager().IsTimerActive(FireRateTimerHandle))
+		if (!UCombatSimulationSubsystem::IsTimerActive(this, FireRateTimerHandle))
 		{
-			GetWorld()->GetTimerManager().SetTimer(
-				FireRateTimerHandle,
+			UCombatSimulationSubsystem::SetTimer(
 				this,
+				FireRateTimerHandle,
 				&AEnemyBase::FireAtPlayer,
 				1.0f / FireRate,
 				true
@@ -194,7 +264,7 @@ void AEnemyBase::SetEnemyAiming()
 	}
 	else
 	{
-		GetWorld()->GetTimerManager().ClearTimer(FireRateTimerHandle);
+		UCombatSimulationSubsystem::ClearTimer(this, FireRateTimerHandle);
 	}
 }
 
@@ -206,16 +276,39 @@ void AEnemyBase::CheckEnemyDeath()
 		{
 			bIsEnemyDead = true;
 			bEnemyDeathSequenceExecuted = true;
-			float EnemyDeathAnimationDuration = EnemyDyingSequence->GetPlayLength();
+			float EnemyDeathAnimationDuration = EnemyDyingSequence ? EnemyDyingSequence->GetPlayLength() : 0.0f;
 
-			GetWorldTimerManager().SetTimer(EnemyDeathTimerHandle, this, &AEnemyBase::DestroyEnemy, EnemyDeathAnimationDuration, false);
+			if (EnemyDeathAnimationDuration > 0.0f)
+			{
+				UCombatSimulationSubsystem::SetTimer(this, EnemyDeathTimerHandle, &AEnemyBase::DestroyEnemy, EnemyDeathAnimationDuration, false);
+			}
+			else
+			{
+				DestroyEnemy();
+			}
 		}
 	}
 }
 
 void AEnemyBase::DestroyEnemy()
 {	
-	OnEnemyDeath.Broadcast(this);
+	COMBAT_TRACE_SCOPE("AEnemyBase::DestroyEnemy");
+
+	// Counted right away since Destroy below unregisters us, listeners hear about it from the bus with the counts already updated
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->NotifyEnemyDied(this);
+	}
+
+	UCombatEventBus::Publish(this, FCombatEnemyDiedEvent{ this, GetActorLocation(), UCombatSimulationSubsystem::GetTime(this) });
+	COMBAT_TRACE_EVENT(EnemyDied, this);
+	COMBAT_TELEMETRY(EnemyDied, this);
+
+	// Blueprint adapter; native listeners use the event bus
+	if (OnEnemyDeath.IsBound())
+	{
+		OnEnemyDeath.Broadcast(this);
+	}
 	
 	SetActorTickEnabled(false);
 
@@ -235,14 +328,37 @@ void AEnemyBase::DestroyEnemy()
 	}
 
 	if (FireRateTimerHandle.IsValid())
-		GetWorldTimerManager().ClearTimer(FireRateTimerHandle);
+		UCombatSimulationSubsystem::ClearTimer(this, FireRateTimerHandle);
 
 	// Optionally hide the actor or play dissolve FX
 	SetActorHiddenInGame(true);
 
-	GetWorldTimerManager().ClearAllTimersForObject(this);
+	UCombatSimulationSubsystem::ClearAllTimersForObject(this);
 
 
 	// Destroy the actor after short delay (if animation is already handled before this call)
 	Destroy();
 }
+
+void AEnemyBase::RestoreCombatState(float ShieldPool, float HealthPool)
+{
+	UCombatSimulationSubsystem::ClearTimer(this, EnemyDeathTimerHandle);
+	UCombatSimulationSubsystem::ClearTimer(this, FireRateTimerHandle);
+
+	CurrentShieldPool = ShieldPool;
+	CurrentHealthPool = HealthPool;
+	LastDamageTime = UCombatSimulationSubsystem::GetTime(this);
+
+	bIsEnemyDead = false;
+	bEnemyDeathSequenceExecuted = false;
+	bIsEnemyAimingWeapon = false;
+
+	SetActorTickEnabled(true);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	if (!SpawnedWeapon)
+	{
+		SpawnEnemyWeapon();
+	}
+}
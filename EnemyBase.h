@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "CombatSimulationSubsystem.h"
 #include "EnemyBase.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEnemyDeathSignature, AEnemyBase*, DeadEnemy);
@@ -21,6 +22,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -60,6 +63,9 @@ public:
 	// Shield regeneration logic
 	void RegenerateShield(float DeltaTime);
 
+	// Bound while the combat clock runs fixed steps; regen runs on those instead of the frame's delta
+	FDelegateHandle CombatStepHandle;
+
 	// Weapon fire logic
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 	virtual void FireAtPlayer();
@@ -77,6 +83,9 @@ public:
 	UPROPERTY()
 	USkeletalMeshComponent* SpawnedWeaponMesh;
 
+	// Spawns WeaponBlueprint into the EnemyWeaponHolder socket. Deferred out of BeginPlay by the startup subsystem.
+	void SpawnEnemyWeapon();
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy Weapon")
 	bool bIsEnemyAimingWeapon = false;
 
@@ -86,7 +95,7 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy Weapon")
 	float FireRate = 2.0f; // 2 shots per second
 
-	FTimerHandle FireRateTimerHandle;
+	FCombatTimerHandle FireRateTimerHandle;
 
 	UFUNCTION()
 	void SetEnemyAiming();
@@ -102,12 +111,15 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	UAnimSequence* EnemyDyingSequence;
 
-	FTimerHandle EnemyDeathTimerHandle;
+	FCombatTimerHandle EnemyDeathTimerHandle;
 
 	void CheckEnemyDeath();
 
 	void DestroyEnemy();
 
+	// Brings the enemy back to a captured state, alive and armed. Used by the combat snapshot restore.
+	void RestoreCombatState(float ShieldPool, float HealthPool);
+
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnEnemyDeathSignature OnEnemyDeath;
 
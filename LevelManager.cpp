@@ -2,75 +2,182 @@
 #include "EnemyBase.h"
 #include "Kismet/GameplayStatics.h"
 #include "SaveGameData.h"
+#include "CombatSaveSubsystem.h"
+#include "CombatActorRegistry.h"
+#include "CombatEventBus.h"
+#include "CombatStartupSubsystem.h"
+#include "CombatLevelFlowSubsystem.h"
+#include "CombatSnapshotSubsystem.h"
+#include "CombatStats.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+static TAutoConsoleVariable<int32> CVarCombatCsvCaptureLevels(
+	TEXT("Combat.CsvCaptureLevels"),
+	0,
+	TEXT("When 1, each combat level records a CSV profile from level start until it is completed or unloaded."),
+	ECVF_Default);
 
 ALevelManager::ALevelManager()
 {
 	PrimaryActorTick.bCanEverTick = false;
+
+	LevelProgression = nullptr;
 }
 
 void ALevelManager::BeginPlay()
 {
 	Super::BeginPlay();
 
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AEnemyBase::StaticClass(), FoundActors);
+	FScopedCombatStartupPhase StartupPhase(this, TEXT("LevelManager.Register"));
+
+	LevelStartTime = GetWorld()->GetTimeSeconds();
 
-	for (AActor* Actor : FoundActors)
+	BeginLevelCsvCapture();
+
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
 	{
-		AEnemyBase* Enemy = Cast<AEnemyBase>(Actor);
-		if (Enemy)
-		{
-			TrackedEnemies.Add(Enemy);
+		Registry->RegisterLevelManager(this);
+		Registry->OnEnemyCountsChanged.AddUObject(this, &ALevelManager::OnEnemyCountsChanged);
 
-			if (!Enemy->OnEnemyDeath.IsAlreadyBound(this, &ALevelManager::OnEnemyDied))
-			{
-				Enemy->OnEnemyDeath.AddDynamic(this, &ALevelManager::OnEnemyDied);
-			}
+		TotalEnemies = Registry->GetTotalEnemyCount();
+		DeadEnemyCount = Registry->GetDeadEnemyCount();
+	}
+
+	if (UCombatEventBus* EventBus = UCombatEventBus::Get(this))
+	{
+		EventBus->Channel<FCombatEnemyDiedEvent>().OnEvents.AddUObject(this, &ALevelManager::OnEnemiesDied);
+	}
+
+	if (UCombatLevelFlowSubsystem* LevelFlow = UCombatLevelFlowSubsystem::Get(this))
+	{
+		LevelFlow->BeginLevel(GetWorld(), LevelProgression);
+	}
+
+	// Placed enemies may begin play after us, so wait until every level actor has registered
+	GetWorldTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this]()
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Number of Enemies: %d"), TotalEnemies);
+
+		CheckAllEnemiesDead(); // In case some enemies start dead
+
+		// Level start is the checkpoint a retry returns to
+		if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+		{
+			Snapshots->CaptureCheckpoint();
 		}
+	}));
+}
+
+void ALevelManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	EndLevelCsvCapture();
+
+	if (UCombatEventBus* EventBus = UCombatEventBus::Get(this))
+	{
+		EventBus->Channel<FCombatEnemyDiedEvent>().OnEvents.RemoveAll(this);
+	}
+
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->OnEnemyCountsChanged.RemoveAll(this);
+		Registry->UnregisterLevelManager(this);
 	}
 
-	TotalEnemies = TrackedEnemies.Num();
-	UE_LOG(LogTemp, Warning, TEXT("Number of Enemies: %d"), TotalEnemies);
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALevelManager::OnEnemyCountsChanged()
+{
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this);
+	if (!Registry) return;
 
-	CheckAllEnemiesDead(); // In case some enemies start dead
+	TotalEnemies = Registry->GetTotalEnemyCount();
+	DeadEnemyCount = Registry->GetDeadEnemyCount();
 }
 
-void ALevelManager::OnEnemyDied(AEnemyBase* DeadEnemy)
+void ALevelManager::OnEnemiesDied(TConstArrayView<FCombatEnemyDiedEvent> Events)
 {
-	DeadEnemyCount++;
+	// The registry counted each death before it was published
+	OnEnemyCountsChanged();
+
 	UE_LOG(LogTemp, Warning, TEXT("Enemy died. Total Dead: %d / %d"), DeadEnemyCount, TotalEnemies);
 	CheckAllEnemiesDead();
 }
 
 void ALevelManager::CheckAllEnemiesDead()
 {
-	if (DeadEnemyCount >= TotalEnemies)
+	if (!bLevelComplete && DeadEnemyCount >= TotalEnemies)
 	{
+		// Resolved before the level is marked complete, so a missing flow can't silently skip the save and the travel
+		UCombatLevelFlowSubsystem* LevelFlow = UCombatLevelFlowSubsystem::Get(this);
+		if (!LevelFlow)
+		{
+			UE_LOG(LogTemp, Error, TEXT("All enemies eliminated but there is no level flow subsystem, the level can't be completed."));
+			return;
+		}
+
+		bLevelComplete = true;
+
 		UE_LOG(LogTemp, Warning, TEXT("All enemies eliminated! Level complete."));
 		// Trigger level complete UI, next level, etc.
 
-		FString CurrentLevelName = GetWorld()->GetMapName();
-		CurrentLevelName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix); // removes "UEDPIE_0_" or similar
+		EndLevelCsvCapture();
+
+		const FCombatLevelNode& LevelNode = LevelFlow->GetCurrentNode();
 
-		if (CurrentLevelName.Equals("GameLevel_1"))
+		// The save subsystem keeps the data cached and writes it off the game thread, so this frame only updates memory
+		if (UCombatSaveSubsystem* SaveSubsystem = UCombatSaveSubsystem::Get(this))
 		{
-			// Create or load existing save game
-			USaveGameData* SaveGameInstance = Cast<USaveGameData>(
-				UGameplayStatics::LoadGameFromSlot(TEXT("PlayerSaveSlot"), 0));
+			const float CompletionSeconds = GetWorld()->GetTimeSeconds() - LevelStartTime;
 
-			if (!SaveGameInstance)
+			// Kept for menus that still read the legacy flag
+			if (LevelNode.UnlocksLevel == FName("GameLevel_2"))
 			{
-				SaveGameInstance = Cast<USaveGameData>(
-					UGameplayStatics::CreateSaveGameObject(USaveGameData::StaticClass()));
+				SaveSubsystem->GetSaveData()->bIsLevel2Unlocked = true;
 			}
 
-			SaveGameInstance->bIsLevel2Unlocked = true;
-
-			UGameplayStatics::SaveGameToSlot(SaveGameInstance, TEXT("PlayerSaveSlot"), 0);
+			SaveSubsystem->RecordLevelCompleted(LevelNode.LevelName, CompletionSeconds, DeadEnemyCount, LevelNode.UnlocksLevel);
 
-			UE_LOG(LogTemp, Warning, TEXT("Level 2 unlocked and saved."));
+			if (!LevelNode.UnlocksLevel.IsNone())
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s unlocked and saved."), *LevelNode.UnlocksLevel.ToString());
+			}
 		}
 
-		UGameplayStatics::OpenLevel(GetWorld(), FName("MainMenuMap"));
+		LevelFlow->TravelToNextLevel(GetWorld());
+	}
+}
+
+void ALevelManager::BeginLevelCsvCapture()
+{
+#if CSV_PROFILER
+	if (CVarCombatCsvCaptureLevels.GetValueOnGameThread() == 0) return;
+
+	// Never hijack a capture someone else started from the command line or console
+	FCsvProfiler* Profiler = FCsvProfiler::Get();
+	if (!Profiler || Profiler->IsCapturing()) return;
+
+	const FString LevelName = UGameplayStatics::GetCurrentLevelName(this);
+	const FString FileName = FString::Printf(TEXT("Combat_%s_%s.csv"), *LevelName, *FDateTime::Now().ToString());
+
+	Profiler->BeginCapture(-1, FString(), FileName);
+	bStartedCsvCapture = true;
+
+	UE_LOG(LogTemp, Log, TEXT("CSV capture started for %s"), *LevelName);
+#endif
+}
+
+void ALevelManager::EndLevelCsvCapture()
+{
+#if CSV_PROFILER
+	if (!bStartedCsvCapture) return;
+
+	bStartedCsvCapture = false;
+
+	if (FCsvProfiler* Profiler = FCsvProfiler::Get())
+	{
+		Profiler->EndCapture();
 	}
+#endif
 }
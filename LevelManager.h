@@ -5,6 +5,8 @@
 #include "LevelManager.generated.h"
 
 class AEnemyBase;
+class UCombatLevelProgression;
+struct FCombatEnemyDiedEvent;
 
 UCLASS()
 class COMBATSYSTEM_API ALevelManager : public AActor
@@ -17,17 +19,33 @@ public:
 protected:
 	virtual void BeginPlay() override;
 
-	UPROPERTY()
-	TArray<AEnemyBase*> TrackedEnemies;
+	// Level flow graph; when unset the built-in flow returns to the main menu
+	UPROPERTY(EditAnywhere, Category = "Level Progression")
+	UCombatLevelProgression* LevelProgression;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	// Mirrors of the combat actor registry counts, kept for blueprints
 	UPROPERTY()
 	int32 TotalEnemies = 0;
 
 	UPROPERTY()
 	int32 DeadEnemyCount = 0;
 
-	UFUNCTION()
-	void OnEnemyDied(AEnemyBase* DeadEnemy);
+	bool bLevelComplete = false;
+
+	float LevelStartTime = 0.0f;
+
+	// Set while this level owns a CSV profiler capture started by Combat.CsvCaptureLevels
+	bool bStartedCsvCapture = false;
+
+	void BeginLevelCsvCapture();
+
+	void EndLevelCsvCapture();
+
+	void OnEnemyCountsChanged();
+
+	void OnEnemiesDied(TConstArrayView<FCombatEnemyDiedEvent> Events);
 
 	void CheckAllEnemiesDead();
 
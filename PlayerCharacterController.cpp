@@ -13,9 +13,23 @@
 #include "Camera/PlayerCameraManager.h"
 #include "LevelManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "CombatActorRegistry.h"
+#include "CombatStartupSubsystem.h"
+#include "CombatSimulationSubsystem.h"
+#include "CombatHUDViewModel.h"
+#include "CombatEventBus.h"
+#include "WallRunSurfaceIndex.h"
+#include "CombatCharacterMovementComponent.h"
+#include "CombatStats.h"
+#include "CombatTrace.h"
+#include "CombatTelemetry.h"
+#include "CombatReplay.h"
+#include "CombatMath.h"
+#include "CombatLatencySubsystem.h"
 
 // Sets default values
-APlayerCharacterController::APlayerCharacterController()
+APlayerCharacterController::APlayerCharacterController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCombatCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Initialize properties
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -47,6 +61,8 @@ void APlayerCharacterController::BeginPlay()
 {
 	Super::BeginPlay();
 
+	FScopedCombatStartupPhase SetupPhase(this, TEXT("Player.MovementAndInput"));
+
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 500.0f, 0.0f);
 	GetCharacterMovement()->JumpZVelocity = 700.f;
@@ -55,6 +71,22 @@ void APlayerCharacterController::BeginPlay()
 	GetCharacterMovement()->MinAnalogWalkSpeed = 20.f;
 	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
 	GetCharacterMovement()->BrakingDecelerationFalling = 1500.f;
+
+	// Wall-run tuning stays on the character where blueprints set it; the movement component simulates it
+	UCombatCharacterMovementComponent* CombatMovement = GetCombatMovement();
+	CombatMovement->WallRunSpeed = WallRunSpeed;
+	CombatMovement->WallRunDuration = WallRunDuration;
+	CombatMovement->WallRunGravityScale = WallRunGravityScale;
+	CombatMovement->WallDetectionDistance = WallDetectionDistance;
+	CombatMovement->WallRunCooldownDuration = WallRunCooldownDuration;
+
+	PreviousStepArmLength = StepArmLength = CameraBoom->TargetArmLength;
+
+	UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this);
+	if (Simulation && Simulation->IsFixedStep())
+	{
+		CombatStepHandle = Simulation->OnStep.AddUObject(this, &APlayerCharacterController::CombatStep);
+	}
 	
 	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
 	{
@@ -66,20 +98,24 @@ void APlayerCharacterController::BeginPlay()
 
 	if (!WeaponManager)
 	{
+		FScopedCombatStartupPhase WeaponPhase(this, TEXT("Player.WeaponManager"));
+
 		WeaponManager = NewObject<UWeaponManagerComponent>(this, UWeaponManagerComponent::StaticClass());
 		if (WeaponManager)
 		{
-			WeaponManager->RegisterComponent();
 			WeaponManager->WeaponOwner = this;
 
 			// Initialize all weapons
-			WeaponManager->SpawnAndHolsterWeapon(AssaultRifleData);
-			WeaponManager->SpawnAndHolsterWeapon(ShotgunData);
-			WeaponManager->SpawnAndHolsterWeapon(PistolData);
+			WeaponManager->InitializeSlot(EWeaponSlot::Primary1, AssaultRifleData);
+			WeaponManager->InitializeSlot(EWeaponSlot::Primary2, ShotgunData);
+			WeaponManager->InitializeSlot(EWeaponSlot::Secondary, PistolData);
 
-			// Equip default weapon
-			WeaponManager->EquipWeapon(AssaultRifleData);
-			CurrentWeaponSlot = AssaultRifleData.WeaponName;
+			// Default weapon, the only one the first frame needs
+			WeaponManager->CurrentSlot = EWeaponSlot::Primary1;
+			CurrentWeaponSlot = EWeaponSlot::Primary1;
+
+			// Registering begins play on the manager, which equips the current slot and spawns the holstered ones over the next frames
+			WeaponManager->RegisterComponent();
 		}
 		else
 		{
@@ -87,13 +123,49 @@ void APlayerCharacterController::BeginPlay()
 		}
 	}
 
-	TArray<AActor*> FoundManagers;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ALevelManager::StaticClass(), FoundManagers);
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->RegisterTarget(this);
+
+		// May still be null if the level manager begins play after us
+		LevelManager = Registry->GetLevelManager();
 
-	if (FoundManagers.Num() > 0)
+		Registry->OnEnemyCountsChanged.AddUObject(this, &APlayerCharacterController::EnemyTracker);
+		EnemyTracker();
+	}
+
+	// Deaths don't go through OnEnemyCountsChanged, they are published on the event bus
+	if (UCombatEventBus* EventBus = UCombatEventBus::Get(this))
 	{
-		LevelManager = Cast<ALevelManager>(FoundManagers[0]);
+		EventBus->Channel<FCombatEnemyDiedEvent>().OnEvents.AddWeakLambda(this, [this](TConstArrayView<FCombatEnemyDiedEvent> Events)
+		{
+			EnemyTracker();
+		});
 	}
+
+	PublishHealth();
+}
+
+void APlayerCharacterController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatEventBus* EventBus = UCombatEventBus::Get(this))
+	{
+		EventBus->Channel<FCombatEnemyDiedEvent>().OnEvents.RemoveAll(this);
+	}
+
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->OnEnemyCountsChanged.RemoveAll(this);
+		Registry->UnregisterTarget(this);
+	}
+
+	if (UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this))
+	{
+		Simulation->OnStep.Remove(CombatStepHandle);
+	}
+	UCombatSimulationSubsystem::ClearAllTimersForObject(this);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -112,25 +184,44 @@ void APlayerCharacterController::Tick(float DeltaTime)
 		GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 	}
 
-	// Lerp spring arm based on movement and speed
-	bool bIsMovingForward = MovementVector.Y > 0.1f;
-	float DesiredLength = bIsMovingForward && GetCharacterMovement()->MaxWalkSpeed > WalkSpeed
-		? TargetArmLengthRunning
-		: TargetArmLengthWalking;
+	if (CombatStepHandle.IsValid())
+	{
+		// The arm and regen advanced on the combat steps; present the arm between the last two
+		const UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this);
+		CameraBoom->TargetArmLength = FMath::Lerp(PreviousStepArmLength, StepArmLength, Simulation ? Simulation->GetAlpha() : 1.0f);
+	}
+	else
+	{
+		// Lerp spring arm based on movement and speed
+		CameraBoom->TargetArmLength = FMath::FInterpTo(CameraBoom->TargetArmLength, GetDesiredArmLength(), DeltaTime, SpringArmInterpSpeed);
 
-	float CurrentLength = CameraBoom->TargetArmLength;
-	CameraBoom->TargetArmLength = FMath::FInterpTo(CurrentLength, DesiredLength, DeltaTime, SpringArmInterpSpeed);
+		RegenerateShieldAndHealth(DeltaTime);
+	}
 
-	RegenerateShieldAndHealth(DeltaTime);
+	CheckPlayerHealth();
 
-	EnemyTracker();
+}
 
-	CheckPlayerHealth();
+void APlayerCharacterController::CombatStep(float StepSeconds)
+{
+	PreviousStepArmLength = StepArmLength;
+	StepArmLength = FMath::FInterpTo(StepArmLength, GetDesiredArmLength(), StepSeconds, SpringArmInterpSpeed);
 
+	RegenerateShieldAndHealth(StepSeconds);
+}
+
+float APlayerCharacterController::GetDesiredArmLength() const
+{
+	const bool bIsMovingForward = MovementVector.Y > 0.1f;
+	return bIsMovingForward && GetCharacterMovement()->MaxWalkSpeed > WalkSpeed
+		? TargetArmLengthRunning
+		: TargetArmLengthWalking;
 }
 
 void APlayerCharacterController::HandleJump()
 {
+	COMBAT_REPLAY_INPUT(this, Jump);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (bIsWallRunning)
@@ -143,6 +234,13 @@ void APlayerCharacterController::HandleJump()
 	}
 }
 
+void APlayerCharacterController::StopJumping()
+{
+	COMBAT_REPLAY_INPUT(this, StopJump);
+
+	Super::StopJumping();
+}
+
 // Called to bind functionality to input
 void APlayerCharacterController::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -180,6 +278,8 @@ void APlayerCharacterController::SetupPlayerInputComponent(UInputComponent* Play
 // Movement
 void APlayerCharacterController::Move(const FInputActionValue& Value)
 {
+	COMBAT_REPLAY_INPUT(this, Move, Value.Get<FVector2D>());
+
 	if (bIsPlayerDeadExecuted) return;
 
 	MovementVector = Value.Get<FVector2D>();
@@ -216,6 +316,8 @@ void APlayerCharacterController::Look(const FInputActionValue& Value)
 // Running
 void APlayerCharacterController::StartRunning()
 {
+	COMBAT_REPLAY_INPUT(this, StartRun);
+
 	if (bIsPlayerDeadExecuted) return;
 	
 	if (bIsAiming) return;
@@ -226,6 +328,8 @@ void APlayerCharacterController::StartRunning()
 
 void APlayerCharacterController::StopRunning()
 {
+	COMBAT_REPLAY_INPUT(this, StopRun);
+
 	if (bIsPlayerDeadExecuted) return;
 	
 	bIsRunActionPressed = false;
@@ -234,11 +338,45 @@ void APlayerCharacterController::StopRunning()
 
 void APlayerCharacterController::CheckForWallRun()
 {
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatCheckForWallRun, CheckForWallRun);
+	COMBAT_TRACE_SCOPE("APlayerCharacterController::CheckForWallRun");
+
 	//if (bIsPlayerDeadExecuted) return;
 	
-	if (bIsWallRunning || bWallRunCooldown) return;
+	if (bIsWallRunning || !GetCombatMovement()->CanStartWallRun()) return;
 
 	FVector StartLocation = GetActorLocation();
+
+	// With a baked surface index, only probe when the index says a wall is within reach
+	UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this);
+	AWallRunSurfaceIndex* WallRunIndex = Registry ? Registry->GetWallRunIndex() : nullptr;
+	if (WallRunIndex && AWallRunSurfaceIndex::IsQueryEnabled())
+	{
+		const FWallRunSurface* RightSurface = nullptr;
+		const FWallRunSurface* LeftSurface = nullptr;
+		if (!WallRunIndex->FindSurfaces(StartLocation, GetActorRightVector(), WallDetectionDistance, RightSurface, LeftSurface)) return;
+
+		// One trace towards each indexed wall confirms it and provides the hit the wall run needs.
+		// Right first like the side traces, and the left wall still gets its turn when the right one is refused.
+		FCollisionQueryParams ConfirmParams;
+		ConfirmParams.AddIgnoredActor(this);
+
+		for (const bool bIsRightWall : { true, false })
+		{
+			if (!(bIsRightWall ? RightSurface : LeftSurface)) continue;
+
+			FHitResult WallHit;
+			const FVector ProbeEnd = StartLocation + GetActorRightVector() * (bIsRightWall ? WallDetectionDistance : -WallDetectionDistance);
+			COMBAT_COUNT(Traces, 1);
+			if (GetWorld()->LineTraceSingleByChannel(WallHit, StartLocation, ProbeEnd, ECC_Visibility, ConfirmParams) && CanWallRunOnSurface(WallHit))
+			{
+				StartWallRun(bIsRightWall, WallHit);
+				return;
+			}
+		}
+		return;
+	}
+
 	FVector RightWallDetectionDistance = StartLocation + GetActorRightVector() * WallDetectionDistance;
 	FVector LeftWallDetectionDistance = StartLocation - GetActorRightVector() * WallDetectionDistance;
 
@@ -248,62 +386,49 @@ void APlayerCharacterController::CheckForWallRun()
 
 	bool bIsRightWall = GetWorld()->LineTraceSingleByChannel(RightWallHit, StartLocation, RightWallDetectionDistance, ECC_Visibility, Params);
 	bool bIsLeftWall = GetWorld()->LineTraceSingleByChannel(LeftWallHit, StartLocation, LeftWallDetectionDistance, ECC_Visibility, Params);
+	COMBAT_COUNT(Traces, 2);
 
 	if (bIsRightWall && CanWallRunOnSurface(RightWallHit))
 	{
 		StartWallRun(true, RightWallHit);
-		bIsRightWallRun = true;
 	}
 	else if (bIsLeftWall && CanWallRunOnSurface(LeftWallHit))
 	{
 		StartWallRun(false, LeftWallHit);
-		bIsLeftWallRun = true;
 	}
 }
 
 void APlayerCharacterController::StartWallRun(bool bIsRightWall, const FHitResult& WallHit)
 {
 	//if (bIsPlayerDeadExecuted) return;
-	
-	bIsWallRunning = true;
-	bWallRunCooldown = true;
+
+	COMBAT_TRACE_SCOPE("APlayerCharacterController::StartWallRun");
 
 	LastWallNormal = WallHit.ImpactNormal;
 	LastWallRunLocation = WallHit.ImpactPoint;
 	LastWallActor = WallHit.GetActor();  // Store the last wall actor
 
-	GetCharacterMovement()->bOrientRotationToMovement = false;
-
-	GetCharacterMovement()->GravityScale = WallRunGravityScale;
-	GetCharacterMovement()->Velocity = FVector::ZeroVector;
-
-	const FVector WallRunDirection = GetActorForwardVector() + FVector::UpVector * 0.2f;
-	LaunchCharacter(WallRunDirection * WallRunSpeed, true, true);
-
-	GetWorldTimerManager().SetTimer(WallRunTimerHandle, this, &APlayerCharacterController::StopWallRun, WallRunDuration, false);
+	// The movement component enters the wall-run mode on its next move, predicted locally and replayed by the server
+	GetCombatMovement()->RequestWallRun(bIsRightWall);
 }
 
-void APlayerCharacterController::StopWallRun()
+void APlayerCharacterController::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
 {
-	//if (bIsPlayerDeadExecuted) return;
-	
-	bIsWallRunning = false;
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	const UCombatCharacterMovementComponent* CombatMovement = GetCombatMovement();
+	bIsWallRunning = CombatMovement->IsWallRunning();
+	bIsRightWallRun = CombatMovement->IsWallRunningRight();
+	bIsLeftWallRun = bIsWallRunning && !bIsRightWallRun;
 
-	if (bIsLeftWallRun)
+	if (bIsWallRunning)
 	{
-		bIsLeftWallRun = false;
+		COMBAT_TRACE_EVENT(WallRunStarted, this, LastWallActor, bIsRightWallRun);
 	}
-
-	if (bIsRightWallRun)
+	else if (PrevMovementMode == MOVE_Custom && PreviousCustomMode == CMOVE_WallRun)
 	{
-		bIsRightWallRun = false;
+		COMBAT_TRACE_EVENT(WallRunEnded, this);
 	}
-
-	GetCharacterMovement()->GravityScale = 1.0f;
-
-	bWallRunCooldown = true;
-
-	GetWorldTimerManager().SetTimer(WallRunCooldownHandle, this, &APlayerCharacterController::ResetWallRunCooldown, WallRunCooldownDuration, false);
 }
 
 bool APlayerCharacterController::CanWallRunOnSurface(FHitResult& WallHit)
@@ -329,29 +454,29 @@ bool APlayerCharacterController::CanWallRunOnSurface(FHitResult& WallHit)
 	return bDifferentWall || bMovedAway || !bSameWall;
 }
 
-void APlayerCharacterController::ResetWallRunCooldown()
-{
-	//if (bIsPlayerDeadExecuted) return;
-	
-	bWallRunCooldown = false;
-}
-
 void APlayerCharacterController::WallJump()
 {
 	//if (bIsPlayerDeadExecuted) return;
-	
-	StopWallRun();
 
-	FVector WallJumpDirection = LastWallNormal + FVector::UpVector * 1.0f;
-	WallJumpDirection.Normalize();
+	GetCombatMovement()->RequestWallJump();
+}
 
-	LaunchCharacter(WallJumpDirection * 800.f, true, true);
+UCombatCharacterMovementComponent* APlayerCharacterController::GetCombatMovement() const
+{
+	return CastChecked<UCombatCharacterMovementComponent>(GetCharacterMovement());
 }
 
 void APlayerCharacterController::StartFiring()
 {
+	COMBAT_REPLAY_INPUT(this, StartFire);
+
 	if (bIsPlayerDeadExecuted) return;
 
+	// Stamped with the frame the press was polled in, before the gating below, so the
+	// histograms include the wait for the input poll as well as everything after it
+	const UCombatLatencySubsystem* Latency = UCombatLatencySubsystem::Get(this);
+	const uint64 InputCycles = Latency ? Latency->GetFrameStartCycles() : 0;
+
 	if (!bCanFire || GetCharacterMovement()->IsFalling() || bIsWeaponHolstering || !bIsWeaponEquipped || !bIsAiming)
 	{
 		return;
@@ -362,12 +487,14 @@ void APlayerCharacterController::StartFiring()
 	bIsFiring = true;
 	bCanFire = false; // Block further StartFire calls
 
-	WeaponManager->StartFire();
+	WeaponManager->StartFire(InputCycles);
 }
 
 
 void APlayerCharacterController::StopFiring()
 {
+	COMBAT_REPLAY_INPUT(this, StopFire);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (WeaponManager)
@@ -380,6 +507,8 @@ void APlayerCharacterController::StopFiring()
 
 void APlayerCharacterController::Reloading()
 {
+	COMBAT_REPLAY_INPUT(this, Reload);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (WeaponManager)
@@ -390,60 +519,77 @@ void APlayerCharacterController::Reloading()
 
 void APlayerCharacterController::StartSwitchToPrimary1()
 {
+	COMBAT_REPLAY_INPUT(this, SwitchToPrimary1);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (GetCharacterMovement()->IsFalling()) return;
 
 	if (bIsAiming) return;
 
-	if (CurrentWeaponSlot == AssaultRifleData.WeaponName || WeaponManager->IsWeaponHolstered()) return;
+	if (CurrentWeaponSlot == EWeaponSlot::Primary1 || WeaponManager->IsWeaponHolstered()) return;
+
+	// Start streaming the incoming weapon now so it is resident before the holster timer fires
+	WeaponManager->PreloadSlot(EWeaponSlot::Primary1);
 
 	StopFiring();
 	bCanFire = false;
 	bIsWeaponHolstering = true;
 	float HolsterAnimDuration = (HolsterAnimSequence->GetPlayLength()) / 2;
-	GetWorldTimerManager().SetTimer(WeaponSwitchTimerHandle, this, &APlayerCharacterController::StopSwitchToPrimary1, HolsterAnimDuration, false);
+	UCombatSimulationSubsystem::SetTimer(this, WeaponSwitchTimerHandle, &APlayerCharacterController::StopSwitchToPrimary1, HolsterAnimDuration, false);
 }
 
 void APlayerCharacterController::StartSwitchToPrimary2()
 {
+	COMBAT_REPLAY_INPUT(this, SwitchToPrimary2);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (GetCharacterMovement()->IsFalling()) return;
 
 	if (bIsAiming) return;
 	
-	if (CurrentWeaponSlot == ShotgunData.WeaponName || WeaponManager->IsWeaponHolstered()) return;
+	if (CurrentWeaponSlot == EWeaponSlot::Primary2 || WeaponManager->IsWeaponHolstered()) return;
+
+	// Start streaming the incoming weapon now so it is resident before the holster timer fires
+	WeaponManager->PreloadSlot(EWeaponSlot::Primary2);
 
 	StopFiring();
 	bCanFire = false;
 	bIsWeaponHolstering = true;
 	float HolsterAnimDuration = (HolsterAnimSequence->GetPlayLength()) / 2;
 
-	GetWorldTimerManager().SetTimer(WeaponSwitchTimerHandle, this, &APlayerCharacterController::StopSwitchToPrimary2, HolsterAnimDuration, false);
+	UCombatSimulationSubsystem::SetTimer(this, WeaponSwitchTimerHandle, &APlayerCharacterController::StopSwitchToPrimary2, HolsterAnimDuration, false);
 }
 
 void APlayerCharacterController::StartSwitchToSecondary()
 {
+	COMBAT_REPLAY_INPUT(this, SwitchToSecondary);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (GetCharacterMovement()->IsFalling()) return;
 
 	if (bIsAiming) return;
 	
-	if (CurrentWeaponSlot == PistolData.WeaponName || WeaponManager->IsWeaponHolstered()) return;
+	if (CurrentWeaponSlot == EWeaponSlot::Secondary || WeaponManager->IsWeaponHolstered()) return;
+
+	// Start streaming the incoming weapon now so it is resident before the holster timer fires
+	WeaponManager->PreloadSlot(EWeaponSlot::Secondary);
 
 	StopFiring();
 	bCanFire = false;
 	bIsWeaponHolstering = true;
 	float HolsterAnimDuration = (HolsterAnimSequence->GetPlayLength()) / 2;
 
-	GetWorldTimerManager().SetTimer(WeaponSwitchTimerHandle, this, &APlayerCharacterController::StopSwitchToSecondary, HolsterAnimDuration, false);
+	UCombatSimulationSubsystem::SetTimer(this, WeaponSwitchTimerHandle, &APlayerCharacterController::StopSwitchToSecondary, HolsterAnimDuration, false);
 
 }
 
 void APlayerCharacterController::StartHolsterWeapon()
 {
+	COMBAT_REPLAY_INPUT(this, ToggleHolster);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (GetCharacterMovement()->IsFalling()) return;
@@ -459,18 +605,20 @@ void APlayerCharacterController::StartHolsterWeapon()
 
 	if (bIsWeaponHolstering && bIsWeaponBeingPutAway)
 	{
-		GetWorldTimerManager().SetTimer(WeaponSwitchTimerHandle, this, &APlayerCharacterController::StopHolsterWeapon, WeaponPuttingAwayAnimDuration, false);
+		UCombatSimulationSubsystem::SetTimer(this, WeaponSwitchTimerHandle, &APlayerCharacterController::StopHolsterWeapon, WeaponPuttingAwayAnimDuration, false);
 	}
 
 	else if (bIsWeaponHolstering && !bIsWeaponBeingPutAway)
 	{
-		GetWorldTimerManager().SetTimer(WeaponSwitchTimerHandle, this, &APlayerCharacterController::StopHolsterWeapon, HolsterAnimDuration, false);
+		UCombatSimulationSubsystem::SetTimer(this, WeaponSwitchTimerHandle, &APlayerCharacterController::StopHolsterWeapon, HolsterAnimDuration, false);
 	}
 
 }
 
 void APlayerCharacterController::StartAiming()
 {
+	COMBAT_REPLAY_INPUT(this, StartAim);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	if (GetCharacterMovement()->IsFalling()) return;
@@ -486,6 +634,8 @@ void APlayerCharacterController::StartAiming()
 
 void APlayerCharacterController::StopAiming()
 {
+	COMBAT_REPLAY_INPUT(this, StopAim);
+
 	if (bIsPlayerDeadExecuted) return;
 
 	bIsAiming = false;
@@ -520,8 +670,8 @@ void APlayerCharacterController::StopSwitchToPrimary1()
 	if (bIsPlayerDeadExecuted) return;
 
 	bIsWeaponHolstering = false;
-	WeaponManager->EquipWeapon(AssaultRifleData);
-	CurrentWeaponSlot = AssaultRifleData.WeaponName;
+	WeaponManager->EquipWeapon(EWeaponSlot::Primary1);
+	CurrentWeaponSlot = EWeaponSlot::Primary1;
 	bIsPrimaryWeapon = true;
 	bStoreIsPrimaryWeaponBeforeHolster = bIsPrimaryWeapon;
 	bCanFire = true;
@@ -533,8 +683,8 @@ void APlayerCharacterController::StopSwitchToPrimary2()
 	if (bIsPlayerDeadExecuted) return;
 
 	bIsWeaponHolstering = false;
-	WeaponManager->EquipWeapon(ShotgunData);
-	CurrentWeaponSlot = ShotgunData.WeaponName;
+	WeaponManager->EquipWeapon(EWeaponSlot::Primary2);
+	CurrentWeaponSlot = EWeaponSlot::Primary2;
 	bIsPrimaryWeapon = true;
 	bStoreIsPrimaryWeaponBeforeHolster = bIsPrimaryWeapon;
 	bCanFire = true;
@@ -546,8 +696,8 @@ void APlayerCharacterController::StopSwitchToSecondary()
 	if (bIsPlayerDeadExecuted) return;
 
 	bIsWeaponHolstering = false;
-	WeaponManager->EquipWeapon(PistolData);
-	CurrentWeaponSlot = PistolData.WeaponName;
+	WeaponManager->EquipWeapon(EWeaponSlot::Secondary);
+	CurrentWeaponSlot = EWeaponSlot::Secondary;
 	bIsPrimaryWeapon = false;
 	bStoreIsPrimaryWeaponBeforeHolster = bIsPrimaryWeapon;
 	bCanFire = true;
@@ -575,49 +725,48 @@ void APlayerCharacterController::StopHolsterWeapon()
 
 void APlayerCharacterController::ReceiveDamage(float Amount)
 {
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatReceiveDamage, ReceiveDamage);
+	COMBAT_TRACE_SCOPE("APlayerCharacterController::ReceiveDamage");
+
 	if (bIsPlayerDeadExecuted) return;
 
-	if (CurrentShieldPool > 0.0f)
-	{
-		float ShieldDamage = FMath::Min(CurrentShieldPool, Amount);
-		CurrentShieldPool -= ShieldDamage;
-		Amount -= ShieldDamage;
-	}
+	COMBAT_COUNT(DamageEvents, 1);
+	COMBAT_TRACE_EVENT(DamageApplied, this, Amount, CurrentShieldPool, CurrentHealthPool);
 
-	if (Amount > 0.0f)
+	const bool bShieldBroken = CombatMath::ApplyDamage(CurrentShieldPool, CurrentHealthPool, MaxHealthPool, Amount);
+	if (bShieldBroken)
 	{
-		CurrentHealthPool = FMath::Clamp(CurrentHealthPool - Amount, 0.0f, MaxHealthPool);
+		COMBAT_TRACE_EVENT(ShieldBroken, this);
 	}
+	COMBAT_TELEMETRY(DamageApplied, this, Amount, CurrentShieldPool, CurrentHealthPool, bShieldBroken);
+	COMBAT_REPLAY_DAMAGE(this, Amount, CurrentShieldPool, CurrentHealthPool);
+
+	COMBAT_HOTPATH_LOG(Warning, TEXT("Current Shield Pool: %f"), CurrentShieldPool);
+	COMBAT_HOTPATH_LOG(Warning, TEXT("Current Health Pool: %f"), CurrentHealthPool);
 
-	UE_LOG(LogTemp, Warning, TEXT("Current Shield Pool: %f"), CurrentShieldPool);
-	UE_LOG(LogTemp, Warning, TEXT("Current Health Pool: %f"), CurrentHealthPool);
+	LastDamageTime = UCombatSimulationSubsystem::GetTime(this);
 
-	LastDamageTime = GetWorld()->GetTimeSeconds();
+	PublishHealth();
 }
 
 void APlayerCharacterController::RegenerateShieldAndHealth(float DeltaTime)
 {
 	if (bIsPlayerDeadExecuted) return;
 
-	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float CurrentTime = UCombatSimulationSubsystem::GetTime(this);
 
-	// Regenerate health first if not full and delay passed
-	if (CurrentHealthPool < MaxHealthPool &&
-		HealthRegenSpeed > 0.0f &&
-		(CurrentTime - LastDamageTime) >= HealthRegenDelay)
-	{
-		CurrentHealthPool += HealthRegenSpeed * DeltaTime;
-		CurrentHealthPool = FMath::Clamp(CurrentHealthPool, 0.0f, MaxHealthPool);
-	}
+	// Health first, the shield only once health is full
+	CombatMath::RegenHealthThenShield(CurrentHealthPool, MaxHealthPool, CurrentShieldPool, MaxShieldPool, HealthRegenSpeed, DeltaTime,
+		CurrentTime - LastDamageTime, HealthRegenDelay, ShieldRegenDelay);
+
+	PublishHealth();
+}
 
-	// Only regenerate shield if health is full, shield not full, and shield delay passed
-	if (CurrentHealthPool >= MaxHealthPool &&
-		CurrentShieldPool < MaxShieldPool &&
-		HealthRegenSpeed > 0.0f &&
-		(CurrentTime - LastDamageTime) >= ShieldRegenDelay)
+void APlayerCharacterController::PublishHealth()
+{
+	if (UCombatHUDViewModel* HUDViewModel = UCombatHUDViewModel::Get(this))
 	{
-		CurrentShieldPool += HealthRegenSpeed * DeltaTime;
-		CurrentShieldPool = FMath::Clamp(CurrentShieldPool, 0.0f, MaxShieldPool);
+		HUDViewModel->SetHealthAndShield(CurrentHealthPool, MaxHealthPool, CurrentShieldPool, MaxShieldPool);
 	}
 }
 
@@ -625,10 +774,10 @@ void APlayerCharacterController::EnemyTracker()
 {
 	if (bIsPlayerDead) return;
 
-	if (LevelManager)
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
 	{
-		DeadEnemies = LevelManager->GetDeadEnemyCount();
-		TotalEnemies = LevelManager->GetTotalEnemies();
+		DeadEnemies = Registry->GetDeadEnemyCount();
+		TotalEnemies = Registry->GetTotalEnemyCount();
 	}
 }
 
@@ -639,9 +788,16 @@ void APlayerCharacterController::CheckPlayerHealth()
 		if (!bIsPlayerDeadExecuted)
 		{
 			bIsPlayerDeadExecuted = true;
-			float PlayerDeathAnimationDuration = PlayerDeathAnimSequence->GetPlayLength();
-
-			GetWorldTimerManager().SetTimer(PlayerDeathTimerHandle, this, &APlayerCharacterController::ConfirmPlayerDeath, PlayerDeathAnimationDuration, false);
+			const float PlayerDeathAnimationDuration = PlayerDeathAnimSequence ? PlayerDeathAnimSequence->GetPlayLength() : 0.0f;
+
+			if (PlayerDeathAnimationDuration > 0.0f)
+			{
+				UCombatSimulationSubsystem::SetTimer(this, PlayerDeathTimerHandle, &APlayerCharacterController::ConfirmPlayerDeath, PlayerDeathAnimationDuration, false);
+			}
+			else
+			{
+				ConfirmPlayerDeath();
+			}
 		}
 	}
 }
@@ -651,3 +807,22 @@ void APlayerCharacterController::ConfirmPlayerDeath()
 	bIsPlayerDead = true;
 }
 
+void APlayerCharacterController::RestoreCombatState(float ShieldPool, float HealthPool)
+{
+	UCombatSimulationSubsystem::ClearTimer(this, PlayerDeathTimerHandle);
+
+	CurrentShieldPool = ShieldPool;
+	CurrentHealthPool = HealthPool;
+	LastDamageTime = UCombatSimulationSubsystem::GetTime(this);
+
+	bIsPlayerDead = false;
+	bIsPlayerDeadExecuted = false;
+	bIsFiring = false;
+
+	// A press cut short by the restore never reaches StopFiring; a switch in flight re-enables fire when it lands
+	bCanFire = !bIsWeaponHolstering;
+
+	PublishHealth();
+	EnemyTracker();
+}
+
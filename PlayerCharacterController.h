@@ -2,6 +2,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "WeaponManagerComponent.h"
+#include "CombatSimulationSubsystem.h"
 #include "PlayerCharacterController.generated.h"
 
 class USpringArmComponent;
@@ -11,6 +12,8 @@ class UInputAction;
 struct FInputActionValue;
 class AActor;
 class ALevelManager;
+class UWeaponDefinition;
+class UCombatCharacterMovementComponent;
 
 UCLASS()
 class COMBATSYSTEM_API APlayerCharacterController : public ACharacter
@@ -19,12 +22,14 @@ class COMBATSYSTEM_API APlayerCharacterController : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	APlayerCharacterController();
+	APlayerCharacterController(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
 public:
@@ -33,6 +38,8 @@ public:
 
 	void HandleJump();
 
+	virtual void StopJumping() override;
+
 	void Move(const FInputActionValue& Value);
 
 	void Look(const FInputActionValue& Value);
@@ -43,20 +50,32 @@ public:
 
 	void CheckForWallRun();
 
+	// Records the wall and asks the movement component to start wall running against it
 	void StartWallRun(bool bIsRightWall, const FHitResult& WallHit);
 
-	void StopWallRun();
-
 	bool CanWallRunOnSurface(FHitResult& WallHit);
 
-	void ResetWallRunCooldown();
-
 	void WallJump();
 
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
+
+	UCombatCharacterMovementComponent* GetCombatMovement() const;
+
 	float TargetArmLengthWalking = 150.0f;
 	float TargetArmLengthRunning = 100.0f;
 	float SpringArmInterpSpeed = 10.0f;
 
+	float GetDesiredArmLength() const;
+
+	// Arm length at the last two fixed combat steps; frames in between show a blend of them
+	float PreviousStepArmLength = 0.0f;
+	float StepArmLength = 0.0f;
+
+	// Bound while the combat clock runs fixed steps: regen and the spring arm advance on those
+	FDelegateHandle CombatStepHandle;
+
+	void CombatStep(float StepSeconds);
+
 	FVector2D MovementVector; // to store last move direction
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
@@ -122,9 +141,6 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Wall Running")
 	bool bIsWallRunning = false;
 
-	FTimerHandle WallRunTimerHandle;
-	bool bWallRunCooldown = false;
-	FTimerHandle WallRunCooldownHandle;
 	float WallRunCooldownDuration = 0.5f;
 
 	FVector LastWallNormal = FVector::ZeroVector;
@@ -153,16 +169,16 @@ public:
 	void Reloading();
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapons")
-	FWeaponData AssaultRifleData;
+	UWeaponDefinition* AssaultRifleData;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapons")
-	FWeaponData ShotgunData;
+	UWeaponDefinition* ShotgunData;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapons")
-	FWeaponData PistolData;
+	UWeaponDefinition* PistolData;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapons")
-	FName CurrentWeaponSlot;
+	EWeaponSlot CurrentWeaponSlot = EWeaponSlot::None;
 
 	void StartSwitchToPrimary1();
 
@@ -205,7 +221,7 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapons")
 	bool bIsWeaponBeingPutAway = false;
 
-	FTimerHandle WeaponSwitchTimerHandle;
+	FCombatTimerHandle WeaponSwitchTimerHandle;
 	float WeaponHolsterDelayTime = 2.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -248,9 +264,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Player Health System")
 	virtual void ReceiveDamage(float Amount);
 
+	// Brings the player back to a captured state, alive. Used by the combat snapshot restore.
+	void RestoreCombatState(float ShieldPool, float HealthPool);
+
 	// Shield regeneration logic
 	void RegenerateShieldAndHealth(float DeltaTime);
 
+	// Pushes health and shield to the HUD view model, which ignores values that didn't change
+	void PublishHealth();
+
 	UPROPERTY()
 	ALevelManager* LevelManager;
 
@@ -260,6 +282,7 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Enemy Tracker")
 	int TotalEnemies = 0;
 
+	// Mirrors the registry's enemy counts, called whenever they change
 	void EnemyTracker();
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Death")
@@ -271,7 +294,7 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Death")
 	UAnimSequence* PlayerDeathAnimSequence;
 
-	FTimerHandle PlayerDeathTimerHandle;
+	FCombatTimerHandle PlayerDeathTimerHandle;
 
 	void CheckPlayerHealth();
 
@@ -284,4 +307,4 @@ public:
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
 
-};
\ No newline at end of file
+};
\ No newline at end of file
@@ -3,3 +3,60 @@
 
 #include "SaveGameData.h"
 
+FLevelProgressRecord& USaveGameData::FindOrAddLevel(FName LevelName)
+{
+	for (FLevelProgressRecord& Record : LevelProgress)
+	{
+		if (Record.LevelName == LevelName)
+		{
+			return Record;
+		}
+	}
+
+	FLevelProgressRecord& Record = LevelProgress.AddDefaulted_GetRef();
+	Record.LevelName = LevelName;
+	return Record;
+}
+
+const FLevelProgressRecord* USaveGameData::FindLevel(FName LevelName) const
+{
+	return LevelProgress.FindByPredicate([LevelName](const FLevelProgressRecord& Record) { return Record.LevelName == LevelName; });
+}
+
+void USaveGameData::SerializeCompact(FArchive& Ar, uint16 Version)
+{
+	uint8 Flags = bIsLevel2Unlocked ? 1 : 0;
+	Ar << Flags;
+	bIsLevel2Unlocked = (Flags & 1) != 0;
+
+	int32 NumLevels = LevelProgress.Num();
+	Ar << NumLevels;
+
+	if (Ar.IsLoading())
+	{
+		if (NumLevels < 0 || NumLevels > 1024)
+		{
+			Ar.SetError();
+			return;
+		}
+		LevelProgress.SetNum(NumLevels);
+	}
+
+	for (FLevelProgressRecord& Record : LevelProgress)
+	{
+		FString LevelName = Record.LevelName.ToString();
+		Ar << LevelName;
+		Record.LevelName = FName(*LevelName);
+
+		uint8 LevelFlags = (Record.bUnlocked ? 1 : 0) | (Record.bCompleted ? 2 : 0);
+		Ar << LevelFlags;
+		Record.bUnlocked = (LevelFlags & 1) != 0;
+		Record.bCompleted = (LevelFlags & 2) != 0;
+
+		Ar << Record.TimesCompleted;
+		Ar << Record.BestCompletionSeconds;
+		Ar << Record.EnemiesKilled;
+
+		// Fields added in later versions go here, guarded by Version
+	}
+}
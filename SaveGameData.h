@@ -6,6 +6,31 @@
 #include "GameFramework/SaveGame.h"
 #include "SaveGameData.generated.h"
 
+USTRUCT(BlueprintType)
+struct FLevelProgressRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	FName LevelName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	bool bUnlocked = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	bool bCompleted = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	int32 TimesCompleted = 0;
+
+	// Zero until the level has been completed once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	float BestCompletionSeconds = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	int32 EnemiesKilled = 0;
+};
+
 /**
  * 
  */
@@ -17,5 +42,18 @@ class COMBATSYSTEM_API USaveGameData : public USaveGame
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
 	bool bIsLevel2Unlocked = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveData")
+	TArray<FLevelProgressRecord> LevelProgress;
+
+	FLevelProgressRecord& FindOrAddLevel(FName LevelName);
+
+	const FLevelProgressRecord* FindLevel(FName LevelName) const;
+
+	// Compact binary layout written by UCombatSaveSubsystem. Bump CompactVersion when fields are appended.
+	static constexpr uint32 CompactMagic = 0x56415343; // "CSAV"
+	static constexpr uint16 CompactVersion = 1;
+
+	void SerializeCompact(FArchive& Ar, uint16 Version);
 	
 };
@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WallRunSurfaceIndex.h"
+#include "CombatActorRegistry.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarCombatWallRunIndex(
+	TEXT("Combat.WallRunIndex"),
+	true,
+	TEXT("Find wall-run surfaces through the baked surface index. Disable to use two side traces every airborne frame."));
+
+namespace WallRunSurfaceIndex
+{
+	// Faces tilted further than this from vertical can't be run on
+	static constexpr float MaxNormalZ = 0.3f;
+
+	// Probes nearly parallel to a face never reach it
+	static constexpr float MinProbeAlignment = 0.1f;
+}
+
+AWallRunSurfaceIndex::AWallRunSurfaceIndex()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+bool AWallRunSurfaceIndex::IsQueryEnabled()
+{
+	return CVarCombatWallRunIndex.GetValueOnGameThread();
+}
+
+void AWallRunSurfaceIndex::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (Surfaces.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no baked wall surfaces, baking at runtime."), *GetName());
+		BakeSurfaces();
+	}
+
+	BuildGrid();
+
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->RegisterWallRunIndex(this);
+	}
+}
+
+void AWallRunSurfaceIndex::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatActorRegistry* Registry = UCombatActorRegistry::Get(this))
+	{
+		Registry->UnregisterWallRunIndex(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AWallRunSurfaceIndex::BakeSurfaces()
+{
+	Modify();
+	Surfaces.Reset();
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (!Actor->ActorHasTag(WallTag)) continue;
+
+		const FBox LocalBox = Actor->CalculateComponentsBoundingBoxInLocalSpace(false);
+		if (!LocalBox.IsValid) continue;
+
+		const FTransform& Transform = Actor->GetActorTransform();
+		const FVector Scale = Transform.GetScale3D().GetAbs();
+		const FVector LocalCenter = LocalBox.GetCenter();
+		const FVector LocalExtent = LocalBox.GetExtent();
+
+		// The four side faces of the actor's local box; top and bottom are never vertical
+		for (int32 Axis = 0; Axis < 2; ++Axis)
+		{
+			const int32 TangentAxis = 1 - Axis;
+
+			for (const float Sign : { 1.0f, -1.0f })
+			{
+				FVector LocalNormal = FVector::ZeroVector;
+				LocalNormal[Axis] = Sign;
+
+				FVector LocalTangent = FVector::ZeroVector;
+				LocalTangent[TangentAxis] = 1.0f;
+
+				const FVector Normal = Transform.TransformVectorNoScale(LocalNormal);
+				if (FMath::Abs(Normal.Z) > WallRunSurfaceIndex::MaxNormalZ) continue;
+
+				FWallRunSurface& Surface = Surfaces.AddDefaulted_GetRef();
+				Surface.Center = Transform.TransformPosition(LocalCenter + LocalNormal * LocalExtent[Axis]);
+				Surface.Normal = Normal;
+				Surface.Tangent = Transform.TransformVectorNoScale(LocalTangent);
+				Surface.HalfLength = LocalExtent[TangentAxis] * Scale[TangentAxis];
+				Surface.HalfHeight = LocalExtent.Z * Scale.Z;
+				Surface.WallActor = Actor;
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Baked %d wall-run surfaces."), Surfaces.Num());
+}
+
+FIntPoint AWallRunSurfaceIndex::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void AWallRunSurfaceIndex::BuildGrid()
+{
+	Grid.Reset();
+
+	for (int32 SurfaceIndex = 0; SurfaceIndex < Surfaces.Num(); ++SurfaceIndex)
+	{
+		const FWallRunSurface& Surface = Surfaces[SurfaceIndex];
+
+		// Every cell a character within MaxQueryDistance of the face could stand in
+		FBox Bounds(ForceInit);
+		Bounds += Surface.Center + Surface.Tangent * Surface.HalfLength;
+		Bounds += Surface.Center - Surface.Tangent * Surface.HalfLength;
+		Bounds = Bounds.ExpandBy(MaxQueryDistance);
+
+		const FIntPoint MinCell = GetCell(Bounds.Min);
+		const FIntPoint MaxCell = GetCell(Bounds.Max);
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				Grid.FindOrAdd(FIntPoint(X, Y)).Add(SurfaceIndex);
+			}
+		}
+	}
+}
+
+bool AWallRunSurfaceIndex::FindSurfaces(const FVector& Location, const FVector& RightVector, float MaxDistance, const FWallRunSurface*& OutRight, const FWallRunSurface*& OutLeft) const
+{
+	OutRight = nullptr;
+	OutLeft = nullptr;
+
+	const TArray<int32, TInlineAllocator<4>>* Cell = Grid.Find(GetCell(Location));
+	if (!Cell) return false;
+
+	MaxDistance = FMath::Min(MaxDistance, MaxQueryDistance);
+
+	float BestRightDistance = MaxDistance;
+	float BestLeftDistance = MaxDistance;
+
+	for (const int32 SurfaceIndex : *Cell)
+	{
+		const FWallRunSurface& Surface = Surfaces[SurfaceIndex];
+
+		// Must be in front of the face
+		const float PlaneDistance = FVector::DotProduct(Location - Surface.Center, Surface.Normal);
+		if (PlaneDistance < 0.0f) continue;
+
+		// A wall on the right faces left, so the probe runs against its normal
+		const float Alignment = FVector::DotProduct(RightVector, Surface.Normal);
+		if (FMath::Abs(Alignment) < WallRunSurfaceIndex::MinProbeAlignment) continue;
+
+		const bool bIsRight = Alignment < 0.0f;
+		const float ProbeDistance = PlaneDistance / FMath::Abs(Alignment);
+		if (ProbeDistance > (bIsRight ? BestRightDistance : BestLeftDistance)) continue;
+
+		// Where the sideways probe crosses the plane has to lie on the face
+		const FVector Crossing = Location + RightVector * (bIsRight ? ProbeDistance : -ProbeDistance);
+		const FVector FromCenter = Crossing - Surface.Center;
+		if (FMath::Abs(FVector::DotProduct(FromCenter, Surface.Tangent)) > Surface.HalfLength) continue;
+		if (FMath::Abs(FromCenter.Z) > Surface.HalfHeight) continue;
+
+		if (bIsRight)
+		{
+			OutRight = &Surface;
+			BestRightDistance = ProbeDistance;
+		}
+		else
+		{
+			OutLeft = &Surface;
+			BestLeftDistance = ProbeDistance;
+		}
+	}
+
+	return OutRight || OutLeft;
+}
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WallRunSurfaceIndex.generated.h"
+
+// One vertical face of a "Wall"-tagged actor
+USTRUCT()
+struct FWallRunSurface
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector Center = FVector::ZeroVector;
+
+	// Points away from the wall, towards where a wall-running character would be
+	UPROPERTY()
+	FVector Normal = FVector::ForwardVector;
+
+	// Horizontal direction along the face
+	UPROPERTY()
+	FVector Tangent = FVector::RightVector;
+
+	UPROPERTY()
+	float HalfLength = 0.0f;
+
+	UPROPERTY()
+	float HalfHeight = 0.0f;
+
+	UPROPERTY()
+	AActor* WallActor = nullptr;
+};
+
+/**
+ * Baked index of every wall-runnable face in the level. Press Bake Surfaces after moving
+ * walls around; levels without a bake are baked once on BeginPlay. At runtime faces are
+ * bucketed into a 2D grid, so finding a wall next to the player is a cell lookup and a
+ * few plane tests instead of side traces every airborne frame.
+ */
+UCLASS()
+class COMBATSYSTEM_API AWallRunSurfaceIndex : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AWallRunSurfaceIndex();
+
+	// Walls are found by this tag, the same one CanWallRunOnSurface checks
+	UPROPERTY(EditAnywhere, Category = "Wall Running")
+	FName WallTag = FName("Wall");
+
+	// Largest distance the index is queried with. Faces are bucketed into every cell within this range.
+	UPROPERTY(EditAnywhere, Category = "Wall Running")
+	float MaxQueryDistance = 200.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Wall Running")
+	float CellSize = 500.0f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Wall Running")
+	TArray<FWallRunSurface> Surfaces;
+
+	UFUNCTION(CallInEditor, Category = "Wall Running")
+	void BakeSurfaces();
+
+	// Closest face on each side the character would hit probing sideways up to MaxDistance, either may be null.
+	// Returns false when neither side has one. Callers try the right side first, like the traces it replaces.
+	bool FindSurfaces(const FVector& Location, const FVector& RightVector, float MaxDistance, const FWallRunSurface*& OutRight, const FWallRunSurface*& OutLeft) const;
+
+	// Combat.WallRunIndex, lets the per-frame check fall back to side traces for comparison
+	static bool IsQueryEnabled();
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Grid;
+
+	void BuildGrid();
+
+	FIntPoint GetCell(const FVector& Location) const;
+};
@@ -2,6 +2,8 @@
 
 
 #include "WeaponActor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
 
 // Sets default values
 AWeaponActor::AWeaponActor()
@@ -11,5 +13,27 @@ AWeaponActor::AWeaponActor()
 	WeaponMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("WeaponMesh"));
 	RootComponent = WeaponMesh;
 
+	HolsteredMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("HolsteredMesh"));
+	HolsteredMesh->SetupAttachment(WeaponMesh);
+	HolsteredMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	HolsteredMesh->SetGenerateOverlapEvents(false);
+	HolsteredMesh->SetVisibility(false);
+
 }
 
+void AWeaponActor::SetHolstered(bool bHolstered)
+{
+	if (bIsHolstered == bHolstered) return;
+
+	bIsHolstered = bHolstered;
+
+	// Without a stand-in mesh the skeletal mesh stays visible, but its pose is still frozen while holstered
+	const bool bUseStandIn = bHolstered && HolsteredMesh->GetStaticMesh() != nullptr;
+
+	WeaponMesh->bPauseAnims = bHolstered;
+	WeaponMesh->bNoSkeletonUpdate = bHolstered;
+	WeaponMesh->SetComponentTickEnabled(!bHolstered);
+	WeaponMesh->SetVisibility(!bUseStandIn, false);
+
+	HolsteredMesh->SetVisibility(bUseStandIn);
+}
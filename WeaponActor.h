@@ -6,6 +6,8 @@
 #include "GameFramework/Actor.h"
 #include "WeaponActor.generated.h"
 
+class UStaticMeshComponent;
+
 UCLASS()
 class COMBATSYSTEM_API AWeaponActor : public AActor
 {
@@ -20,4 +22,17 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon")
 	USkeletalMeshComponent* WeaponMesh;
 
+	// Cheap stand-in drawn while the weapon sits in a holster. Assign a static mesh in the weapon blueprint.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon")
+	UStaticMeshComponent* HolsteredMesh;
+
+	// Swaps the animated skeletal mesh for the holstered stand-in and back
+	void SetHolstered(bool bHolstered);
+
+	bool IsHolstered() const { return bIsHolstered; }
+
+private:
+
+	bool bIsHolstered = false;
+
 };
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinition.h"
+
+void UWeaponDefinition::GetVisualAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	if (!WeaponClass.IsNull())
+	{
+		OutPaths.Add(WeaponClass.ToSoftObjectPath());
+	}
+}
+
+void UWeaponDefinition::GetFireAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	if (!FireSound.IsNull())
+	{
+		OutPaths.Add(FireSound.ToSoftObjectPath());
+	}
+
+	if (!MuzzleFlash.IsNull())
+	{
+		OutPaths.Add(MuzzleFlash.ToSoftObjectPath());
+	}
+
+	if (!BulletTracerClass.IsNull())
+	{
+		OutPaths.Add(BulletTracerClass.ToSoftObjectPath());
+	}
+
+	if (!ImpactEffect.IsNull())
+	{
+		OutPaths.Add(ImpactEffect.ToSoftObjectPath());
+	}
+}
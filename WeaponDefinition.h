@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/SoftObjectPtr.h"
+#include "WeaponDefinition.generated.h"
+
+class AWeaponActor;
+class USoundBase;
+class UParticleSystem;
+
+UENUM(BlueprintType)
+enum class EFireMode : uint8
+{
+	Single,
+	Automatic
+};
+
+/**
+ * Shared, read-only description of a weapon. Everything that changes at runtime
+ * (ammo, the spawned actor) lives in FWeaponSlotState on the weapon manager.
+ * Meshes, sounds and FX are soft references streamed in by the weapon manager.
+ */
+UCLASS(BlueprintType)
+class COMBATSYSTEM_API UWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	FName WeaponName;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	EFireMode FireMode = EFireMode::Single;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	int32 AmmoPerMag = 30;
+
+	// Full magazines carried on top of the loaded one when the weapon is first given to a slot
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	int32 StartingMagazines = 3;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float FireRate = 10.0f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float DamagePerBullet = 10.0f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float MaxWeaponHitDistance = 10000.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	TSoftClassPtr<AWeaponActor> WeaponClass;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Sockets")
+	FName MuzzleSocketName;
+
+	// Character socket the weapon is held in while equipped
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Sockets")
+	FName EquipSocketName = FName("PrimaryWeaponHolder");
+
+	// Character socket the weapon is attached to while holstered
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Sockets")
+	FName HolsterSocketName;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|FX")
+	TSoftObjectPtr<USoundBase> FireSound;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|FX")
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|FX")
+	TSoftClassPtr<AActor> BulletTracerClass;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|FX")
+	TSoftObjectPtr<UParticleSystem> ImpactEffect;
+
+	// Assets needed to spawn the weapon, including while it sits in a holster
+	void GetVisualAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	// Assets only needed once the weapon is equipped and firing
+	void GetFireAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+};
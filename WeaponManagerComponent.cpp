@@ -2,16 +2,34 @@
 
 
 #include "WeaponManagerComponent.h"
-#include "TimerManager.h"
+#include "CombatSimulationSubsystem.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/ProjectileMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "Engine/AssetManager.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundBase.h"
 #include "EnemyBase.h"
 #include "WeaponActor.h" 
+#include "CombatStartupSubsystem.h"
+#include "CombatHUDViewModel.h"
+#include "CombatEventBus.h"
+#include "CombatStats.h"
+#include "CombatTrace.h"
+#include "CombatTelemetry.h"
+#include "CombatReplay.h"
+#include "CombatLatencySubsystem.h"
+#include "CombatMemory.h"
+#include "CombatMath.h"
+#include "Misc/AutomationTest.h"
 
 // Sets default values for this component's properties
 UWeaponManagerComponent::UWeaponManagerComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
+
+	// Only needed to drain automatic fire, StartFire turns it on
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 }
 
 
@@ -22,60 +40,237 @@ void UWeaponManagerComponent::BeginPlay()
 
 	WeaponOwner = GetOwner();
 
-	// Holster all available weapons at startup (except the default equipped one)
-	for (const auto& Pair : AllWeapons)
+	// Holster all available weapons (except the default equipped one) over the first frames.
+	// Owners that create the manager at runtime fill the slots and CurrentSlot before registering it.
+	for (int32 SlotIndex = 0; SlotIndex < NumWeaponSlots; ++SlotIndex)
 	{
-		if (Pair.Key != CurrentWeapon.WeaponName)
+		const EWeaponSlot Slot = static_cast<EWeaponSlot>(SlotIndex);
+		if (Slot != CurrentSlot && WeaponSlots[SlotIndex].Definition)
 		{
-			SpawnAndHolsterWeapon(Pair.Value);
+			UCombatStartupSubsystem::Defer(this, TEXT("WeaponManager.HolsterWeapon"), ECombatStartupPriority::Low,
+				[WeakThis = TWeakObjectPtr<UWeaponManagerComponent>(this), Slot]()
+				{
+					if (UWeaponManagerComponent* Manager = WeakThis.Get())
+					{
+						Manager->SpawnAndHolsterWeapon(Slot);
+					}
+				});
 		}
 	}
 
 	// Equip initial weapon (like AssaultRifle)
-	EquipWeapon(CurrentWeapon);
+	EquipWeapon(CurrentSlot);
+
+	UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this);
+	if (Simulation && Simulation->IsFixedStep())
+	{
+		CombatStepHandle = Simulation->OnStep.AddUObject(this, &UWeaponManagerComponent::CombatStep);
+	}
+}
+
+void UWeaponManagerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatSimulationSubsystem* Simulation = UCombatSimulationSubsystem::Get(this))
+	{
+		Simulation->OnStep.Remove(CombatStepHandle);
+	}
+	CombatStepHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void UWeaponManagerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	CurrentWeaponName = CurrentWeapon.WeaponName;
-	CurrentWeaponMagAmmo = CurrentWeapon.CurrentAmmo;
-	CurrentWeaponTotalAmmo = (CurrentWeapon.Magazines * CurrentWeapon.AmmoPerMag) + CurrentWeapon.TempAmmoPool;
+	if (!DrainFireCadence(MaxShotsPerFrame))
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UWeaponManagerComponent::CombatStep(float StepSeconds)
+{
+	// The clock already caps how many steps a frame may catch up, so every shot due in a step fires
+	DrainFireCadence(MAX_int32);
+}
+
+bool UWeaponManagerComponent::DrainFireCadence(int32 MaxShots)
+{
+	const FWeaponSlotState* Weapon = GetCurrentSlotState();
+	if (!bIsFiring || !Weapon || Weapon->Definition->FireMode != EFireMode::Automatic) return false;
+
+	TArray<double, TInlineAllocator<8>> ShotTimes;
+	if (FireCadence.ConsumeDueShots(UCombatSimulationSubsystem::GetTime(this), MaxShots, ShotTimes) > 0)
+	{
+		FireBatch(ShotTimes);
+	}
+	return true;
+}
+
+void UWeaponManagerComponent::PublishWeaponState()
+{
+	const FWeaponSlotState* Weapon = GetCurrentSlotState();
+	CurrentWeaponName = Weapon ? Weapon->Definition->WeaponName : NAME_None;
+	CurrentWeaponMagAmmo = Weapon ? Weapon->CurrentAmmo : 0;
+	CurrentWeaponTotalAmmo = Weapon ? Weapon->GetTotalAmmo() : 0;
+
+	// Only the local player's weapons feed the HUD
+	const APawn* PawnOwner = Cast<APawn>(WeaponOwner);
+	if (!PawnOwner || !PawnOwner->IsLocallyControlled()) return;
 
-	if (CurrentWeaponName == "None")
+	if (UCombatHUDViewModel* HUDViewModel = UCombatHUDViewModel::Get(this))
 	{
-		CurrentWeaponMagAmmo = 0;
-		CurrentWeaponTotalAmmo = 0;
+		HUDViewModel->SetWeapon(CurrentWeaponName, CurrentWeaponMagAmmo, CurrentWeaponTotalAmmo);
+		HUDViewModel->SetReloading(bIsReloading);
 	}
+}
+
+FWeaponSlotState* UWeaponManagerComponent::GetCurrentSlotState()
+{
+	if (CurrentSlot == EWeaponSlot::None) return nullptr;
+
+	FWeaponSlotState& Weapon = GetSlotState(CurrentSlot);
+	return Weapon.Definition ? &Weapon : nullptr;
+}
+
+const FWeaponSlotState* UWeaponManagerComponent::GetCurrentSlotState() const
+{
+	return const_cast<UWeaponManagerComponent*>(this)->GetCurrentSlotState();
+}
+
+void UWeaponManagerComponent::InitializeSlot(EWeaponSlot Slot, UWeaponDefinition* Definition)
+{
+	if (Slot == EWeaponSlot::None) return;
+
+	FWeaponSlotState& Weapon = GetSlotState(Slot);
+	Weapon.Definition = Definition;
+	Weapon.CurrentAmmo = Definition ? Definition->AmmoPerMag : 0;
+	Weapon.Magazines = Definition ? Definition->StartingMagazines : 0;
+	Weapon.TempAmmoPool = 0;
+
+	const int32 SlotIndex = static_cast<int32>(Slot);
+	SlotVisualHandles[SlotIndex].Reset();
+	SlotFireHandles[SlotIndex].Reset();
+
+	PublishWeaponState();
+}
+
+void UWeaponManagerComponent::RestoreSlotAmmo(EWeaponSlot Slot, int32 CurrentAmmo, int32 Magazines, int32 TempAmmoPool)
+{
+	if (Slot == EWeaponSlot::None) return;
+
+	StopFire();
+
+	if (bIsReloading)
+	{
+		UCombatSimulationSubsystem::ClearTimer(this, ReloadTimerHandle);
+		bIsReloading = false;
+	}
+
+	FWeaponSlotState& Weapon = GetSlotState(Slot);
+	Weapon.CurrentAmmo = CurrentAmmo;
+	Weapon.Magazines = Magazines;
+	Weapon.TempAmmoPool = TempAmmoPool;
+
+	PublishWeaponState();
+}
+
+void UWeaponManagerComponent::PreloadSlot(EWeaponSlot Slot)
+{
+	RequestSlotVisuals(Slot, FStreamableManager::AsyncLoadHighPriority);
+	RequestSlotFireAssets(Slot, FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UWeaponManagerComponent::RequestSlotVisuals(EWeaponSlot Slot, TAsyncLoadPriority Priority)
+{
+	if (Slot == EWeaponSlot::None) return;
+
+	const UWeaponDefinition* Definition = GetSlotState(Slot).Definition;
+	if (!Definition) return;
+
+	if (Definition->WeaponClass.Get())
+	{
+		OnSlotVisualsLoaded(Slot);
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle>& Handle = SlotVisualHandles[static_cast<int32>(Slot)];
+	if (Handle.IsValid() && Handle->IsLoadingInProgress()) return;
 
-	GetCurrentReloadMode();
+	TArray<FSoftObjectPath> AssetPaths;
+	Definition->GetVisualAssetPaths(AssetPaths);
+	if (AssetPaths.Num() == 0) return;
+
+	Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		AssetPaths,
+		FStreamableDelegate::CreateUObject(this, &UWeaponManagerComponent::OnSlotVisualsLoaded, Slot),
+		Priority
+	);
+}
+
+void UWeaponManagerComponent::RequestSlotFireAssets(EWeaponSlot Slot, TAsyncLoadPriority Priority)
+{
+	if (Slot == EWeaponSlot::None) return;
+
+	const UWeaponDefinition* Definition = GetSlotState(Slot).Definition;
+	TSharedPtr<FStreamableHandle>& Handle = SlotFireHandles[static_cast<int32>(Slot)];
+	if (!Definition || Handle.IsValid()) return;
+
+	TArray<FSoftObjectPath> AssetPaths;
+	Definition->GetFireAssetPaths(AssetPaths);
+	if (AssetPaths.Num() == 0) return;
+
+	Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetPaths, FStreamableDelegate(), Priority);
+}
+
+bool UWeaponManagerComponent::AreSlotAssetsLoaded(EWeaponSlot Slot) const
+{
+	if (Slot == EWeaponSlot::None) return false;
+
+	const FWeaponSlotState& Weapon = GetSlotState(Slot);
+	const TSharedPtr<FStreamableHandle>& FireHandle = SlotFireHandles[static_cast<int32>(Slot)];
+
+	return Weapon.SpawnedWeapon && (!FireHandle.IsValid() || FireHandle->HasLoadCompleted());
+}
+
+void UWeaponManagerComponent::OnSlotVisualsLoaded(EWeaponSlot Slot)
+{
+	FWeaponSlotState& Weapon = GetSlotState(Slot);
+	if (!Weapon.SpawnedWeapon && !SpawnWeaponActor(Weapon)) return;
+
+	// A slot equipped while it was still streaming goes straight to the hand
+	if (Slot == CurrentSlot && !bIsWeaponHolstered)
+	{
+		AttachToHand(Weapon);
+		LastEquippedSlot = Slot;
+	}
+	else
+	{
+		AttachToHolster(Weapon);
+	}
 }
 
-void UWeaponManagerComponent::StartFire()
+void UWeaponManagerComponent::StartFire(uint64 InputCycles)
 {
 	if (bIsFiring || !CanFire() || bIsReloading) return;
 
 	bIsFiring = true;
+	PendingInputCycles = InputCycles;
+
+	const UWeaponDefinition* Definition = GetCurrentSlotState()->Definition;
 
-	if (CurrentWeapon.FireMode == EFireMode::Single)
+	if (Definition->FireMode == EFireMode::Single)
 	{
 		Fire();
 		StopFire(); // For single fire, immediately stop after one shot
 	}
-	else if (CurrentWeapon.FireMode == EFireMode::Automatic)
+	else if (Definition->FireMode == EFireMode::Automatic)
 	{
+		// The next shot is due one interval from now; due shots drain on every combat step, or every frame without fixed steps
+		FireCadence.Start(UCombatSimulationSubsystem::GetTime(this), Definition->FireRate);
+		SetComponentTickEnabled(!CombatStepHandle.IsValid());
 		Fire(); //Fire immediately
-		float FireInterval = 1.0f / CurrentWeapon.FireRate;
-
-		GetWorld()->GetTimerManager().SetTimer(
-			AutoFireTimerHandle,
-			this,
-			&UWeaponManagerComponent::Fire,
-			FireInterval,
-			true,
-			FireInterval //Delay for the *next* shot only
-		);
 	}
 }
 
@@ -83,169 +278,299 @@ void UWeaponManagerComponent::StartFire()
 void UWeaponManagerComponent::StopFire()
 {
 	bIsFiring = false;
-	GetWorld()->GetTimerManager().ClearTimer(AutoFireTimerHandle);
+	SetComponentTickEnabled(false);
 }
 
 void UWeaponManagerComponent::Fire()
 {
-	if (!CanFire()) return;
+	const double ShotTime = UCombatSimulationSubsystem::GetTime(this);
+	FireBatch(MakeArrayView(&ShotTime, 1));
+}
+
+void UWeaponManagerComponent::FireBatch(TConstArrayView<double> ShotTimes)
+{
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatWeaponFire, WeaponFire);
+	COMBAT_TRACE_SCOPE("UWeaponManagerComponent::FireBatch");
+	LLM_SCOPE_BYTAG(Combat_FX);
 
-	UE_LOG(LogTemp, Log, TEXT("Firing %s"), *CurrentWeapon.WeaponName.ToString());
+	FWeaponSlotState* Weapon = GetCurrentSlotState();
+	if (!Weapon) return;
 
-	CurrentWeapon.CurrentAmmo--;
+	const UWeaponDefinition* Definition = Weapon->Definition;
 
-	if (CurrentWeapon.CurrentAmmo <= 0)
+	// Only the first batch after a press is input latency, later automatic shots are paced by the cadence
+	const uint64 InputCycles = PendingInputCycles;
+	PendingInputCycles = 0;
+	UCombatLatencySubsystem* Latency = InputCycles != 0 ? UCombatLatencySubsystem::Get(this) : nullptr;
+
+	// Resolve ammo for every shot up front, the aim, trace and FX below are shared by the whole batch
+	int32 ShotsFired = 0;
+	for (int32 ShotIndex = 0; ShotIndex < ShotTimes.Num(); ++ShotIndex)
 	{
-		StopFire(); // Stop the auto-fire loop
-		TriggerReload(); // Start reloading immediately
-		return;
+		if (!CanFire()) break;
+
+		COMBAT_HOTPATH_LOG(Log, TEXT("Firing %s"), *Definition->WeaponName.ToString());
+
+		Weapon->CurrentAmmo--;
+
+		if (Weapon->CurrentAmmo <= 0)
+		{
+			StopFire(); // Stop the auto-fire loop
+			TriggerReload(); // Start reloading immediately
+			break;
+		}
+
+		ShotsFired++;
+	}
+
+	PublishWeaponState();
+
+	if (ShotsFired == 0) return;
+
+	UCombatEventBus* EventBus = UCombatEventBus::Get(this);
+	if (EventBus)
+	{
+		EventBus->Channel<FCombatShotFiredEvent>().Publish({ WeaponOwner, Definition->WeaponName, ShotsFired, ShotTimes[0] });
 	}
 
-	// Muzzle flash
-	if (CurrentWeapon.SpawnedWeapon && CurrentWeapon.MuzzleFlash)
+	COMBAT_TRACE_EVENT(ShotFired, WeaponOwner, Definition->WeaponName, ShotsFired);
+	COMBAT_TELEMETRY(ShotFired, WeaponOwner, Definition->WeaponName, ShotsFired, Weapon->CurrentAmmo);
+
+	// FX resolve to null until the slot's fire assets finish streaming
+	UParticleSystem* MuzzleFlash = Definition->MuzzleFlash.Get();
+	USoundBase* FireSound = Definition->FireSound.Get();
+	UClass* BulletTracerClass = Definition->BulletTracerClass.Get();
+	UParticleSystem* ImpactEffect = Definition->ImpactEffect.Get();
+
+	// Muzzle flash, one per batch is indistinguishable from one per shot within a frame
+	if (Weapon->SpawnedWeapon && MuzzleFlash)
 	{
 		UGameplayStatics::SpawnEmitterAttached(
-			CurrentWeapon.MuzzleFlash,
-			CurrentWeapon.SpawnedWeapon->WeaponMesh,
-			CurrentWeapon.MuzzleSocketName
+			MuzzleFlash,
+			Weapon->SpawnedWeapon->WeaponMesh,
+			Definition->MuzzleSocketName
 		);
+		COMBAT_COUNT(Emitters, 1);
+
+		// The muzzle flash is the first feedback the player sees for the press, once the frame is rendered
+		if (Latency)
+		{
+			Latency->RecordAtEndOfFrame(ECombatLatencyStage::FX, InputCycles);
+		}
 
-		if (CurrentWeapon.FireSound)
+		if (FireSound)
 		{
 			UGameplayStatics::SpawnSoundAttached(
-				CurrentWeapon.FireSound,
-				CurrentWeapon.SpawnedWeapon->WeaponMesh,
-				CurrentWeapon.MuzzleSocketName
+				FireSound,
+				Weapon->SpawnedWeapon->WeaponMesh,
+				Definition->MuzzleSocketName
 			);
+			COMBAT_COUNT(Sounds, 1);
 		}
 	}
 
 	// Ensure SpawnedWeapon is valid before accessing it
-	if (!CurrentWeapon.SpawnedWeapon)
+	if (!Weapon->SpawnedWeapon)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Weapon not spawned, aborting fire."));
 		return;
 	}
 
-	FVector CameraLocation;
-	FRotator CameraRotation;
+	FVector Start, End;
+	if (!ComputeAimRay(Start, End)) return;
+	COMBAT_REPLAY_AIM(WeaponOwner, Start, End);
 
-	APawn* PawnOwner = Cast<APawn>(WeaponOwner);
-	APlayerController* PC = nullptr;
+	FCollisionQueryParams Params;
+	Params.AddIgnoredActor(WeaponOwner);
+
+	FHitResult Hit;
+	COMBAT_TRACE_EVENT(TraceIssued, WeaponOwner);
+	bool bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, Params);
+	COMBAT_COUNT(Traces, 1);
+	COMBAT_TRACE_EVENT(TraceResolved, WeaponOwner, Hit.GetActor(), bHit);
 
-	if (PawnOwner)
+	if (Latency)
 	{
-		PC = Cast<APlayerController>(PawnOwner->GetController());
-		if (PC)
-		{
-			PC->GetPlayerViewPoint(CameraLocation, CameraRotation);
-		}
+		Latency->Record(ECombatLatencyStage::Trace, InputCycles);
 	}
 
-	if (PC)
+	// Spawn one bullet tracer per shot
+	if (BulletTracerClass)
 	{
-		int32 ViewportSizeX, ViewportSizeY;
-		PC->GetViewportSize(ViewportSizeX, ViewportSizeY);
-		FVector2D CrosshairScreenPosition(ViewportSizeX * 0.5f, ViewportSizeY * 0.5f);
-
-		FVector CrosshairWorldLocation, CrosshairWorldDirection;
-		if (PC->DeprojectScreenPositionToWorld(CrosshairScreenPosition.X, CrosshairScreenPosition.Y, CrosshairWorldLocation, CrosshairWorldDirection))
-		{
-			FVector Start = CameraLocation;
-			FVector End = CameraLocation + (CrosshairWorldDirection * CurrentWeapon.MaxWeaponHitDistance);
+		FVector MuzzleLocation = Weapon->SpawnedWeapon->WeaponMesh->GetSocketLocation(Definition->MuzzleSocketName);
+		FVector TargetPoint = bHit ? Hit.ImpactPoint : End;
+		FVector Direction = (TargetPoint - MuzzleLocation).GetSafeNormal();
+		FRotator TracerRotation = Direction.Rotation();
+		const double TracerRange = FVector::Dist(MuzzleLocation, TargetPoint);
+		const double Now = UCombatSimulationSubsystem::GetTime(this);
 
-			FCollisionQueryParams Params;
-			Params.AddIgnoredActor(WeaponOwner);
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
-			FHitResult Hit;
-			bool bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, Params);
+		for (int32 ShotIndex = 0; ShotIndex < ShotsFired; ++ShotIndex)
+		{
+			AActor* Tracer = GetWorld()->SpawnActor<AActor>(BulletTracerClass, MuzzleLocation, TracerRotation, SpawnParams);
 
-			// Spawn bullet tracer
-			if (CurrentWeapon.BulletTracerClass && CurrentWeapon.SpawnedWeapon)
+			// A shot due earlier in the frame has already been in flight for part of it, move its tracer on by that much
+			const UProjectileMovementComponent* TracerMovement = Tracer ? Tracer->FindComponentByClass<UProjectileMovementComponent>() : nullptr;
+			const double ShotAge = Now - ShotTimes[ShotIndex];
+			if (TracerMovement && ShotAge > 0.0)
 			{
-				FVector MuzzleLocation = CurrentWeapon.SpawnedWeapon->WeaponMesh->GetSocketLocation(CurrentWeapon.MuzzleSocketName);
-				FVector TargetPoint = bHit ? Hit.ImpactPoint : End;
-				FVector Direction = (TargetPoint - MuzzleLocation).GetSafeNormal();
-				FRotator TracerRotation = Direction.Rotation();
-
-				FActorSpawnParameters SpawnParams;
-				SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-				AActor* Tracer = GetWorld()->SpawnActor<AActor>(CurrentWeapon.BulletTracerClass, MuzzleLocation, TracerRotation, SpawnParams);
+				const double Travelled = FMath::Min(TracerMovement->InitialSpeed * ShotAge, TracerRange);
+				Tracer->SetActorLocation(MuzzleLocation + Direction * Travelled);
 			}
+		}
+		COMBAT_COUNT(Tracers, ShotsFired);
+	}
+
+	if (bHit)
+	{
+		AActor* HitActor = Hit.GetActor();
+		bool bIsEnemy = false;
 
-			if (bHit)
+		if (HitActor && (HitActor->ActorHasTag("EnemyTier1") || HitActor->ActorHasTag("EnemyTier2") || HitActor->ActorHasTag("EnemyTier3")))
+		{
+			if (AEnemyBase* Enemy = Cast<AEnemyBase>(HitActor))
 			{
-				AActor* HitActor = Hit.GetActor();
-				bool bIsEnemy = false;
+				COMBAT_TELEMETRY(Hit, WeaponOwner, Enemy, Definition->DamagePerBullet * ShotsFired);
 
-				if (HitActor)
+				for (int32 ShotIndex = 0; ShotIndex < ShotsFired; ++ShotIndex)
 				{
-					if (HitActor->ActorHasTag("EnemyTier1"))
-					{
-						if (AEnemyBase* Enemy = Cast<AEnemyBase>(HitActor))
-						{
-							Enemy->ReceiveDamage(CurrentWeapon.DamagePerBullet);
-							bIsEnemy = true;
-						}
-					}
-
-					if (HitActor->ActorHasTag("EnemyTier2"))
-					{
-						if (AEnemyBase* Enemy = Cast<AEnemyBase>(HitActor))
-						{
-							Enemy->ReceiveDamage(CurrentWeapon.DamagePerBullet);
-							bIsEnemy = true;
-						}
-					}
+					Enemy->ReceiveDamage(Definition->DamagePerBullet);
+				}
+				bIsEnemy = true;
 
-					if (HitActor->ActorHasTag("EnemyTier3"))
-					{
-						if (AEnemyBase* Enemy = Cast<AEnemyBase>(HitActor))
-						{
-							Enemy->ReceiveDamage(CurrentWeapon.DamagePerBullet);
-							bIsEnemy = true;
-						}
-					}
+				if (Latency)
+				{
+					Latency->Record(ECombatLatencyStage::Damage, InputCycles);
 				}
 
-				// Impact Effect
-				if (!bIsEnemy && CurrentWeapon.ImpactEffect)
+				if (EventBus)
 				{
-					UGameplayStatics::SpawnEmitterAtLocation(
-						GetWorld(),
-						CurrentWeapon.ImpactEffect,
-						Hit.ImpactPoint,
-						Hit.ImpactNormal.Rotation()
-					);
+					EventBus->Channel<FCombatHitEvent>().Publish({ WeaponOwner, Enemy, Hit.ImpactPoint, Definition->DamagePerBullet * ShotsFired });
 				}
 			}
 		}
+
+		// Impact Effect
+		if (!bIsEnemy && ImpactEffect)
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(
+				GetWorld(),
+				ImpactEffect,
+				Hit.ImpactPoint,
+				Hit.ImpactNormal.Rotation()
+			);
+			COMBAT_COUNT(Emitters, 1);
+		}
+	}
+}
+
+bool UWeaponManagerComponent::ComputeAimRay(FVector& OutStart, FVector& OutEnd) const
+{
+	const FWeaponSlotState* Weapon = GetCurrentSlotState();
+	if (!Weapon || !WeaponOwner) return false;
+
+	APawn* PawnOwner = Cast<APawn>(WeaponOwner);
+	APlayerController* PC = PawnOwner ? Cast<APlayerController>(PawnOwner->GetController()) : nullptr;
+
+	// Bots and headless runs have no viewport to deproject, aim straight out of the owner's eyes instead
+	if (!PC)
+	{
+		FVector EyesLocation;
+		FRotator EyesRotation;
+		WeaponOwner->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+
+		OutStart = EyesLocation;
+		OutEnd = EyesLocation + EyesRotation.Vector() * Weapon->Definition->MaxWeaponHitDistance;
+		return true;
+	}
+
+	FVector CameraLocation;
+	FRotator CameraRotation;
+	PC->GetPlayerViewPoint(CameraLocation, CameraRotation);
+
+	int32 ViewportSizeX, ViewportSizeY;
+	PC->GetViewportSize(ViewportSizeX, ViewportSizeY);
+	FVector2D CrosshairScreenPosition(ViewportSizeX * 0.5f, ViewportSizeY * 0.5f);
+
+	FVector CrosshairWorldLocation, CrosshairWorldDirection;
+	if (!PC->DeprojectScreenPositionToWorld(CrosshairScreenPosition.X, CrosshairScreenPosition.Y, CrosshairWorldLocation, CrosshairWorldDirection))
+	{
+		return false;
 	}
+
+	OutStart = CameraLocation;
+	OutEnd = CameraLocation + (CrosshairWorldDirection * Weapon->Definition->MaxWeaponHitDistance);
+	return true;
+}
+
+void FWeaponFireCadence::Start(double Now, float FireRate)
+{
+	ShotInterval = 1.0 / FMath::Max(FireRate, KINDA_SMALL_NUMBER);
+	NextShotTime = Now + ShotInterval;
+}
+
+int32 FWeaponFireCadence::ConsumeDueShots(double Now, int32 MaxShots, TArray<double, TInlineAllocator<8>>& OutShotTimes)
+{
+	OutShotTimes.Reset();
+
+	// After a hitch, skip the missed shots but keep the beat, so the latest one due still fires on time
+	const double Backlog = Now - NextShotTime;
+	if (Backlog > HitchBacklogShots * ShotInterval)
+	{
+		NextShotTime += FMath::FloorToDouble(Backlog / ShotInterval) * ShotInterval;
+	}
+
+	while (NextShotTime <= Now && OutShotTimes.Num() < MaxShots)
+	{
+		OutShotTimes.Add(NextShotTime);
+		NextShotTime += ShotInterval;
+	}
+
+	return OutShotTimes.Num();
 }
 
 bool UWeaponManagerComponent::CanFire() const
 {
-	return !bIsReloading && CurrentWeapon.CurrentAmmo > 0;
+	const FWeaponSlotState* Weapon = GetCurrentSlotState();
+	return !bIsReloading && Weapon && Weapon->SpawnedWeapon && Weapon->CurrentAmmo > 0;
 }
 
 void UWeaponManagerComponent::TriggerReload()
 {
+	COMBAT_TRACE_SCOPE("UWeaponManagerComponent::TriggerReload");
+
 	if (bIsReloading) return;
 
 	bIsReloading = true;
-	GetWorld()->GetTimerManager().SetTimer(ReloadTimerHandle, this, &UWeaponManagerComponent::ExecuteReload, ReloadDuration, false);
+	UCombatSimulationSubsystem::SetTimer(this, ReloadTimerHandle, &UWeaponManagerComponent::ExecuteReload, ReloadDuration, false);
+
+	PublishWeaponState();
+
+	UCombatEventBus::Publish(this, FCombatReloadEvent{ WeaponOwner, CurrentWeaponName, true });
+	COMBAT_TRACE_EVENT(ReloadStarted, WeaponOwner, CurrentWeaponName);
+	COMBAT_TELEMETRY(ReloadStarted, WeaponOwner, CurrentWeaponName);
 }
 
 void UWeaponManagerComponent::ExecuteReload()
 {
+	COMBAT_TRACE_SCOPE("UWeaponManagerComponent::ExecuteReload");
+
 	bIsReloading = false;
 	Reload();
+
+	PublishWeaponState();
+
+	UCombatEventBus::Publish(this, FCombatReloadEvent{ WeaponOwner, CurrentWeaponName, false });
+	COMBAT_TRACE_EVENT(ReloadFinished, WeaponOwner, CurrentWeaponName);
+	COMBAT_TELEMETRY(ReloadFinished, WeaponOwner, CurrentWeaponName);
 }
 
 bool UWeaponManagerComponent::IsCurrentWeaponAmmoEmpty() const
 {
-	return CurrentWeapon.CurrentAmmo <= 0;
+	const FWeaponSlotState* Weapon = GetCurrentSlotState();
+	return !Weapon || Weapon->CurrentAmmo <= 0;
 }
 
 FName UWeaponManagerComponent::GetCurrentWeaponName() const
@@ -268,140 +593,65 @@ bool UWeaponManagerComponent::GetCurrentReloadMode() const
 	return bIsReloading;
 }
 
-void UWeaponManagerComponent::SaveCurrentWeaponAmmo(FName WeaponName, int32 MagAmmo, int32 TotalAmmo)
-{
-	WeaponAmmoMap.FindOrAdd(WeaponName) = { MagAmmo, TotalAmmo };
-}
-
 void UWeaponManagerComponent::Reload()
 {
-	if (CurrentWeapon.CurrentAmmo == CurrentWeapon.AmmoPerMag)
-		return;
-
-	// Cannot reload if no mags and no temp ammo
-	if (CurrentWeapon.Magazines <= 0 && CurrentWeapon.TempAmmoPool <= 0)
-		return;
-
-	int32 NeededAmmo = CurrentWeapon.AmmoPerMag - CurrentWeapon.CurrentAmmo;
-	int32 AmmoToSave = CurrentWeapon.CurrentAmmo;
-
-	// Always refill to full if we have enough
-	if (CurrentWeapon.Magazines > 0)
-	{
-		CurrentWeapon.Magazines--;
-		CurrentWeapon.CurrentAmmo = CurrentWeapon.AmmoPerMag;
+	FWeaponSlotState* Weapon = GetCurrentSlotState();
+	if (!Weapon) return;
 
-		// Save unused bullets
-		if (AmmoToSave > 0)
-		{
-			int32 TotalAmmo = AmmoToSave + (CurrentWeapon.Magazines * CurrentWeapon.AmmoPerMag);
-
-			// How many mags can we reform?
-			int32 ReformedMags = TotalAmmo / CurrentWeapon.AmmoPerMag;
-			int32 RemainingAmmo = TotalAmmo % CurrentWeapon.AmmoPerMag;
-
-			CurrentWeapon.Magazines = ReformedMags;
-
-			// If remaining bullets can't make a mag, store as temp
-			if (RemainingAmmo > 0)
-			{
-				CurrentWeapon.TempAmmoPool += RemainingAmmo;
-			}
-		}
-	}
-	else if (CurrentWeapon.TempAmmoPool > 0)
-	{
-		// Last resort: use temp ammo to refill
-		int32 LoadAmount = FMath::Min(CurrentWeapon.AmmoPerMag, CurrentWeapon.TempAmmoPool);
-		CurrentWeapon.CurrentAmmo = LoadAmount;
-		CurrentWeapon.TempAmmoPool -= LoadAmount;
-	}
+	CombatMath::ResolveReload(Weapon->CurrentAmmo, Weapon->Magazines, Weapon->TempAmmoPool, Weapon->Definition->AmmoPerMag);
 }
 
-void UWeaponManagerComponent::EquipWeapon(const FWeaponData& NewWeapon)
+void UWeaponManagerComponent::EquipWeapon(EWeaponSlot Slot)
 {
-	if (bIsWeaponHolstered)
+	COMBAT_SCOPE_CYCLE_COUNTER(STAT_CombatEquipWeapon, EquipWeapon);
+	COMBAT_TRACE_SCOPE("UWeaponManagerComponent::EquipWeapon");
+
+	if (bIsWeaponHolstered || Slot == EWeaponSlot::None)
 	{
 		return;
 	}
 
+	FWeaponSlotState& NewWeapon = GetSlotState(Slot);
+	if (!NewWeapon.Definition) return;
+
 	StopFire();
 
-	if (CurrentWeapon.WeaponName != "None")
+	// Ammo stays in the slot, so the outgoing weapon only needs to go back on its holster
+	FWeaponSlotState* OldWeapon = GetCurrentSlotState();
+	if (OldWeapon && Slot != CurrentSlot && OldWeapon->SpawnedWeapon)
 	{
-		int32 TotalAmmo = (CurrentWeapon.Magazines * CurrentWeapon.AmmoPerMag) + CurrentWeapon.TempAmmoPool;
-		SaveCurrentWeaponAmmo(CurrentWeapon.WeaponName, CurrentWeapon.CurrentAmmo, TotalAmmo);
+		AttachToHolster(*OldWeapon);
 	}
 
-	if (CurrentWeapon.SpawnedWeapon)
+	if (Slot != CurrentSlot)
 	{
-		FName HolsterSocket = GetHolsterSocketName(CurrentWeapon.WeaponName);
-		if (USkeletalMeshComponent* OwnerMesh = WeaponOwner->FindComponentByClass<USkeletalMeshComponent>())
-		{
-			CurrentWeapon.SpawnedWeapon->AttachToComponent(
-				OwnerMesh,
-				FAttachmentTransformRules::SnapToTargetNotIncludingScale,
-				HolsterSocket
-			);
-			//CurrentWeapon.SpawnedWeapon->SetActorHiddenInGame(true);
-			CurrentWeapon.SpawnedWeapon->SetActorEnableCollision(false);
-		}
+		UCombatEventBus::Publish(this, FCombatWeaponSwitchedEvent{ WeaponOwner, CurrentSlot, Slot });
+		COMBAT_TRACE_EVENT(WeaponSwitched, WeaponOwner, OldWeapon && OldWeapon->Definition ? OldWeapon->Definition->WeaponName : NAME_None, NewWeapon.Definition->WeaponName);
 	}
 
-	CurrentWeapon = NewWeapon;
+	CurrentSlot = Slot;
+
+	RequestSlotFireAssets(Slot, FStreamableManager::AsyncLoadHighPriority);
 
-	AWeaponActor* Spawned = nullptr;
-	if (AllWeapons.Contains(NewWeapon.WeaponName))
+	if (NewWeapon.SpawnedWeapon)
 	{
-		Spawned = AllWeapons[NewWeapon.WeaponName].SpawnedWeapon;
+		AttachToHand(NewWeapon);
+		LastEquippedSlot = Slot;
 	}
 	else
 	{
-		if (!NewWeapon.WeaponClass) return;
-
-		FActorSpawnParameters SpawnParams;
-		SpawnParams.Owner = WeaponOwner;
-
-		Spawned = GetWorld()->SpawnActor<AWeaponActor>(NewWeapon.WeaponClass, SpawnParams);
-		if (Spawned)
-		{
-			FWeaponData StoredData = NewWeapon;
-			StoredData.SpawnedWeapon = Spawned;
-			AllWeapons.Add(NewWeapon.WeaponName, StoredData);
-		}
+		// Still streaming, OnSlotVisualsLoaded attaches it to the hand once it lands
+		UE_LOG(LogTemp, Log, TEXT("Equipping %s before its assets finished streaming."), *NewWeapon.Definition->WeaponName.ToString());
+		RequestSlotVisuals(Slot, FStreamableManager::AsyncLoadHighPriority);
 	}
 
-	if (Spawned)
-	{
-		CurrentWeapon.SpawnedWeapon = Spawned;
-
-		if (FWeaponAmmoData* SavedAmmo = WeaponAmmoMap.Find(CurrentWeapon.WeaponName))
-		{
-			CurrentWeapon.CurrentAmmo = SavedAmmo->CurrentMagAmmo;
-
-			// Calculate mags and temp pool from total
-			int32 Total = SavedAmmo->CurrentTotalAmmo;
-			CurrentWeapon.Magazines = Total / CurrentWeapon.AmmoPerMag;
-			CurrentWeapon.TempAmmoPool = Total % CurrentWeapon.AmmoPerMag;
-		}
-
-		if (USkeletalMeshComponent* OwnerMesh = WeaponOwner->FindComponentByClass<USkeletalMeshComponent>())
-		{
-			FName EquipSocket = (CurrentWeapon.WeaponName == "Pistol") ? FName("SecondaryWeaponHolder") : FName("PrimaryWeaponHolder");
-
-			Spawned->AttachToComponent(OwnerMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, EquipSocket);
-		}
-
-		//Spawned->SetActorHiddenInGame(false);
-		Spawned->SetActorEnableCollision(true);
-		LastEquippedWeaponData = CurrentWeapon;
-	}
+	PublishWeaponState();
 }
 
 
-void UWeaponManagerComponent::SwitchWeapon(const FWeaponData& NewWeapon)
+void UWeaponManagerComponent::SwitchWeapon(EWeaponSlot Slot)
 {
-	EquipWeapon(NewWeapon);
+	EquipWeapon(Slot);
 }
 
 void UWeaponManagerComponent::ToggleHolsterWeapon()
@@ -411,22 +661,11 @@ void UWeaponManagerComponent::ToggleHolsterWeapon()
 	if (bIsWeaponHolstered)
 	{
 		// Unholster and re-equip the last weapon
-		if (LastEquippedWeaponData.SpawnedWeapon)
+		FWeaponSlotState* LastWeapon = LastEquippedSlot != EWeaponSlot::None ? &GetSlotState(LastEquippedSlot) : nullptr;
+		if (LastWeapon && LastWeapon->SpawnedWeapon)
 		{
-			// Simply attach to equip socket (WeaponHolder)
-			if (USkeletalMeshComponent* OwnerMesh = WeaponOwner->FindComponentByClass<USkeletalMeshComponent>())
-			{
-				FName EquipSocket = (LastEquippedWeaponData.WeaponName == "Pistol") ? FName("SecondaryWeaponHolder") : FName("PrimaryWeaponHolder");
-
-				LastEquippedWeaponData.SpawnedWeapon->AttachToComponent(
-					OwnerMesh,
-					FAttachmentTransformRules::SnapToTargetNotIncludingScale,
-					EquipSocket
-				);
-				LastEquippedWeaponData.SpawnedWeapon->SetActorEnableCollision(true);
-			}
-
-			CurrentWeapon = LastEquippedWeaponData;
+			AttachToHand(*LastWeapon);
+			CurrentSlot = LastEquippedSlot;
 		}
 		else
 		{
@@ -435,71 +674,86 @@ void UWeaponManagerComponent::ToggleHolsterWeapon()
 	}
 	else
 	{
-		if (!CurrentWeapon.SpawnedWeapon) return;
+		FWeaponSlotState* Weapon = GetCurrentSlotState();
+		if (!Weapon || !Weapon->SpawnedWeapon) return;
 
 		StopFire();
 
-		// Save current before holstering
-		LastEquippedWeaponData = CurrentWeapon;
+		// Remember the slot before holstering
+		LastEquippedSlot = CurrentSlot;
 
-		if (USkeletalMeshComponent* OwnerMesh = WeaponOwner->FindComponentByClass<USkeletalMeshComponent>())
-		{
-			FName HolsterSocket = GetHolsterSocketName(CurrentWeapon.WeaponName);
-			CurrentWeapon.SpawnedWeapon->AttachToComponent(
-				OwnerMesh,
-				FAttachmentTransformRules::SnapToTargetNotIncludingScale,
-				HolsterSocket
-			);
-			CurrentWeapon.SpawnedWeapon->SetActorEnableCollision(false);
-		}
+		AttachToHolster(*Weapon);
 
-		// Clear current weapon reference while holstered
-		CurrentWeapon = FWeaponData();
+		// No current weapon while holstered
+		CurrentSlot = EWeaponSlot::None;
 	}
 
 	bIsWeaponHolstered = !bIsWeaponHolstered;
+
+	PublishWeaponState();
 }
 
-FName UWeaponManagerComponent::GetHolsterSocketName(const FName& WeaponName) const
+void UWeaponManagerComponent::SpawnAndHolsterWeapon(EWeaponSlot Slot)
 {
-	if (WeaponName == "Assault Rifle")
-	{
-		return FName("AR_HolsterSocket");
-	}
-	else if (WeaponName == "Shotgun")
-	{
-		return FName("Shotgun_HolsterSocket");
-	}
-	else if (WeaponName == "Pistol")
-	{
-		return FName("Pistol_HolsterSocket");
-	}
-	return NAME_None;
+	if (!WeaponOwner || Slot == EWeaponSlot::None) return;
+
+	if (GetSlotState(Slot).SpawnedWeapon) return;
+
+	// Spawns and holsters in OnSlotVisualsLoaded, immediately if the class is already resident
+	RequestSlotVisuals(Slot);
 }
 
-void UWeaponManagerComponent::SpawnAndHolsterWeapon(const FWeaponData& WeaponData)
+bool UWeaponManagerComponent::SpawnWeaponActor(FWeaponSlotState& Weapon)
 {
-	if (!WeaponOwner || !WeaponData.WeaponClass) return;
+	if (!WeaponOwner || !Weapon.Definition) return false;
+
+	UClass* WeaponClass = Weapon.Definition->WeaponClass.Get();
+	if (!WeaponClass) return false;
 
-	if (AllWeapons.Contains(WeaponData.WeaponName)) return;
+	LLM_SCOPE_BYTAG(Combat_Weapons);
 
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.Owner = WeaponOwner;
-	AWeaponActor* SpawnedWeapon = GetWorld()->SpawnActor<AWeaponActor>(WeaponData.WeaponClass, SpawnParams);
-	if (!SpawnedWeapon) return;
 
-	if (USkeletalMeshComponent* OwnerMesh = WeaponOwner->FindComponentByClass<USkeletalMeshComponent>())
+	Weapon.SpawnedWeapon = GetWorld()->SpawnActor<AWeaponActor>(WeaponClass, SpawnParams);
+	return Weapon.SpawnedWeapon != nullptr;
+}
+
+void UWeaponManagerComponent::AttachToHolster(FWeaponSlotState& Weapon)
+{
+	if (USkeletalMeshComponent* OwnerMesh = GetOwnerMesh())
 	{
-		FName HolsterSocket = GetHolsterSocketName(WeaponData.WeaponName);
-		SpawnedWeapon->AttachToComponent(OwnerMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, HolsterSocket);
+		Weapon.SpawnedWeapon->AttachToComponent(
+			OwnerMesh,
+			FAttachmentTransformRules::SnapToTargetNotIncludingScale,
+			Weapon.Definition->HolsterSocketName
+		);
 	}
 
-	//SpawnedWeapon->SetActorHiddenInGame(true);
-	SpawnedWeapon->SetActorEnableCollision(false);
+	//Weapon.SpawnedWeapon->SetActorHiddenInGame(true);
+	Weapon.SpawnedWeapon->SetActorEnableCollision(false);
+	Weapon.SpawnedWeapon->SetHolstered(true);
+}
 
-	FWeaponData Copy = WeaponData;
-	Copy.SpawnedWeapon = SpawnedWeapon;
-	AllWeapons.Add(WeaponData.WeaponName, Copy);
+void UWeaponManagerComponent::AttachToHand(FWeaponSlotState& Weapon)
+{
+	if (USkeletalMeshComponent* OwnerMesh = GetOwnerMesh())
+	{
+		Weapon.SpawnedWeapon->AttachToComponent(
+			OwnerMesh,
+			FAttachmentTransformRules::SnapToTargetNotIncludingScale,
+			Weapon.Definition->EquipSocketName
+		);
+	}
+
+	//Weapon.SpawnedWeapon->SetActorHiddenInGame(false);
+	Weapon.SpawnedWeapon->SetActorEnableCollision(true);
+	Weapon.SpawnedWeapon->SetHolstered(false);
+}
+
+USkeletalMeshComponent* UWeaponManagerComponent::GetOwnerMesh() const
+{
+	return WeaponOwner ? WeaponOwner->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
 }
 
 bool UWeaponManagerComponent::IsWeaponHolstered() const
@@ -507,7 +761,35 @@ bool UWeaponManagerComponent::IsWeaponHolstered() const
 	return bIsWeaponHolstered;
 }
 
+#if WITH_DEV_AUTOMATION_TESTS
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponFireCadenceTest, "CombatSystem.Weapon.FireCadence",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 
+bool FWeaponFireCadenceTest::RunTest(const FString& Parameters)
+{
+	TArray<double, TInlineAllocator<8>> ShotTimes;
 
+	// Shots over the per-frame cap are carried, not dropped
+	{
+		FWeaponFireCadence Cadence;
+		Cadence.Start(0.0, 100.0f);
+		TestEqual(TEXT("Capped frame fires the cap"), Cadence.ConsumeDueShots(0.125, 8, ShotTimes), 8);
+		TestEqual(TEXT("Capped frame keeps each shot's time"), ShotTimes[7], 0.08, 1e-9);
+		TestEqual(TEXT("Next frame fires the carried shots"), Cadence.ConsumeDueShots(0.125, 8, ShotTimes), 4);
+		TestEqual(TEXT("Carried shots keep their times"), ShotTimes[0], 0.09, 1e-9);
+	}
+
+	// A backlog past the hitch threshold is dropped, keeping the beat
+	{
+		FWeaponFireCadence Cadence;
+		Cadence.Start(0.0, 100.0f);
+		TestEqual(TEXT("Hitch fires one shot"), Cadence.ConsumeDueShots(1.005, 8, ShotTimes), 1);
+		TestEqual(TEXT("Hitch shot lands on the beat"), ShotTimes[0], 1.0, 1e-9);
+		TestEqual(TEXT("Hitch leaves nothing due"), Cadence.ConsumeDueShots(1.005, 8, ShotTimes), 0);
+	}
+
+	return true;
+}
 
+#endif
@@ -4,79 +4,63 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Engine/StreamableManager.h"
+#include "WeaponDefinition.h"
+#include "CombatSimulationSubsystem.h"
 #include "WeaponManagerComponent.generated.h"
 
+class AWeaponActor;
+
 UENUM(BlueprintType)
-enum class EFireMode : uint8
+enum class EWeaponSlot : uint8
 {
-	Single,
-	Automatic
+	Primary1,
+	Primary2,
+	Secondary,
+	None UMETA(Hidden)
 };
 
+static constexpr int32 NumWeaponSlots = static_cast<int32>(EWeaponSlot::None);
+
+// Mutable per-owner state of one loadout slot. Static config stays on the shared UWeaponDefinition.
 USTRUCT(BlueprintType)
-struct FWeaponData
+struct FWeaponSlotState
 {
 	GENERATED_BODY()
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FName WeaponName;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	EFireMode FireMode;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 AmmoPerMag = 30;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UWeaponDefinition* Definition = nullptr;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 CurrentAmmo = 30;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 Magazines = 3;
+	UPROPERTY(Transient)
+	AWeaponActor* SpawnedWeapon = nullptr;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float FireRate = 10.0f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 CurrentAmmo = 0;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float DamagePerBullet = 10.0f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Magazines = 0;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	int32 TempAmmoPool = 0;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
-	USoundBase* FireSound = nullptr;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<class AWeaponActor> WeaponClass;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FName MuzzleSocketName;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UParticleSystem* MuzzleFlash;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<AActor> BulletTracerClass;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UParticleSystem* ImpactEffect;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float MaxWeaponHitDistance = 10000.f;
-
-	UPROPERTY(Transient)
-	AWeaponActor* SpawnedWeapon = nullptr;
+	int32 GetTotalAmmo() const { return Definition ? (Magazines * Definition->AmmoPerMag) + TempAmmoPool : 0; }
 };
 
-USTRUCT(BlueprintType)
-struct FWeaponAmmoData
+// Frame-rate independent cadence for automatic fire. Works out how many shots
+// fell inside the last frame and the exact time each of them was due.
+struct FWeaponFireCadence
 {
-	GENERATED_BODY()
+	double NextShotTime = 0.0;
+
+	double ShotInterval = 0.1;
+
+	// A backlog longer than this many intervals is a hitch rather than a slow frame, and is dropped instead of fired
+	int32 HitchBacklogShots = 32;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 CurrentMagAmmo;
+	void Start(double Now, float FireRate);
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 CurrentTotalAmmo;
+	// Shots past MaxShots stay due and come out of the next call
+	int32 ConsumeDueShots(double Now, int32 MaxShots, TArray<double, TInlineAllocator<8>>& OutShotTimes);
 };
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
@@ -92,45 +76,87 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FWeaponData CurrentWeapon;
+	// Fixed-size loadout, indexed by EWeaponSlot
+	UPROPERTY(VisibleAnywhere, Category = "Weapon")
+	FWeaponSlotState WeaponSlots[NumWeaponSlots];
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon")
+	EWeaponSlot CurrentSlot = EWeaponSlot::None;
+
+	// Slot to restore when the weapon is unholstered
+	EWeaponSlot LastEquippedSlot = EWeaponSlot::None;
+
+	FWeaponSlotState& GetSlotState(EWeaponSlot Slot) { return WeaponSlots[static_cast<int32>(Slot)]; }
+
+	const FWeaponSlotState& GetSlotState(EWeaponSlot Slot) const { return WeaponSlots[static_cast<int32>(Slot)]; }
 
-	FTimerHandle AutoFireTimerHandle;
+	// Returns the equipped slot, or nullptr while holstered or when the slot is empty
+	FWeaponSlotState* GetCurrentSlotState();
 
-	void StartFire();
+	const FWeaponSlotState* GetCurrentSlotState() const;
+
+	// Assigns a definition to a slot and fills it with the definition's starting ammo
+	void InitializeSlot(EWeaponSlot Slot, UWeaponDefinition* Definition);
+
+	// Puts back ammo captured by a combat snapshot. Firing stops and any pending reload is cancelled.
+	void RestoreSlotAmmo(EWeaponSlot Slot, int32 CurrentAmmo, int32 Magazines, int32 TempAmmoPool);
+
+	// Streams everything a slot needs to be equipped. Call it when a switch starts so loading overlaps the holster animation.
+	void PreloadSlot(EWeaponSlot Slot);
+
+	// Streams the slot's weapon actor class; the actor is spawned and attached once it is resident
+	void RequestSlotVisuals(EWeaponSlot Slot, TAsyncLoadPriority Priority = FStreamableManager::DefaultAsyncLoadPriority);
+
+	// Streams the sound, FX and tracer the slot needs to fire
+	void RequestSlotFireAssets(EWeaponSlot Slot, TAsyncLoadPriority Priority = FStreamableManager::DefaultAsyncLoadPriority);
+
+	bool AreSlotAssetsLoaded(EWeaponSlot Slot) const;
+
+	FWeaponFireCadence FireCadence;
+
+	// Upper bound on shots resolved in a single frame, the rest carry into the next one.
+	// Variable steps only, fixed steps fire every shot due in each step.
+	int32 MaxShotsPerFrame = 8;
+
+	// InputCycles is the FPlatformTime::Cycles64 stamp of the press, zero when fire wasn't triggered by input
+	void StartFire(uint64 InputCycles = 0);
+
+	// Stamp of the press whose first batch hasn't fired yet; consumed by FireBatch for latency sampling
+	uint64 PendingInputCycles = 0;
 
 	void StopFire();
 
 	void Fire();
 
+	// Fires one shot per entry in ShotTimes down one aim ray and one trace. Shots due within the same frame
+	// share the frame's aim and world state, so tracing each would find the same hit; their times place each tracer.
+	void FireBatch(TConstArrayView<double> ShotTimes);
+
+	bool ComputeAimRay(FVector& OutStart, FVector& OutEnd) const;
+
 	bool CanFire() const;
 
 	void Reload();
 
 	AActor* WeaponOwner;
 
-	void EquipWeapon(const FWeaponData& NewWeapon);
+	void EquipWeapon(EWeaponSlot Slot);
 
 	UFUNCTION(BlueprintCallable)
-	void SwitchWeapon(const FWeaponData& NewWeapon);
+	void SwitchWeapon(EWeaponSlot Slot);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon")
 	bool bIsWeaponHolstered = false;
 
 	void ToggleHolsterWeapon();
 
-	FName GetHolsterSocketName(const FName& WeaponName) const;
-
-	FWeaponData LastEquippedWeaponData;
-
-	void SpawnAndHolsterWeapon(const FWeaponData& WeaponData);
-
-	UPROPERTY()
-	TMap<FName, FWeaponData> AllWeapons;
+	void SpawnAndHolsterWeapon(EWeaponSlot Slot);
 
 	bool IsWeaponHolstered() const;
 
@@ -139,7 +165,7 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Weapon Reload")
 	bool bIsReloading = false;
 
-	FTimerHandle ReloadTimerHandle;
+	FCombatTimerHandle ReloadTimerHandle;
 	float ReloadDuration = 1.5f;
 
 	void TriggerReload();
@@ -169,8 +195,31 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Weapon")
 	bool GetCurrentReloadMode() const;
 
-	UPROPERTY()
-	TMap<FName, FWeaponAmmoData> WeaponAmmoMap;
+private:
+
+	// Handles keep streamed assets resident for as long as the slot holds its definition
+	TSharedPtr<FStreamableHandle> SlotVisualHandles[NumWeaponSlots];
+
+	TSharedPtr<FStreamableHandle> SlotFireHandles[NumWeaponSlots];
+
+	void OnSlotVisualsLoaded(EWeaponSlot Slot);
+
+	// Refreshes the CurrentWeapon* mirrors and pushes them to the HUD view model. Called wherever ammo, reload or the equipped slot change.
+	void PublishWeaponState();
+
+	bool SpawnWeaponActor(FWeaponSlotState& Weapon);
+
+	void AttachToHolster(FWeaponSlotState& Weapon);
+
+	void AttachToHand(FWeaponSlotState& Weapon);
+
+	USkeletalMeshComponent* GetOwnerMesh() const;
+
+	// Bound while the combat clock runs fixed steps: automatic fire drains on those instead of the component tick
+	FDelegateHandle CombatStepHandle;
+
+	void CombatStep(float StepSeconds);
 
-	void SaveCurrentWeaponAmmo(FName WeaponName, int32 MagAmmo, int32 TotalAmmo);
+	// Fires the cadence's due shots, false once the weapon is no longer firing automatically
+	bool DrainFireCadence(int32 MaxShots);
 };